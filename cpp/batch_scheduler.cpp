@@ -0,0 +1,238 @@
+/**
+ * @file batch_scheduler.cpp
+ * @brief Implementation of the micro-batching request scheduler
+ */
+
+#include "batch_scheduler.h"
+#include "telemetry.h"
+#include <algorithm>
+#include <iterator>
+
+namespace trajectory {
+
+namespace {
+
+/**
+ * @brief Scheduler metrics, shared by all schedulers in the process
+ */
+struct SchedulerTelemetry {
+    TelemetryGauge& queued_requests = TelemetryRegistry::global().gauge(
+        "trajectory_scheduler_queued_requests", "Requests waiting for dispatch");
+    TelemetryGauge& queued_rows = TelemetryRegistry::global().gauge(
+        "trajectory_scheduler_queued_rows", "Trajectories waiting for dispatch");
+    TelemetryHistogram& queue_wait = TelemetryRegistry::global().histogram(
+        "trajectory_scheduler_queue_wait_seconds", "Time from submit to dispatch in seconds");
+    TelemetryHistogram& batch_fill = TelemetryRegistry::global().histogram(
+        "trajectory_scheduler_batch_fill_ratio", "Rows per dispatched batch over max_batch_rows",
+        std::string(), ratioBuckets());
+    TelemetryCounter& batches = TelemetryRegistry::global().counter(
+        "trajectory_scheduler_batches_total", "Batches dispatched");
+    TelemetryCounter& errors = TelemetryRegistry::global().counter(
+        "trajectory_scheduler_failed_batches_total", "Dispatched batches whose generation threw");
+};
+
+SchedulerTelemetry& schedulerTelemetry() {
+    static SchedulerTelemetry telemetry;
+    return telemetry;
+}
+
+} // namespace
+
+BatchScheduler::BatchScheduler(const GeneratorConfig& config,
+                               const SchedulerConfig& scheduler_config)
+    : config_(scheduler_config)
+    , generator_(std::make_unique<TrajectoryGenerator>(config))
+{
+    start();
+}
+
+BatchScheduler::BatchScheduler(std::shared_ptr<ModelSession> model, const GeneratorConfig& config,
+                               const SchedulerConfig& scheduler_config)
+    : config_(scheduler_config)
+    , generator_(std::make_unique<TrajectoryGenerator>(std::move(model), config))
+{
+    start();
+}
+
+BatchScheduler::~BatchScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    dispatcher_.join();
+}
+
+void BatchScheduler::start() {
+    queued_rows_ = 0;
+    flush_requested_ = false;
+    stop_ = false;
+    
+    if (config_.max_batch_rows == 0) {
+        config_.max_batch_rows = static_cast<size_t>(generator_->getMaxBatchSize());
+    }
+    
+    dispatcher_ = std::thread([this]() { dispatchLoop(); });
+}
+
+bool BatchScheduler::loadNormalization(const std::string& norm_path) {
+    std::lock_guard<std::mutex> lock(generator_mutex_);
+    return generator_->loadNormalization(norm_path);
+}
+
+void BatchScheduler::warmup(const std::vector<int>& batch_sizes) {
+    std::vector<int> sizes = batch_sizes;
+    if (sizes.empty()) {
+        sizes = {1, static_cast<int>(config_.max_batch_rows)};
+    }
+    
+    std::lock_guard<std::mutex> lock(generator_mutex_);
+    generator_->warmup(sizes);
+}
+
+std::future<std::vector<Trajectory>> BatchScheduler::submit(const Waypoint& start,
+                                                            const Waypoint& end,
+                                                            int n_samples) {
+    auto promise = std::make_shared<std::promise<std::vector<Trajectory>>>();
+    std::future<std::vector<Trajectory>> result = promise->get_future();
+    
+    submit(start, end, n_samples,
+           [promise](std::vector<Trajectory>&& trajectories, std::exception_ptr error) {
+               if (error) {
+                   promise->set_exception(error);
+               } else {
+                   promise->set_value(std::move(trajectories));
+               }
+           });
+    
+    return result;
+}
+
+void BatchScheduler::submit(const Waypoint& start, const Waypoint& end, int n_samples,
+                            GenerationCallback callback) {
+    if (n_samples <= 0) {
+        callback(std::vector<Trajectory>(), nullptr);
+        return;
+    }
+    
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back({GenerationRequest(start, end, n_samples), std::move(callback),
+                          std::chrono::steady_clock::now()});
+        queued_rows_ += static_cast<size_t>(n_samples);
+        
+        if constexpr (kTelemetryEnabled) {
+            schedulerTelemetry().queued_requests.add(1);
+            schedulerTelemetry().queued_rows.add(n_samples);
+        }
+        
+        // The dispatcher only needs waking for the first request of a
+        // window or when a full batch is ready
+        wake = queue_.size() == 1 || queued_rows_ >= config_.max_batch_rows;
+    }
+    
+    if (wake) {
+        cv_.notify_one();
+    }
+}
+
+void BatchScheduler::flush() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty()) return;
+        flush_requested_ = true;
+    }
+    cv_.notify_one();
+}
+
+SchedulerStats BatchScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void BatchScheduler::dispatchLoop() {
+    std::vector<Pending> batch;
+    
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+            
+            if (queue_.empty()) return;  // stopping and drained
+            
+            // Hold the window open until it expires, the batch fills up,
+            // or someone asks for the queue to go out now
+            const auto deadline = queue_.front().queued_at + config_.max_delay;
+            cv_.wait_until(lock, deadline, [this]() {
+                return stop_ || flush_requested_ || queued_rows_ >= config_.max_batch_rows;
+            });
+            
+            // Take whole requests up to max_batch_rows (always at least one)
+            size_t rows = 0;
+            auto last = queue_.begin();
+            while (last != queue_.end() &&
+                   (last == queue_.begin() ||
+                    rows + static_cast<size_t>(last->request.n_samples) <= config_.max_batch_rows)) {
+                rows += static_cast<size_t>(last->request.n_samples);
+                ++last;
+            }
+            
+            batch.assign(std::make_move_iterator(queue_.begin()), std::make_move_iterator(last));
+            queue_.erase(queue_.begin(), last);
+            queued_rows_ -= rows;
+            if (queue_.empty()) flush_requested_ = false;
+            
+            stats_.requests += batch.size();
+            stats_.batches += 1;
+            stats_.rows += rows;
+            
+            if constexpr (kTelemetryEnabled) {
+                SchedulerTelemetry& telemetry = schedulerTelemetry();
+                const auto now = std::chrono::steady_clock::now();
+                for (const Pending& pending : batch) {
+                    telemetry.queue_wait.observe(now - pending.queued_at);
+                }
+                telemetry.queued_requests.add(-static_cast<int64_t>(batch.size()));
+                telemetry.queued_rows.add(-static_cast<int64_t>(rows));
+                telemetry.batch_fill.observe(static_cast<double>(rows) / config_.max_batch_rows);
+                telemetry.batches.add();
+            }
+        }
+        
+        dispatch(batch);
+        batch.clear();
+    }
+}
+
+void BatchScheduler::dispatch(std::vector<Pending>& batch) {
+    std::vector<GenerationRequest> requests;
+    requests.reserve(batch.size());
+    for (const Pending& pending : batch) {
+        requests.push_back(pending.request);
+    }
+    
+    BatchResult result;
+    std::exception_ptr error;
+    try {
+        std::lock_guard<std::mutex> lock(generator_mutex_);
+        result = generator_->generateBatch(requests);
+    } catch (...) {
+        error = std::current_exception();
+        if constexpr (kTelemetryEnabled) {
+            schedulerTelemetry().errors.add();
+        }
+    }
+    
+    for (size_t r = 0; r < batch.size(); ++r) {
+        std::vector<Trajectory> trajectories;
+        if (!error) {
+            auto first = result.trajectories.begin() + result.offsets[r];
+            auto last = result.trajectories.begin() + result.offsets[r + 1];
+            trajectories.assign(std::make_move_iterator(first), std::make_move_iterator(last));
+        }
+        batch[r].callback(std::move(trajectories), error);
+    }
+}
+
+} // namespace trajectory
@@ -0,0 +1,154 @@
+/**
+ * @file batch_scheduler.h
+ * @brief Asynchronous generation with micro-batching of concurrent requests
+ * @author Mission Planner Team
+ * 
+ * Callers submit small requests from any thread and get a future (or a
+ * callback). A dispatcher thread collects requests for a short window and
+ * runs them as one generateBatch() call, so bursts of small requests share
+ * ONNX runs instead of each paying a full inference latency.
+ */
+
+#ifndef BATCH_SCHEDULER_H
+#define BATCH_SCHEDULER_H
+
+#include "trajectory_inference.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace trajectory {
+
+/**
+ * @brief Coalescing policy for BatchScheduler
+ */
+struct SchedulerConfig {
+    std::chrono::microseconds max_delay{2000};  // Wait after the oldest queued request
+    size_t max_batch_rows = 0;                  // Dispatch early at this many rows (0 = generator max_batch_size)
+};
+
+/**
+ * @brief Counters for observing how well requests coalesce
+ */
+struct SchedulerStats {
+    size_t requests = 0;    // Requests dispatched
+    size_t batches = 0;     // generateBatch() calls
+    size_t rows = 0;        // Trajectories generated
+};
+
+/**
+ * @brief Completion callback: trajectories, or a non-null error
+ * 
+ * Runs on the dispatcher thread, so it should return quickly and must
+ * not throw.
+ */
+using GenerationCallback = std::function<void(std::vector<Trajectory>&&, std::exception_ptr)>;
+
+/**
+ * @brief Micro-batching front end for a TrajectoryGenerator
+ */
+class BatchScheduler {
+public:
+    /**
+     * @brief Load the model and start the dispatcher
+     * @param config Generator configuration
+     * @param scheduler_config Coalescing policy
+     */
+    explicit BatchScheduler(const GeneratorConfig& config,
+                            const SchedulerConfig& scheduler_config = SchedulerConfig());
+    
+    /**
+     * @brief Start the dispatcher over an already loaded model
+     * @param model Shared model session (e.g. from a GeneratorPool)
+     * @param config Generator configuration
+     * @param scheduler_config Coalescing policy
+     */
+    BatchScheduler(std::shared_ptr<ModelSession> model, const GeneratorConfig& config,
+                   const SchedulerConfig& scheduler_config = SchedulerConfig());
+    
+    /**
+     * @brief Dispatch everything still queued, then stop the dispatcher
+     */
+    ~BatchScheduler();
+    
+    BatchScheduler(const BatchScheduler&) = delete;
+    BatchScheduler& operator=(const BatchScheduler&) = delete;
+    
+    /**
+     * @brief Load normalization parameters for the scheduler's generator
+     * @param norm_path Path to normalization JSON file
+     * @return true if loaded successfully
+     */
+    bool loadNormalization(const std::string& norm_path);
+    
+    /**
+     * @brief Warm up the scheduler's generator (see TrajectoryGenerator::warmup)
+     * @param batch_sizes Sizes to run (empty = 1 and max_batch_rows)
+     */
+    void warmup(const std::vector<int>& batch_sizes = std::vector<int>());
+    
+    /**
+     * @brief Queue a request without blocking
+     * @param start Start position
+     * @param end End position
+     * @param n_samples Number of trajectories to generate
+     * @return Future for the trajectories (inference errors are forwarded)
+     */
+    std::future<std::vector<Trajectory>> submit(const Waypoint& start, const Waypoint& end,
+                                                int n_samples = 1);
+    
+    /**
+     * @brief Queue a request and invoke a callback on completion
+     */
+    void submit(const Waypoint& start, const Waypoint& end, int n_samples,
+                GenerationCallback callback);
+    
+    /**
+     * @brief Dispatch queued requests now instead of waiting out the window
+     */
+    void flush();
+    
+    /**
+     * @brief Counters since construction
+     */
+    SchedulerStats getStats() const;
+    
+    const SchedulerConfig& getConfig() const { return config_; }
+
+private:
+    struct Pending {
+        GenerationRequest request;
+        GenerationCallback callback;
+        std::chrono::steady_clock::time_point queued_at;
+    };
+    
+    void start();
+    void dispatchLoop();
+    void dispatch(std::vector<Pending>& batch);
+    
+    SchedulerConfig config_;
+    std::unique_ptr<TrajectoryGenerator> generator_;
+    std::mutex generator_mutex_;
+    
+    std::deque<Pending> queue_;
+    size_t queued_rows_;
+    bool flush_requested_;
+    bool stop_;
+    SchedulerStats stats_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    
+    std::thread dispatcher_;
+};
+
+} // namespace trajectory
+
+#endif // BATCH_SCHEDULER_H
@@ -3,6 +3,18 @@
 
 set -e  # Exit on error
 
+# --gpu: build against the GPU ONNX Runtime package (CUDA/TensorRT providers)
+USE_CUDA=OFF
+ORT_PACKAGE="onnxruntime-linux-x64-1.16.3"
+for arg in "$@"; do
+    case "$arg" in
+        --gpu)
+            USE_CUDA=ON
+            ORT_PACKAGE="onnxruntime-linux-x64-gpu-1.16.3"
+            ;;
+    esac
+done
+
 echo "=========================================="
 echo "Building Trajectory Generator"
 echo "=========================================="
@@ -17,15 +29,15 @@ if [ -z "$ONNXRUNTIME_ROOT_DIR" ]; then
     cd ../libs
     
     # Download ONNX Runtime if not present
-    if [ ! -d "onnxruntime-linux-x64-1.16.3" ]; then
-        echo "Downloading ONNX Runtime 1.16.3..."
-        wget -q https://github.com/microsoft/onnxruntime/releases/download/v1.16.3/onnxruntime-linux-x64-1.16.3.tgz
-        tar -xzf onnxruntime-linux-x64-1.16.3.tgz
-        rm onnxruntime-linux-x64-1.16.3.tgz
+    if [ ! -d "$ORT_PACKAGE" ]; then
+        echo "Downloading ONNX Runtime 1.16.3 ($ORT_PACKAGE)..."
+        wget -q https://github.com/microsoft/onnxruntime/releases/download/v1.16.3/$ORT_PACKAGE.tgz
+        tar -xzf $ORT_PACKAGE.tgz
+        rm $ORT_PACKAGE.tgz
         echo "✓ ONNX Runtime downloaded"
     fi
     
-    export ONNXRUNTIME_ROOT_DIR=$(pwd)/onnxruntime-linux-x64-1.16.3
+    export ONNXRUNTIME_ROOT_DIR=$(pwd)/$ORT_PACKAGE
     cd ../cpp
 else
     echo "✓ Using ONNX Runtime from: $ONNXRUNTIME_ROOT_DIR"
@@ -40,6 +52,7 @@ echo ""
 echo "Running CMake..."
 CC=gcc CXX=g++ cmake -DCMAKE_BUILD_TYPE=Release \
       -DONNXRUNTIME_ROOT_DIR=$ONNXRUNTIME_ROOT_DIR \
+      -DUSE_CUDA=$USE_CUDA \
       ..
 
 # Build
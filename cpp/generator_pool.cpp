@@ -0,0 +1,130 @@
+/**
+ * @file generator_pool.cpp
+ * @brief Implementation of the shared-session generator pool
+ */
+
+#include "generator_pool.h"
+#include <algorithm>
+#include <thread>
+
+namespace trajectory {
+
+GeneratorPool::Lease::Lease(GeneratorPool* pool, TrajectoryGenerator* generator)
+    : pool_(pool), generator_(generator) {}
+
+GeneratorPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), generator_(other.generator_) {
+    other.pool_ = nullptr;
+    other.generator_ = nullptr;
+}
+
+GeneratorPool::Lease::~Lease() {
+    if (pool_) {
+        pool_->release(generator_);
+    }
+}
+
+GeneratorPool::GeneratorPool(const GeneratorConfig& config, size_t num_workers) {
+    if (num_workers == 0) {
+        num_workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    model_ = std::make_shared<ModelSession>(config);
+    
+    // All workers share one seed; submitted requests get pool-wide ids, so
+    // results do not depend on which worker runs them. Auto-assigned ids of
+    // leased generators start in disjoint per-worker ranges above those.
+    GeneratorConfig worker_config = config;
+    generators_.reserve(num_workers);
+    idle_.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        generators_.push_back(std::make_unique<TrajectoryGenerator>(model_, worker_config));
+        generators_.back()->setNextRequestId(static_cast<uint64_t>(i + 1) << kLeaseIdShift);
+        idle_.push_back(generators_.back().get());
+        
+        worker_config.seed = generators_.front()->getSeed();
+    }
+    
+    workers_ = std::make_unique<ThreadPool>(num_workers);
+}
+
+GeneratorPool::~GeneratorPool() {
+    workers_.reset();
+}
+
+bool GeneratorPool::loadNormalization(const std::string& norm_path) {
+    if (generators_.empty() || !generators_[0]->loadNormalization(norm_path)) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 1; i < generators_.size(); ++i) {
+        generators_[i]->setNormalization(generators_[0]->getNormalization());
+    }
+    return true;
+}
+
+void GeneratorPool::warmup(const std::vector<int>& batch_sizes) {
+    for (auto& generator : generators_) {
+        generator->warmup(batch_sizes);
+    }
+}
+
+GeneratorPool::Lease GeneratorPool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return !idle_.empty(); });
+    
+    TrajectoryGenerator* generator = idle_.back();
+    idle_.pop_back();
+    return Lease(this, generator);
+}
+
+void GeneratorPool::release(TrajectoryGenerator* generator) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(generator);
+    }
+    cv_.notify_one();
+}
+
+std::future<std::vector<Trajectory>> GeneratorPool::submit(const Waypoint& start,
+                                                           const Waypoint& end,
+                                                           int n_samples) {
+    const GenerationRequest request(start, end, n_samples, next_request_id_.fetch_add(1));
+    
+    return workers_->submit([this, request]() {
+        Lease generator = acquire();
+        return std::move(generator->generateBatch(&request, 1).trajectories);
+    });
+}
+
+std::future<BatchResult> GeneratorPool::submitBatch(std::vector<GenerationRequest> requests) {
+    assignRequestIds(requests.data(), requests.size());
+    
+    return workers_->submit([this, requests = std::move(requests)]() {
+        Lease generator = acquire();
+        return generator->generateBatch(requests);
+    });
+}
+
+std::vector<Trajectory> GeneratorPool::generateMultiple(const Waypoint& start, const Waypoint& end,
+                                                        int n_samples) {
+    const GenerationRequest request(start, end, n_samples, next_request_id_.fetch_add(1));
+    
+    Lease generator = acquire();
+    return std::move(generator->generateBatch(&request, 1).trajectories);
+}
+
+void GeneratorPool::assignRequestIds(GenerationRequest* requests, size_t num_requests) {
+    size_t n_auto = 0;
+    for (size_t r = 0; r < num_requests; ++r) {
+        if (requests[r].request_id == kAutoRequestId) ++n_auto;
+    }
+    
+    uint64_t id = next_request_id_.fetch_add(n_auto);
+    for (size_t r = 0; r < num_requests; ++r) {
+        if (requests[r].request_id == kAutoRequestId) requests[r].request_id = id++;
+    }
+}
+
+} // namespace trajectory
@@ -0,0 +1,163 @@
+/**
+ * @file generator_pool.h
+ * @brief Thread-safe pool of trajectory generators over one shared model
+ * @author Mission Planner Team
+ * 
+ * TrajectoryGenerator keeps its RNG and staging buffers in the object, so
+ * it cannot serve concurrent generate() calls. GeneratorPool loads the
+ * model once into a ModelSession and gives each worker its own lightweight
+ * generator (RNG, buffers, I/O bindings) over that session.
+ */
+
+#ifndef GENERATOR_POOL_H
+#define GENERATOR_POOL_H
+
+#include "trajectory_inference.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace trajectory {
+
+/**
+ * @brief Concurrent trajectory generation over a shared ONNX session
+ * 
+ * Work can be submitted from any thread. Submitted requests run on the
+ * pool's worker threads; acquire() checks a generator out for direct use
+ * on the calling thread instead.
+ */
+class GeneratorPool {
+public:
+    /**
+     * @brief Exclusive use of one pooled generator; returned on destruction
+     */
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) = delete;
+        ~Lease();
+        
+        TrajectoryGenerator& operator*() const { return *generator_; }
+        TrajectoryGenerator* operator->() const { return generator_; }
+    
+    private:
+        friend class GeneratorPool;
+        Lease(GeneratorPool* pool, TrajectoryGenerator* generator);
+        
+        GeneratorPool* pool_;
+        TrajectoryGenerator* generator_;
+    };
+    
+    /**
+     * @brief Load the model and create the worker generators
+     * 
+     * Workers share config.seed (or one random seed, see getSeed()).
+     * Requests submitted through the pool are numbered 0, 1, 2, ... in
+     * submission order, so their latents do not depend on the worker.
+     * 
+     * @param config Generator configuration shared by all workers
+     * @param num_workers Worker threads and generators (0 = hardware concurrency)
+     */
+    explicit GeneratorPool(const GeneratorConfig& config, size_t num_workers = 0);
+    
+    /**
+     * @brief Finish submitted work and stop the workers
+     */
+    ~GeneratorPool();
+    
+    GeneratorPool(const GeneratorPool&) = delete;
+    GeneratorPool& operator=(const GeneratorPool&) = delete;
+    
+    /**
+     * @brief Load normalization parameters for every generator
+     * 
+     * Must not be called while requests are in flight.
+     * 
+     * @param norm_path Path to normalization JSON file
+     * @return true if loaded successfully
+     */
+    bool loadNormalization(const std::string& norm_path);
+    
+    /**
+     * @brief Warm up every generator (see TrajectoryGenerator::warmup)
+     * 
+     * Must not be called while requests are in flight.
+     */
+    void warmup(const std::vector<int>& batch_sizes = std::vector<int>());
+    
+    /**
+     * @brief Queue generation of several trajectories for one request
+     * @param start Start position
+     * @param end End position
+     * @param n_samples Number of trajectories to generate
+     * @return Future for the trajectories (inference errors are forwarded)
+     */
+    std::future<std::vector<Trajectory>> submit(const Waypoint& start, const Waypoint& end,
+                                                int n_samples);
+    
+    /**
+     * @brief Queue a batch of requests
+     * @param requests Requests to process together
+     * @return Future for the batch result
+     */
+    std::future<BatchResult> submitBatch(std::vector<GenerationRequest> requests);
+    
+    /**
+     * @brief Generate on the calling thread (blocks until a generator is free)
+     */
+    std::vector<Trajectory> generateMultiple(const Waypoint& start, const Waypoint& end,
+                                             int n_samples);
+    
+    /**
+     * @brief Check out a generator, waiting until one is idle
+     */
+    Lease acquire();
+    
+    /**
+     * @brief Number of generators (and worker threads)
+     */
+    size_t size() const { return generators_.size(); }
+    
+    /**
+     * @brief Sequence length of generated trajectories
+     */
+    int getSeqLen() const { return model_->outputSeqLen(); }
+    
+    /**
+     * @brief Latent seed shared by all workers
+     */
+    uint64_t getSeed() const { return generators_.front()->getSeed(); }
+    
+    /**
+     * @brief Model session shared by all generators
+     */
+    std::shared_ptr<ModelSession> getModelSession() const { return model_; }
+
+private:
+    // Leased generator i auto-assigns ids from (i + 1) << kLeaseIdShift
+    static constexpr int kLeaseIdShift = 48;
+    
+    void release(TrajectoryGenerator* generator);
+    void assignRequestIds(GenerationRequest* requests, size_t num_requests);
+    
+    std::shared_ptr<ModelSession> model_;
+    std::vector<std::unique_ptr<TrajectoryGenerator>> generators_;
+    
+    std::atomic<uint64_t> next_request_id_{0};
+    
+    std::vector<TrajectoryGenerator*> idle_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    
+    // Declared last so workers are joined before the generators go away
+    std::unique_ptr<ThreadPool> workers_;
+};
+
+} // namespace trajectory
+
+#endif // GENERATOR_POOL_H
@@ -0,0 +1,565 @@
+/**
+ * @file http_server.cpp
+ * @brief Implementation of the blocking HTTP/1.1 server
+ */
+
+#include "http_server.h"
+#include "json_value.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace trajectory {
+
+namespace {
+
+constexpr intptr_t kInvalidSocket = -1;
+constexpr size_t kMaxHeaderBytes = 64u << 10;
+
+using Clock = std::chrono::steady_clock;
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+using PollFd = WSAPOLLFD;
+constexpr short kPollIn = POLLRDNORM;
+
+void closeSocket(intptr_t s) { closesocket(static_cast<SOCKET>(s)); }
+
+int pollSockets(PollFd* fds, size_t count, int timeout_ms) {
+    return WSAPoll(fds, static_cast<ULONG>(count), timeout_ms);
+}
+
+void setSendTimeout(intptr_t s, std::chrono::milliseconds timeout) {
+    DWORD ms = static_cast<DWORD>(timeout.count());
+    setsockopt(static_cast<SOCKET>(s), SOL_SOCKET, SO_SNDTIMEO,
+               reinterpret_cast<const char*>(&ms), sizeof(ms));
+}
+
+/**
+ * @brief Winsock must be initialized once per process
+ */
+void initSockets() {
+    static const bool initialized = []() {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    if (!initialized) throw std::runtime_error("WSAStartup failed");
+}
+#else
+using SocketHandle = int;
+using PollFd = pollfd;
+constexpr short kPollIn = POLLIN;
+
+void closeSocket(intptr_t s) { ::close(static_cast<int>(s)); }
+
+int pollSockets(PollFd* fds, size_t count, int timeout_ms) {
+    return ::poll(fds, static_cast<nfds_t>(count), timeout_ms);
+}
+
+void setSendTimeout(intptr_t s, std::chrono::milliseconds timeout) {
+    timeval tv;
+    tv.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+    tv.tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000);
+    setsockopt(static_cast<int>(s), SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+void initSockets() {}
+#endif
+
+/**
+ * @brief Send everything (false if the peer went away)
+ */
+bool sendAll(intptr_t s, const char* data, size_t size) {
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;   // A closed peer must not raise SIGPIPE
+#else
+    const int flags = 0;
+#endif
+    while (size > 0) {
+        const int chunk = static_cast<int>(std::min<size_t>(size, 1u << 30));
+        const auto sent = ::send(static_cast<SocketHandle>(s), data, chunk, flags);
+        if (sent <= 0) return false;
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+/**
+ * @brief Append whatever the peer sends next (false on close or error)
+ * 
+ * Only called once poll() reported the socket readable, so it does not block.
+ */
+bool receiveMore(intptr_t s, std::string& buffer) {
+    char chunk[16384];
+    const auto received = ::recv(static_cast<SocketHandle>(s), chunk, sizeof(chunk), 0);
+    if (received <= 0) return false;
+    buffer.append(chunk, static_cast<size_t>(received));
+    return true;
+}
+
+const char* reasonPhrase(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 422: return "Unprocessable Entity";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        default: return "Unknown";
+    }
+}
+
+std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+std::string trim(const std::string& text) {
+    const size_t first = text.find_first_not_of(" \t");
+    if (first == std::string::npos) return std::string();
+    const size_t last = text.find_last_not_of(" \t");
+    return text.substr(first, last - first + 1);
+}
+
+bool sendResponse(intptr_t s, const HttpResponse& response, bool keep_alive) {
+    std::string head = "HTTP/1.1 " + std::to_string(response.status) + " " +
+                       reasonPhrase(response.status) + "\r\n";
+    if (response.status == 204) {
+        // Preflight answer for browser clients (the FastAPI app allows any origin)
+        head += "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
+                "Access-Control-Allow-Headers: *\r\n";
+    } else {
+        head += "Content-Type: " + response.content_type + "\r\n";
+    }
+    head += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+    head += "Access-Control-Allow-Origin: *\r\n";
+    head += keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    
+    return sendAll(s, head.data(), head.size()) &&
+           sendAll(s, response.body.data(), response.body.size());
+}
+
+/**
+ * @brief Parse the request line and headers of head (without the blank line)
+ * @return false if malformed
+ */
+bool parseHead(const std::string& head, HttpRequest& request, std::string& version) {
+    size_t line_end = head.find("\r\n");
+    const std::string request_line = head.substr(0, line_end);
+    
+    const size_t sp1 = request_line.find(' ');
+    const size_t sp2 = request_line.rfind(' ');
+    if (sp1 == std::string::npos || sp2 == sp1) return false;
+    
+    request.method = request_line.substr(0, sp1);
+    std::string target = request_line.substr(sp1 + 1, sp2 - sp1 - 1);
+    version = request_line.substr(sp2 + 1);
+    if (version.compare(0, 5, "HTTP/") != 0 || target.empty()) return false;
+    
+    const size_t question = target.find('?');
+    request.path = target.substr(0, question);
+    request.query = question == std::string::npos ? std::string() : target.substr(question + 1);
+    
+    while (line_end != std::string::npos) {
+        const size_t start = line_end + 2;
+        line_end = head.find("\r\n", start);
+        const std::string line = head.substr(start, line_end == std::string::npos
+                                                        ? std::string::npos : line_end - start);
+        if (line.empty()) continue;
+        
+        const size_t colon = line.find(':');
+        if (colon == std::string::npos || colon == 0) return false;
+        request.headers[toLower(line.substr(0, colon))] = trim(line.substr(colon + 1));
+    }
+    return true;
+}
+
+/**
+ * @brief Loopback UDP socket connected to itself, for waking poll()
+ */
+intptr_t openWakeSocket() {
+    const auto s = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (static_cast<intptr_t>(s) == kInvalidSocket) return kInvalidSocket;
+    
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (::bind(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        getsockname(s, reinterpret_cast<sockaddr*>(&address), &length) != 0 ||
+        ::connect(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        closeSocket(static_cast<intptr_t>(s));
+        return kInvalidSocket;
+    }
+    return static_cast<intptr_t>(s);
+}
+
+} // namespace
+
+/**
+ * @brief A client connection and its partly read request
+ */
+struct HttpServer::Connection {
+    intptr_t socket = kInvalidSocket;
+    std::string buffer;            // Received, not yet consumed bytes
+    HttpRequest request;           // Head filled in once head_done
+    bool head_done = false;
+    bool keep_alive = true;
+    size_t content_length = 0;
+    Clock::time_point opened;
+    Clock::time_point last_active;      // Last response sent (or accept)
+    Clock::time_point request_started;  // First byte of the request being read
+    
+    ~Connection() {
+        if (socket != kInvalidSocket) closeSocket(socket);
+    }
+    
+    /**
+     * @brief Send a final error response; the destructor closes the socket
+     */
+    void reject(int status, const std::string& message) {
+        sendResponse(socket, httpError(status, message), false);
+    }
+    
+    bool reading() const { return head_done || !buffer.empty(); }
+};
+
+std::string HttpRequest::header(const std::string& name) const {
+    auto it = headers.find(name);
+    return it == headers.end() ? std::string() : it->second;
+}
+
+HttpResponse httpError(int status, const std::string& message) {
+    return HttpResponse(status, "{\"detail\": " + jsonQuote(message) + "}");
+}
+
+// ============================================================================
+// HttpServer
+// ============================================================================
+
+HttpServer::HttpServer(const HttpServerConfig& config)
+    : config_(config)
+    , listener_(kInvalidSocket)
+    , wake_(kInvalidSocket)
+    , port_(0)
+    , stopping_(false)
+    , wake_pending_(false)
+{
+    initSockets();
+}
+
+HttpServer::~HttpServer() {
+    if (listener_ != kInvalidSocket) closeSocket(listener_);
+    if (wake_ != kInvalidSocket) closeSocket(wake_);
+}
+
+void HttpServer::route(const std::string& method, const std::string& path, HttpHandler handler) {
+    routes_.push_back({method, path, std::move(handler)});
+}
+
+bool HttpServer::listen(const std::string& host, uint16_t port) {
+    const auto s = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (static_cast<intptr_t>(s) == kInvalidSocket) {
+        std::cerr << "Error: cannot create socket" << std::endl;
+        return false;
+    }
+    
+    int reuse = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+    
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        std::cerr << "Error: invalid IPv4 address " << host << std::endl;
+        closeSocket(static_cast<intptr_t>(s));
+        return false;
+    }
+    
+    if (::bind(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(s, SOMAXCONN) != 0) {
+        std::cerr << "Error: cannot listen on " << host << ":" << port << std::endl;
+        closeSocket(static_cast<intptr_t>(s));
+        return false;
+    }
+    
+    socklen_t length = sizeof(address);
+    getsockname(s, reinterpret_cast<sockaddr*>(&address), &length);
+    port_ = ntohs(address.sin_port);
+    listener_ = static_cast<intptr_t>(s);
+    return true;
+}
+
+void HttpServer::run() {
+    if (listener_ == kInvalidSocket) {
+        throw std::runtime_error("HttpServer::run() called before listen()");
+    }
+    if (wake_ == kInvalidSocket) {
+        wake_ = openWakeSocket();
+        if (wake_ == kInvalidSocket) throw std::runtime_error("HttpServer: cannot create wake socket");
+    }
+    
+    std::vector<std::unique_ptr<Connection>> polled;
+    std::vector<PollFd> fds;
+    std::atomic<size_t> busy{0};
+    
+    // Requests ready to serve leave polled for a worker; a full request
+    // already in the buffer (pipelining) is served without waiting
+    auto dispatchReady = [&](size_t i, ThreadPool& workers) {
+        const ReadState state = advance(*polled[i]);
+        if (state == ReadState::NeedMore) return false;
+        
+        std::unique_ptr<Connection> connection = std::move(polled[i]);
+        polled[i] = std::move(polled.back());
+        polled.pop_back();
+        if (state == ReadState::Ready) {
+            busy++;
+            workers.submit([this, &busy, c = connection.release()]() {
+                serveRequest(std::unique_ptr<Connection>(c));
+                busy--;
+            });
+        }
+        return true;
+    };
+    
+    {
+        ThreadPool workers(config_.num_threads);
+        
+        while (!stopping_.load()) {
+            fds.clear();
+            fds.push_back(PollFd{static_cast<SocketHandle>(listener_), kPollIn, 0});
+            fds.push_back(PollFd{static_cast<SocketHandle>(wake_), kPollIn, 0});
+            for (const auto& connection : polled) {
+                fds.push_back(PollFd{static_cast<SocketHandle>(connection->socket), kPollIn, 0});
+            }
+            
+            // Short timeout so stop() (e.g. from a signal handler) and the
+            // connection timeouts are noticed promptly
+            if (pollSockets(fds.data(), fds.size(), 200) < 0) continue;
+            const auto now = Clock::now();
+            
+            // Read before taking new connections: polled and fds still line up
+            for (size_t i = polled.size(); i-- > 0;) {
+                const short events = fds[i + 2].revents;
+                if (events == 0) continue;
+                
+                Connection& connection = *polled[i];
+                const bool was_reading = connection.reading();
+                if (!(events & kPollIn) || !receiveMore(connection.socket, connection.buffer)) {
+                    polled[i] = std::move(polled.back());   // Peer closed or errored
+                    polled.pop_back();
+                    continue;
+                }
+                if (!was_reading) connection.request_started = now;
+                dispatchReady(i, workers);
+            }
+            
+            // Timeouts: idle keep-alive, slow requests, old connections
+            for (size_t i = polled.size(); i-- > 0;) {
+                Connection& connection = *polled[i];
+                bool expired;
+                if (connection.reading()) {
+                    expired = now - connection.request_started > config_.request_timeout;
+                    if (expired) connection.reject(408, "Request not received in time");
+                } else {
+                    expired = now - connection.last_active > config_.idle_timeout ||
+                              now - connection.opened > config_.connection_timeout;
+                }
+                if (expired) {
+                    polled[i] = std::move(polled.back());
+                    polled.pop_back();
+                }
+            }
+            
+            if (fds[1].revents & kPollIn) {
+                char drained[16];
+                ::recv(static_cast<SocketHandle>(wake_), drained, sizeof(drained), 0);
+                wake_pending_.store(false);
+                
+                std::vector<std::unique_ptr<Connection>> returned;
+                {
+                    std::lock_guard<std::mutex> lock(returned_mutex_);
+                    returned.swap(returned_);
+                }
+                for (auto& connection : returned) {
+                    if (!connection->buffer.empty()) connection->request_started = now;
+                    polled.push_back(std::move(connection));
+                    dispatchReady(polled.size() - 1, workers);
+                }
+            }
+            
+            if (fds[0].revents & kPollIn) {
+                const auto client = ::accept(static_cast<SocketHandle>(listener_), nullptr, nullptr);
+                if (static_cast<intptr_t>(client) == kInvalidSocket) continue;
+                
+                auto connection = std::make_unique<Connection>();
+                connection->socket = static_cast<intptr_t>(client);
+                connection->opened = now;
+                connection->last_active = now;
+                
+                int no_delay = 1;
+                setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&no_delay),
+                           sizeof(no_delay));
+                setSendTimeout(connection->socket, config_.request_timeout);
+                
+                if (polled.size() + busy.load() >= config_.max_connections) {
+                    connection->reject(503, "Too many connections");
+                    continue;
+                }
+                polled.push_back(std::move(connection));
+            }
+        }
+        
+        // Leaving the scope waits for in-flight requests
+    }
+    
+    std::lock_guard<std::mutex> lock(returned_mutex_);
+    returned_.clear();
+}
+
+HttpServer::ReadState HttpServer::advance(Connection& connection) const {
+    std::string& buffer = connection.buffer;
+    
+    if (!connection.head_done) {
+        const size_t head_end = buffer.find("\r\n\r\n");
+        if (head_end == std::string::npos) {
+            if (buffer.size() > kMaxHeaderBytes) {
+                connection.reject(431, "Request header too large");
+                return ReadState::Closed;
+            }
+            return ReadState::NeedMore;
+        }
+        
+        HttpRequest& request = connection.request;
+        request = HttpRequest();
+        std::string version;
+        if (!parseHead(buffer.substr(0, head_end), request, version)) {
+            connection.reject(400, "Malformed request");
+            return ReadState::Closed;
+        }
+        buffer.erase(0, head_end + 4);
+        
+        const std::string header = toLower(request.header("connection"));
+        connection.keep_alive = version == "HTTP/1.1" ? header != "close" : header == "keep-alive";
+        
+        if (!request.header("transfer-encoding").empty()) {
+            connection.reject(501, "Chunked request bodies are not supported");
+            return ReadState::Closed;
+        }
+        
+        connection.content_length = 0;
+        const auto length_header = request.headers.find("content-length");
+        if (length_header != request.headers.end()) {
+            // The body is framed by this value, so only plain digits are accepted
+            // (stoull alone takes "+12" or "12abc" and wraps "-1")
+            const std::string& text = length_header->second;
+            bool valid = !text.empty() && text.find_first_not_of("0123456789") == std::string::npos;
+            if (valid) {
+                try {
+                    connection.content_length = std::stoull(text);
+                } catch (const std::exception&) {
+                    valid = false;
+                }
+            }
+            if (!valid) {
+                connection.reject(400, "Invalid Content-Length");
+                return ReadState::Closed;
+            }
+        }
+        if (connection.content_length > config_.max_body_bytes) {
+            connection.reject(413, "Request body too large");
+            return ReadState::Closed;
+        }
+        if (connection.content_length > buffer.size() &&
+            toLower(request.header("expect")) == "100-continue") {
+            static const char kContinue[] = "HTTP/1.1 100 Continue\r\n\r\n";
+            sendAll(connection.socket, kContinue, sizeof(kContinue) - 1);
+        }
+        connection.head_done = true;
+    }
+    
+    if (buffer.size() < connection.content_length) return ReadState::NeedMore;
+    
+    connection.request.body = buffer.substr(0, connection.content_length);
+    buffer.erase(0, connection.content_length);
+    connection.head_done = false;
+    return ReadState::Ready;
+}
+
+void HttpServer::serveRequest(std::unique_ptr<Connection> connection) {
+    const HttpRequest& request = connection->request;
+    
+    HttpResponse response;
+    if (request.method == "OPTIONS") {
+        response.status = 204;
+    } else {
+        try {
+            response = dispatch(request);
+        } catch (const std::exception& e) {
+            response = httpError(500, e.what());
+        }
+    }
+    
+    const auto now = Clock::now();
+    const bool keep_alive = connection->keep_alive && !stopping_.load() &&
+                            now - connection->opened < config_.connection_timeout;
+    if (!sendResponse(connection->socket, response, keep_alive) || !keep_alive) {
+        return;   // Closed by the destructor
+    }
+    
+    connection->request = HttpRequest();
+    connection->last_active = Clock::now();
+    handBack(std::move(connection));
+}
+
+void HttpServer::handBack(std::unique_ptr<Connection> connection) {
+    {
+        std::lock_guard<std::mutex> lock(returned_mutex_);
+        returned_.push_back(std::move(connection));
+    }
+    // One datagram per drain is enough; the poll thread clears the flag
+    // before taking the list, so nothing pushed here can be missed
+    if (!wake_pending_.exchange(true)) {
+        const char byte = 0;
+        ::send(static_cast<SocketHandle>(wake_), &byte, 1, 0);
+    }
+}
+
+HttpResponse HttpServer::dispatch(const HttpRequest& request) const {
+    bool path_known = false;
+    for (const Route& route : routes_) {
+        if (route.path != request.path) continue;
+        path_known = true;
+        if (route.method == request.method) return route.handler(request);
+    }
+    return path_known ? httpError(405, "Method Not Allowed") : httpError(404, "Not Found");
+}
+
+} // namespace trajectory
@@ -0,0 +1,163 @@
+/**
+ * @file http_server.h
+ * @brief Small blocking HTTP/1.1 server for the trajectory service
+ * @author Mission Planner Team
+ * 
+ * One poll thread accepts connections and reads requests on all of them;
+ * a ThreadPool worker only gets a connection once a complete request has
+ * arrived, and hands it back to the poll thread after responding. Idle
+ * keep-alive or slowly trickling clients therefore never hold a worker.
+ * Bodies need a Content-Length (no chunked uploads).
+ * That is all a JSON/binary RPC endpoint behind a load balancer needs,
+ * without pulling in an HTTP library.
+ */
+
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include "thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace trajectory {
+
+/**
+ * @brief Parsed request
+ */
+struct HttpRequest {
+    std::string method;                          // "GET", "POST", ...
+    std::string path;                            // Without the query string
+    std::string query;                           // After '?', undecoded
+    std::map<std::string, std::string> headers;  // Lower-case names
+    std::string body;
+    
+    /**
+     * @brief Header value, or "" if absent
+     * @param name Lower-case header name
+     */
+    std::string header(const std::string& name) const;
+};
+
+/**
+ * @brief Response to send
+ */
+struct HttpResponse {
+    int status = 200;
+    std::string content_type = "application/json";
+    std::string body;
+    
+    HttpResponse() = default;
+    HttpResponse(int code, std::string text, std::string type = "application/json")
+        : status(code), content_type(std::move(type)), body(std::move(text)) {}
+};
+
+/**
+ * @brief Request handler; exceptions become 500 responses
+ */
+using HttpHandler = std::function<HttpResponse(const HttpRequest&)>;
+
+/**
+ * @brief Limits and timeouts for HttpServer
+ */
+struct HttpServerConfig {
+    size_t num_threads = 8;                               // Request workers
+    size_t max_body_bytes = 16u << 20;                    // Larger bodies get 413
+    size_t max_connections = 1024;                        // Further clients get 503 and are closed
+    std::chrono::milliseconds idle_timeout{5000};         // Close keep-alive connections idle this long
+    std::chrono::milliseconds request_timeout{10000};     // First byte to full request (else 408); also the send timeout
+    std::chrono::milliseconds connection_timeout{60000};  // No keep-alive once a connection is this old
+};
+
+/**
+ * @brief Route table plus accept loop
+ * 
+ * Register routes before run(); the table is read without locking.
+ */
+class HttpServer {
+public:
+    explicit HttpServer(const HttpServerConfig& config = HttpServerConfig());
+    
+    /**
+     * @brief Close the sockets (call stop() and wait for run() first)
+     */
+    ~HttpServer();
+    
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+    
+    /**
+     * @brief Serve method + exact path with handler
+     */
+    void route(const std::string& method, const std::string& path, HttpHandler handler);
+    
+    /**
+     * @brief Bind and listen
+     * @param host IPv4 address to bind ("0.0.0.0" for all interfaces)
+     * @param port TCP port (0 = any free port, see port())
+     * @return true if the socket is listening
+     */
+    bool listen(const std::string& host, uint16_t port);
+    
+    /**
+     * @brief Port actually bound (after listen())
+     */
+    uint16_t port() const { return port_; }
+    
+    /**
+     * @brief Accept and serve connections until stop()
+     * 
+     * Returns after the workers have finished their requests.
+     */
+    void run();
+    
+    /**
+     * @brief Ask run() to return (async-signal-safe)
+     */
+    void stop() { stopping_.store(true); }
+
+private:
+    struct Route {
+        std::string method;
+        std::string path;
+        HttpHandler handler;
+    };
+    
+    struct Connection;
+    
+    /**
+     * @brief Read state of a polled connection after new bytes arrived
+     */
+    enum class ReadState { NeedMore, Ready, Closed };
+    
+    ReadState advance(Connection& connection) const;
+    void serveRequest(std::unique_ptr<Connection> connection);
+    void handBack(std::unique_ptr<Connection> connection);
+    HttpResponse dispatch(const HttpRequest& request) const;
+    
+    HttpServerConfig config_;
+    std::vector<Route> routes_;
+    intptr_t listener_;
+    intptr_t wake_;   // Loopback UDP socket connected to itself; wakes the poll thread
+    uint16_t port_;
+    std::atomic<bool> stopping_;
+    
+    std::mutex returned_mutex_;
+    std::vector<std::unique_ptr<Connection>> returned_;  // Served keep-alive connections for the poll thread
+    std::atomic<bool> wake_pending_;
+};
+
+/**
+ * @brief {"detail": message} error response, as FastAPI returns
+ */
+HttpResponse httpError(int status, const std::string& message);
+
+} // namespace trajectory
+
+#endif // HTTP_SERVER_H
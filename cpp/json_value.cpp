@@ -0,0 +1,290 @@
+/**
+ * @file json_value.cpp
+ * @brief Recursive-descent JSON parser
+ */
+
+#include "json_value.h"
+#include <charconv>
+#include <cstdint>
+#include <stdexcept>
+
+namespace trajectory {
+
+/**
+ * @brief Parser state over one document
+ */
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : text_(text), pos_(0) {}
+    
+    JsonValue parseDocument() {
+        JsonValue root = parseValue(0);
+        skipWhitespace();
+        if (pos_ != text_.size()) fail("unexpected trailing characters");
+        return root;
+    }
+
+private:
+    // Deeper documents are rejected rather than risking the stack
+    static constexpr int kMaxDepth = 256;
+    
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::runtime_error("JSON parse error at offset " + std::to_string(pos_) + ": " + message);
+    }
+    
+    void skipWhitespace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+    
+    bool consume(char c) {
+        skipWhitespace();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+    
+    void expectLiteral(const char* literal) {
+        for (const char* p = literal; *p; ++p, ++pos_) {
+            if (pos_ >= text_.size() || text_[pos_] != *p) fail(std::string("expected ") + literal);
+        }
+    }
+    
+    JsonValue parseValue(int depth) {
+        if (depth > kMaxDepth) fail("nesting too deep");
+        
+        skipWhitespace();
+        if (pos_ >= text_.size()) fail("unexpected end of input");
+        
+        JsonValue value;
+        const char c = text_[pos_];
+        
+        if (c == '{') {
+            ++pos_;
+            value.type_ = JsonValue::Type::Object;
+            if (consume('}')) return value;
+            do {
+                skipWhitespace();
+                if (pos_ >= text_.size() || text_[pos_] != '"') fail("expected member name");
+                value.keys_.push_back(parseString());
+                if (!consume(':')) fail("expected ':'");
+                value.values_.push_back(parseValue(depth + 1));
+            } while (consume(','));
+            if (!consume('}')) fail("expected ',' or '}'");
+        } else if (c == '[') {
+            ++pos_;
+            value.type_ = JsonValue::Type::Array;
+            if (consume(']')) return value;
+            do {
+                value.values_.push_back(parseValue(depth + 1));
+            } while (consume(','));
+            if (!consume(']')) fail("expected ',' or ']'");
+        } else if (c == '"') {
+            value.type_ = JsonValue::Type::String;
+            value.string_ = parseString();
+        } else if (c == 't') {
+            expectLiteral("true");
+            value.type_ = JsonValue::Type::Bool;
+            value.bool_ = true;
+        } else if (c == 'f') {
+            expectLiteral("false");
+            value.type_ = JsonValue::Type::Bool;
+        } else if (c == 'n') {
+            expectLiteral("null");
+        } else {
+            value.type_ = JsonValue::Type::Number;
+            value.number_ = parseNumber();
+        }
+        
+        return value;
+    }
+    
+    double parseNumber() {
+        // Validate the RFC 8259 grammar first; from_chars alone would also
+        // accept forms like "1." or "inf"
+        const size_t start = pos_;
+        auto digits = [&]() {
+            const size_t first = pos_;
+            while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') ++pos_;
+            return pos_ - first;
+        };
+        
+        if (pos_ < text_.size() && text_[pos_] == '-') ++pos_;
+        if (pos_ < text_.size() && text_[pos_] == '0') {
+            ++pos_;
+        } else if (digits() == 0) {
+            fail("invalid value");
+        }
+        if (pos_ < text_.size() && text_[pos_] == '.') {
+            ++pos_;
+            if (digits() == 0) fail("expected digits after '.'");
+        }
+        if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+            ++pos_;
+            if (pos_ < text_.size() && (text_[pos_] == '+' || text_[pos_] == '-')) ++pos_;
+            if (digits() == 0) fail("expected exponent digits");
+        }
+        
+        double number = 0.0;
+        const auto result = std::from_chars(text_.data() + start, text_.data() + pos_, number);
+        if (result.ec == std::errc::result_out_of_range) {
+            fail("number out of range");
+        }
+        return number;
+    }
+    
+    uint32_t parseHex4() {
+        if (pos_ + 4 > text_.size()) fail("truncated \\u escape");
+        uint32_t code = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char h = text_[pos_++];
+            code <<= 4;
+            if (h >= '0' && h <= '9') code |= static_cast<uint32_t>(h - '0');
+            else if (h >= 'a' && h <= 'f') code |= static_cast<uint32_t>(h - 'a' + 10);
+            else if (h >= 'A' && h <= 'F') code |= static_cast<uint32_t>(h - 'A' + 10);
+            else fail("invalid \\u escape");
+        }
+        return code;
+    }
+    
+    static void appendUtf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+    
+    std::string parseString() {
+        ++pos_;  // opening quote
+        std::string out;
+        
+        for (;;) {
+            if (pos_ >= text_.size()) fail("unterminated string");
+            const char c = text_[pos_++];
+            
+            if (c == '"') return out;
+            if (static_cast<unsigned char>(c) < 0x20) fail("control character in string");
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            
+            if (pos_ >= text_.size()) fail("unterminated string");
+            switch (text_[pos_++]) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    uint32_t code = parseHex4();
+                    if (code >= 0xD800 && code <= 0xDBFF) {
+                        // Surrogate pair: the low half must follow
+                        if (pos_ + 2 > text_.size() || text_[pos_] != '\\' || text_[pos_ + 1] != 'u') {
+                            fail("unpaired surrogate");
+                        }
+                        pos_ += 2;
+                        const uint32_t low = parseHex4();
+                        if (low < 0xDC00 || low > 0xDFFF) fail("unpaired surrogate");
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    } else if (code >= 0xDC00 && code <= 0xDFFF) {
+                        fail("unpaired surrogate");
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default:
+                    fail("invalid escape");
+            }
+        }
+    }
+    
+    const std::string& text_;
+    size_t pos_;
+};
+
+JsonValue JsonValue::parse(const std::string& text) {
+    return JsonParser(text).parseDocument();
+}
+
+bool JsonValue::asBool() const {
+    if (type_ != Type::Bool) throw std::runtime_error("JSON value is not a boolean");
+    return bool_;
+}
+
+double JsonValue::asNumber() const {
+    if (type_ != Type::Number) throw std::runtime_error("JSON value is not a number");
+    return number_;
+}
+
+const std::string& JsonValue::asString() const {
+    if (type_ != Type::String) throw std::runtime_error("JSON value is not a string");
+    return string_;
+}
+
+const JsonValue& JsonValue::operator[](size_t i) const {
+    if (type_ != Type::Array) throw std::runtime_error("JSON value is not an array");
+    if (i >= values_.size()) throw std::runtime_error("JSON array index out of range");
+    return values_[i];
+}
+
+const JsonValue* JsonValue::find(const std::string& key) const {
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        if (keys_[i] == key) return &values_[i];
+    }
+    return nullptr;
+}
+
+double JsonValue::numberOr(const std::string& key, double fallback) const {
+    const JsonValue* member = find(key);
+    if (!member || member->isNull()) return fallback;
+    if (!member->isNumber()) throw std::runtime_error("JSON member '" + key + "' is not a number");
+    return member->number_;
+}
+
+std::string jsonQuote(const std::string& text) {
+    static const char hex[] = "0123456789abcdef";
+    
+    std::string out;
+    out.reserve(text.size() + 2);
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += hex[(c >> 4) & 0xF];
+                    out += hex[c & 0xF];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+    return out;
+}
+
+} // namespace trajectory
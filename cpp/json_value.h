@@ -0,0 +1,108 @@
+/**
+ * @file json_value.h
+ * @brief Minimal JSON document model and parser
+ * @author Mission Planner Team
+ * 
+ * Enough JSON for request bodies and model sidecar files: RFC 8259
+ * values, \uXXXX escapes (decoded to UTF-8) and a nesting limit, with no
+ * external dependency. Numbers are parsed locale-independently. Objects
+ * keep their members in document order; duplicate keys resolve to the
+ * first occurrence.
+ */
+
+#ifndef JSON_VALUE_H
+#define JSON_VALUE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace trajectory {
+
+/**
+ * @brief Immutable parsed JSON value
+ */
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+    
+    /**
+     * @brief Null value
+     */
+    JsonValue() = default;
+    
+    /**
+     * @brief Parse a complete JSON document
+     * @param text Document text (UTF-8)
+     * @return Root value
+     * @throws std::runtime_error with the byte offset of the first error
+     */
+    static JsonValue parse(const std::string& text);
+    
+    Type type() const { return type_; }
+    bool isNull() const { return type_ == Type::Null; }
+    bool isBool() const { return type_ == Type::Bool; }
+    bool isNumber() const { return type_ == Type::Number; }
+    bool isString() const { return type_ == Type::String; }
+    bool isArray() const { return type_ == Type::Array; }
+    bool isObject() const { return type_ == Type::Object; }
+    
+    /**
+     * @brief Typed access
+     * @throws std::runtime_error if the value has another type
+     */
+    bool asBool() const;
+    double asNumber() const;
+    const std::string& asString() const;
+    
+    /**
+     * @brief Number of array elements or object members (0 otherwise)
+     */
+    size_t size() const { return values_.size(); }
+    
+    /**
+     * @brief Array element i
+     * @throws std::runtime_error if not an array or i is out of range
+     */
+    const JsonValue& operator[](size_t i) const;
+    
+    /**
+     * @brief Object member, or nullptr if missing (or not an object)
+     */
+    const JsonValue* find(const std::string& key) const;
+    
+    /**
+     * @brief Number member, or fallback if it is missing or null
+     * @throws std::runtime_error if present with another type
+     */
+    double numberOr(const std::string& key, double fallback) const;
+    
+    /**
+     * @brief Object member names, in document order (empty for non-objects)
+     */
+    const std::vector<std::string>& keys() const { return keys_; }
+    
+    /**
+     * @brief Array elements or object member values, in document order
+     */
+    const std::vector<JsonValue>& values() const { return values_; }
+
+private:
+    friend class JsonParser;
+    
+    Type type_ = Type::Null;
+    bool bool_ = false;
+    double number_ = 0.0;
+    std::string string_;
+    std::vector<std::string> keys_;    // Object member names
+    std::vector<JsonValue> values_;    // Array elements or object member values
+};
+
+/**
+ * @brief Quote and escape a string as a JSON literal
+ */
+std::string jsonQuote(const std::string& text);
+
+} // namespace trajectory
+
+#endif // JSON_VALUE_H
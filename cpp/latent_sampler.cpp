@@ -0,0 +1,120 @@
+/**
+ * @file latent_sampler.cpp
+ * @brief Implementation of the Philox latent sampler
+ */
+
+#include "latent_sampler.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace trajectory {
+
+namespace {
+
+// Philox4x32 round multipliers and Weyl key increments (Salmon et al., 2011)
+constexpr uint32_t kPhiloxM0 = 0xD2511F53u;
+constexpr uint32_t kPhiloxM1 = 0xCD9E8D57u;
+constexpr uint32_t kPhiloxW0 = 0x9E3779B9u;
+constexpr uint32_t kPhiloxW1 = 0xBB67AE85u;
+
+// Below this many values a fill is not worth waking the pool for
+constexpr size_t kParallelFillValues = 1u << 16;
+
+constexpr float kTwoPi = 6.283185307179586f;
+
+// Philox blocks converted per pass over a row; the uniforms live on the stack
+constexpr int kChunkBlocks = 64;
+
+/**
+ * @brief Map 32 random bits to a float uniform in (0, 1)
+ * 
+ * 24 bits of mantissa, offset by half a step so the result is never 0
+ * and log() in Box-Muller stays finite.
+ */
+inline float toUniform(uint32_t bits) {
+    return (static_cast<float>(bits >> 8) + 0.5f) * (1.0f / 16777216.0f);
+}
+
+} // namespace
+
+std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key) {
+    for (int round = 0; round < 10; ++round) {
+        const uint64_t product0 = static_cast<uint64_t>(kPhiloxM0) * counter[0];
+        const uint64_t product1 = static_cast<uint64_t>(kPhiloxM1) * counter[2];
+        
+        counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                   static_cast<uint32_t>(product1),
+                   static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                   static_cast<uint32_t>(product0)};
+        
+        key[0] += kPhiloxW0;
+        key[1] += kPhiloxW1;
+    }
+    return counter;
+}
+
+void LatentSampler::fill(float* out, size_t n_rows, int latent_dim, uint64_t request_id,
+                         uint64_t first_sample, bool parallel) const {
+    if (n_rows == 0 || latent_dim <= 0) return;
+    
+    const size_t values = n_rows * static_cast<size_t>(latent_dim);
+    if (!parallel || values < kParallelFillValues) {
+        fillRows(out, n_rows, latent_dim, request_id, first_sample);
+        return;
+    }
+    
+    const size_t grain = (kParallelFillValues / 4 + latent_dim - 1) / latent_dim;
+    ThreadPool::shared().parallelFor(0, n_rows, grain, [&](size_t first, size_t last) {
+        fillRows(out + first * latent_dim, last - first, latent_dim, request_id,
+                 first_sample + first);
+    });
+}
+
+void LatentSampler::fillRows(float* out, size_t n_rows, int latent_dim, uint64_t request_id,
+                             uint64_t first_sample) const {
+    // Counter = (block within row, sample, request id lo, request id hi);
+    // each block yields four uniforms, i.e. two Box-Muller pairs
+    const std::array<uint32_t, 2> key = {static_cast<uint32_t>(seed_),
+                                         static_cast<uint32_t>(seed_ >> 32)};
+    const uint32_t request_lo = static_cast<uint32_t>(request_id);
+    const uint32_t request_hi = static_cast<uint32_t>(request_id >> 32);
+    
+    const int n_blocks = (latent_dim + 3) / 4;
+    float uniforms[kChunkBlocks * 4];
+    
+    for (size_t row = 0; row < n_rows; ++row) {
+        const uint32_t sample = static_cast<uint32_t>(first_sample + row);
+        float* latent = out + row * latent_dim;
+        
+        for (int first_block = 0; first_block < n_blocks; first_block += kChunkBlocks) {
+            const int chunk_blocks = std::min(kChunkBlocks, n_blocks - first_block);
+            
+            // Integer pass: independent blocks, no loop-carried state
+            for (int b = 0; b < chunk_blocks; ++b) {
+                const auto bits = philox4x32({static_cast<uint32_t>(first_block + b), sample,
+                                              request_lo, request_hi}, key);
+                for (int i = 0; i < 4; ++i) {
+                    uniforms[b * 4 + i] = toUniform(bits[i]);
+                }
+            }
+            
+            // Box-Muller pass: uniforms (u1, u2) -> two independent N(0, 1);
+            // a chunk holds whole blocks, so pairs never straddle two chunks
+            const int first_dim = first_block * 4;
+            const int last_dim = std::min(latent_dim, first_dim + chunk_blocks * 4);
+            for (int i = first_dim; i < last_dim; i += 2) {
+                const float* u = uniforms + (i - first_dim);
+                const float radius = std::sqrt(-2.0f * std::log(u[0]));
+                const float angle = kTwoPi * u[1];
+                
+                latent[i] = radius * std::cos(angle);
+                if (i + 1 < latent_dim) {
+                    latent[i + 1] = radius * std::sin(angle);
+                }
+            }
+        }
+    }
+}
+
+} // namespace trajectory
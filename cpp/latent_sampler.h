@@ -0,0 +1,63 @@
+/**
+ * @file latent_sampler.h
+ * @brief Counter-based (Philox) Gaussian sampler for CVAE latent vectors
+ * @author Mission Planner Team
+ * 
+ * Every latent value is a pure function of (seed, request id, sample
+ * index, element), so rows can be drawn in any order, on any number of
+ * threads, and replayed later from the logged seed and request id.
+ */
+
+#ifndef LATENT_SAMPLER_H
+#define LATENT_SAMPLER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace trajectory {
+
+/**
+ * @brief Philox4x32-10 block: 128 random bits from a counter and a key
+ */
+std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key);
+
+/**
+ * @brief Stateless standard-normal sampler keyed by a 64-bit seed
+ */
+class LatentSampler {
+public:
+    /**
+     * @param seed Key for every draw
+     */
+    explicit LatentSampler(uint64_t seed = 0) : seed_(seed) {}
+    
+    uint64_t seed() const { return seed_; }
+    
+    /**
+     * @brief Fill n_rows consecutive samples of one request
+     * 
+     * Row i of out receives sample first_sample + i as latent_dim N(0, 1)
+     * values. Large fills are spread over ThreadPool::shared(); the values
+     * do not depend on how the work is split.
+     * 
+     * @param out Destination [n_rows, latent_dim]
+     * @param n_rows Number of samples
+     * @param latent_dim Values per sample
+     * @param request_id Request stream the samples belong to
+     * @param first_sample Index of the first sample within the request (< 2^32)
+     * @param parallel Allow threading for large fills
+     */
+    void fill(float* out, size_t n_rows, int latent_dim, uint64_t request_id,
+              uint64_t first_sample, bool parallel = true) const;
+
+private:
+    void fillRows(float* out, size_t n_rows, int latent_dim, uint64_t request_id,
+                  uint64_t first_sample) const;
+    
+    uint64_t seed_;
+};
+
+} // namespace trajectory
+
+#endif // LATENT_SAMPLER_H
@@ -0,0 +1,249 @@
+/**
+ * @file mission_sweep.cpp
+ * @brief Implementation of the pipelined mission sweep
+ */
+
+#include "mission_sweep.h"
+#include "trajectory_batch.h"
+#include "trajectory_filter.h"
+#include "trajectory_io.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace trajectory {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * @brief One batch of missions in flight
+ */
+struct SweepChunk {
+    std::vector<GenerationRequest> requests;   // request_id = mission index
+    TrajectoryBatch batch;
+    std::vector<MissionResult> results;
+    std::vector<RankedTrajectory> kept;        // keep_best slots per mission, best first
+    std::vector<size_t> kept_count;
+};
+
+/**
+ * @brief Rank each mission's candidates, then write and report in order
+ */
+void scoreChunk(SweepChunk& chunk, const SweepOptions& options, const TrajectoryScorer& scorer,
+                TrajectoryWriter* writer, const MissionCallback& on_result, SweepSummary& summary) {
+    const size_t n_missions = chunk.requests.size();
+    const size_t per_mission = static_cast<size_t>(options.candidates);
+    const size_t keep = options.keep_best;
+    
+    chunk.results.assign(n_missions, MissionResult());
+    chunk.kept.resize(n_missions * keep);
+    chunk.kept_count.assign(n_missions, 0);
+    
+    ThreadPool::shared().parallelFor(0, n_missions, 0, [&](size_t first, size_t last) {
+        std::vector<TrajectoryMetrics> metrics(per_mission);
+        std::vector<RankedTrajectory> ranked;
+        ranked.reserve(per_mission);
+        
+        for (size_t m = first; m < last; ++m) {
+            const size_t row0 = m * per_mission;
+            evaluateTrajectories(chunk.batch, row0, per_mission, chunk.requests[m].end,
+                                 metrics.data(), options.fast_acos);
+            
+            ranked.clear();
+            for (size_t i = 0; i < per_mission; ++i) {
+                if (options.constraints &&
+                    checkConstraints(chunk.batch.view(row0 + i), *options.constraints) != ConstraintFailure::None) {
+                    continue;
+                }
+                RankedTrajectory candidate;
+                candidate.index = i;
+                candidate.metrics = metrics[i];
+                candidate.score = scorer(metrics[i]);
+                ranked.push_back(candidate);
+            }
+            
+            // Best first, ties to the lower sample index
+            const size_t n_kept = std::min(keep, ranked.size());
+            std::partial_sort(ranked.begin(), ranked.begin() + n_kept, ranked.end(), rankedBefore);
+            std::copy(ranked.begin(), ranked.begin() + n_kept, chunk.kept.begin() + m * keep);
+            chunk.kept_count[m] = n_kept;
+            
+            MissionResult& result = chunk.results[m];
+            result.mission = static_cast<size_t>(chunk.requests[m].request_id);
+            result.valid = ranked.size();
+            if (n_kept > 0) {
+                result.best_score = ranked.front().score;
+                result.best = ranked.front().metrics;
+            }
+        }
+    });
+    
+    // Serial and in mission order: the writer, the callback and the sums
+    for (size_t m = 0; m < n_missions; ++m) {
+        const MissionResult& result = chunk.results[m];
+        const GenerationRequest& request = chunk.requests[m];
+        
+        if (writer) {
+            for (size_t k = 0; k < chunk.kept_count[m]; ++k) {
+                const RankedTrajectory& kept = chunk.kept[m * keep + k];
+                TrajectoryRecordInfo info;
+                info.start = request.start;
+                info.end = request.end;
+                info.request_id = request.request_id;
+                info.sample = static_cast<uint32_t>(kept.index);
+                info.score = kept.score;
+                if (!writer->append(chunk.batch.view(m * per_mission + kept.index), info)) {
+                    throw std::runtime_error("Sweep: failed to write trajectories");
+                }
+                summary.written++;
+            }
+        }
+        
+        if (result.valid == 0) {
+            summary.missions_without_valid++;
+        } else {
+            summary.mean_best_score += result.best_score;
+            summary.mean_path_length += result.best.path_length;
+            summary.mean_efficiency += result.best.path_efficiency;
+            summary.mean_smoothness += result.best.smoothness_score;
+            summary.worst_max_curvature = std::max(summary.worst_max_curvature, result.best.max_curvature);
+        }
+        
+        if (on_result) on_result(result);
+    }
+}
+
+} // namespace
+
+bool loadMissions(const std::string& path, std::vector<Mission>& missions) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open mission file: " << path << std::endl;
+        return false;
+    }
+    
+    missions.clear();
+    std::string line;
+    size_t line_number = 0;
+    bool first_data_line = true;
+    
+    while (std::getline(file, line)) {
+        line_number++;
+        
+        const size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#') continue;
+        
+        for (char& c : line) {
+            if (c == ',' || c == ';' || c == '\t' || c == '\r') c = ' ';
+        }
+        
+        std::istringstream row(line);
+        float v[6];
+        std::string extra;
+        if (!(row >> v[0] >> v[1] >> v[2] >> v[3] >> v[4] >> v[5]) || (row >> extra)) {
+            // A header line naming the columns
+            if (first_data_line && std::isalpha(static_cast<unsigned char>(line[begin]))) {
+                first_data_line = false;
+                continue;
+            }
+            std::cerr << "Malformed mission at " << path << ":" << line_number
+                      << " (expected start x y z, end x y z)" << std::endl;
+            return false;
+        }
+        
+        first_data_line = false;
+        missions.emplace_back(Waypoint(v[0], v[1], v[2]), Waypoint(v[3], v[4], v[5]));
+    }
+    
+    return true;
+}
+
+SweepSummary runSweep(TrajectoryGenerator& generator,
+                      const std::vector<Mission>& missions,
+                      const SweepOptions& options,
+                      TrajectoryWriter* writer,
+                      const MissionCallback& on_result) {
+    if (options.candidates <= 0 || options.missions_per_batch == 0 || options.keep_best == 0) {
+        throw std::runtime_error("Sweep: candidates, missions_per_batch and keep_best must be > 0");
+    }
+    if (options.shard_count == 0 || options.shard_index >= options.shard_count) {
+        throw std::runtime_error("Sweep: shard " + std::to_string(options.shard_index) + " of " +
+                                 std::to_string(options.shard_count) + " does not exist");
+    }
+    if (writer && writer->seqLen() != generator.getSeqLen()) {
+        throw std::runtime_error("Sweep: writer was opened for a different sequence length");
+    }
+    
+    const TrajectoryScorer scorer = options.scorer ? options.scorer
+                                                   : RankingEngine::weightedScorer();
+    const auto start_time = Clock::now();
+    
+    SweepSummary summary;
+    std::vector<size_t> shard;
+    for (size_t i = options.shard_index; i < missions.size(); i += options.shard_count) {
+        shard.push_back(i);
+    }
+    summary.missions = shard.size();
+    
+    // Two chunks alternate: ONNX Runtime fills one while the scoring
+    // thread works through the other. Declared before the future so an
+    // exception unwinding past both waits for scoring before the chunks go.
+    SweepChunk chunks[2];
+    std::future<void> scoring;
+    size_t slot = 0;
+    
+    for (size_t first = 0; first < shard.size(); first += options.missions_per_batch) {
+        SweepChunk& chunk = chunks[slot];
+        const size_t last = std::min(shard.size(), first + options.missions_per_batch);
+        
+        chunk.requests.clear();
+        for (size_t i = first; i < last; ++i) {
+            const Mission& mission = missions[shard[i]];
+            chunk.requests.emplace_back(mission.start, mission.end, options.candidates,
+                                        static_cast<uint64_t>(shard[i]));
+        }
+        
+        // Rows append, so the chunk's previous batch is dropped first
+        chunk.batch.clear();
+        const auto generate_start = Clock::now();
+        generator.generateBatch(chunk.requests.data(), chunk.requests.size(), chunk.batch);
+        summary.generate_ms += millisecondsSince(generate_start);
+        if (chunk.batch.size() != chunk.requests.size() * static_cast<size_t>(options.candidates)) {
+            throw std::runtime_error("Sweep: generator returned an unexpected number of trajectories");
+        }
+        
+        if (scoring.valid()) scoring.get();
+        scoring = std::async(std::launch::async, [&, slot]() {
+            const auto scoring_start = Clock::now();
+            scoreChunk(chunks[slot], options, scorer, writer, on_result, summary);
+            summary.scoring_ms += millisecondsSince(scoring_start);
+        });
+        slot ^= 1;
+    }
+    if (scoring.valid()) scoring.get();
+    
+    const size_t scored = summary.missions - summary.missions_without_valid;
+    if (scored > 0) {
+        summary.mean_best_score /= scored;
+        summary.mean_path_length /= scored;
+        summary.mean_efficiency /= scored;
+        summary.mean_smoothness /= scored;
+    }
+    summary.generated = summary.missions * static_cast<size_t>(options.candidates);
+    summary.elapsed_ms = millisecondsSince(start_time);
+    return summary;
+}
+
+} // namespace trajectory
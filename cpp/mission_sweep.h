@@ -0,0 +1,133 @@
+/**
+ * @file mission_sweep.h
+ * @brief Pipelined Monte-Carlo sweeps over large mission lists
+ * @author Mission Planner Team
+ * 
+ * Coverage analysis generates candidates for thousands of (start, end)
+ * missions, ranks each mission's candidates and keeps the best. runSweep()
+ * packs many missions into each generateBatch() call and scores a batch
+ * on a background thread while the next one is in ONNX Runtime, so
+ * inference and scoring overlap. Kept trajectories stream to a
+ * TrajectoryWriter with their score in the record table.
+ * 
+ * Mission i is generated under request id i, so its candidates do not
+ * depend on the batch size or on how the list is sharded over processes.
+ */
+
+#ifndef MISSION_SWEEP_H
+#define MISSION_SWEEP_H
+
+#include "trajectory_inference.h"
+#include "trajectory_metrics.h"
+#include "trajectory_ranking.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace trajectory {
+
+class TrajectoryWriter;
+struct TrajectoryConstraints;
+
+/**
+ * @brief One start/end pair of a sweep
+ */
+struct Mission {
+    Waypoint start;
+    Waypoint end;
+    
+    Mission() = default;
+    Mission(const Waypoint& s, const Waypoint& e) : start(s), end(e) {}
+};
+
+/**
+ * @brief Read a mission list
+ * 
+ * One mission per line: start x y z, end x y z, separated by commas
+ * and/or whitespace. Blank lines, lines starting with '#' and a leading
+ * header line are skipped.
+ * 
+ * @param path Mission file
+ * @param missions Receives the missions in file order
+ * @return true if the file was read and every line parsed
+ */
+bool loadMissions(const std::string& path, std::vector<Mission>& missions);
+
+/**
+ * @brief Sweep settings
+ */
+struct SweepOptions {
+    int candidates = 10;              // Trajectories generated per mission
+    size_t missions_per_batch = 64;   // Missions per generateBatch() call (and per scoring step)
+    size_t keep_best = 1;             // Best candidates written per mission
+    size_t shard_index = 0;           // Run missions i with i % shard_count == shard_index
+    size_t shard_count = 1;
+    TrajectoryScorer scorer;          // Empty = RankingEngine::weightedScorer()
+    const TrajectoryConstraints* constraints = nullptr;  // Violating candidates are never kept
+    bool fast_acos = false;           // Use fastAcos() for the curvature angles
+};
+
+/**
+ * @brief Outcome of one mission
+ */
+struct MissionResult {
+    size_t mission = 0;         // Index in the mission list
+    size_t valid = 0;           // Candidates meeting the constraints (all without constraints)
+    float best_score = 0.0f;    // Score of the best valid candidate (0 if none)
+    TrajectoryMetrics best;     // Its metrics (default if none)
+};
+
+/**
+ * @brief Aggregates over the missions a sweep ran
+ * 
+ * Means are over missions with at least one valid candidate.
+ */
+struct SweepSummary {
+    size_t missions = 0;              // Missions in this shard
+    size_t missions_without_valid = 0;
+    size_t generated = 0;             // Candidate trajectories
+    size_t written = 0;               // Trajectories passed to the writer
+    double mean_best_score = 0.0;
+    double mean_path_length = 0.0;    // m
+    double mean_efficiency = 0.0;
+    double mean_smoothness = 0.0;
+    float worst_max_curvature = 0.0f; // rad/m, over the kept best candidates
+    double generate_ms = 0.0;         // Time in generateBatch()
+    double scoring_ms = 0.0;          // Time scoring (overlapped with generation)
+    double elapsed_ms = 0.0;
+    
+    double missionsPerSecond() const {
+        return elapsed_ms > 0.0 ? missions * 1000.0 / elapsed_ms : 0.0;
+    }
+};
+
+/**
+ * @brief Called once per mission, in mission order, from the scoring thread
+ */
+using MissionCallback = std::function<void(const MissionResult&)>;
+
+/**
+ * @brief Generate, rank and keep the best candidates of every mission in a shard
+ * 
+ * Scoring runs on a background thread and, within a batch, across
+ * ThreadPool::shared(); the writer and on_result are only used from that
+ * thread, one batch at a time, in mission order.
+ * 
+ * @param generator Generator (used from the calling thread only)
+ * @param missions Full mission list (the shard is selected by options)
+ * @param options Sweep settings
+ * @param writer Open writer for the kept trajectories, or nullptr
+ * @param on_result Per-mission callback, or empty
+ * @return Aggregates over the shard
+ * @throws std::runtime_error for invalid options, inference or write failures
+ */
+SweepSummary runSweep(TrajectoryGenerator& generator,
+                      const std::vector<Mission>& missions,
+                      const SweepOptions& options,
+                      TrajectoryWriter* writer = nullptr,
+                      const MissionCallback& on_result = MissionCallback());
+
+} // namespace trajectory
+
+#endif // MISSION_SWEEP_H
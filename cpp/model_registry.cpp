@@ -0,0 +1,186 @@
+/**
+ * @file model_registry.cpp
+ * @brief Implementation of the versioned model registry
+ */
+
+#include "model_registry.h"
+#include "telemetry.h"
+#include <stdexcept>
+#include <thread>
+
+namespace trajectory {
+
+namespace {
+
+/**
+ * @brief Registry metrics, shared by all registries in the process
+ */
+struct RegistryTelemetry {
+    TelemetryCounter& loads = TelemetryRegistry::global().counter(
+        "trajectory_model_loads_total", "Model versions loaded and swapped in");
+    TelemetryCounter& failures = TelemetryRegistry::global().counter(
+        "trajectory_model_load_failures_total", "Model versions that failed to load");
+};
+
+RegistryTelemetry& registryTelemetry() {
+    static RegistryTelemetry telemetry;
+    return telemetry;
+}
+
+} // namespace
+
+// ============================================================================
+// LoadedModel
+// ============================================================================
+
+LoadedModel::LoadedModel(const std::string& id, uint64_t version, const ModelSpec& spec)
+    : id_(id), version_(version), spec_(spec) {
+    pool_ = std::make_unique<GeneratorPool>(spec_.config, spec_.num_workers);
+    
+    // Serving a new version with default normalization would silently
+    // shift every trajectory, so a bad file fails the load instead
+    if (!spec_.normalization_path.empty() && !pool_->loadNormalization(spec_.normalization_path)) {
+        throw std::runtime_error("Model '" + id_ + "': failed to load normalization " +
+                                 spec_.normalization_path);
+    }
+    pool_->warmup(spec_.warmup_batch_sizes);
+    
+    if (spec_.batching) {
+        GeneratorConfig scheduler_config = spec_.config;
+        scheduler_config.seed = pool_->getSeed();
+        scheduler_ = std::make_unique<BatchScheduler>(pool_->getModelSession(), scheduler_config,
+                                                      spec_.scheduling);
+        if (!spec_.normalization_path.empty()) {
+            scheduler_->loadNormalization(spec_.normalization_path);
+        }
+        scheduler_->warmup(spec_.warmup_batch_sizes);
+    }
+    
+    loaded_at_ = std::chrono::system_clock::now();
+}
+
+std::future<std::vector<Trajectory>> LoadedModel::submit(const Waypoint& start, const Waypoint& end,
+                                                         int n_samples) const {
+    return scheduler_ ? scheduler_->submit(start, end, n_samples)
+                      : pool_->submit(start, end, n_samples);
+}
+
+// ============================================================================
+// ModelRegistry
+// ============================================================================
+
+ModelRegistry::~ModelRegistry() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    loads_done_.wait(lock, [this]() { return pending_loads_ == 0; });
+}
+
+std::shared_ptr<const LoadedModel> ModelRegistry::load(const std::string& id, const ModelSpec& spec) {
+    uint64_t version;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        version = ++last_version_[id];
+    }
+    
+    // Build without the lock: loading takes seconds and lookups must not wait
+    std::shared_ptr<const LoadedModel> model;
+    {
+        static TelemetryHistogram* const load_time = stageHistogram("model_load");
+        ScopedTimer timer(load_time);
+        try {
+            model = std::make_shared<LoadedModel>(id, version, spec);
+        } catch (...) {
+            if constexpr (kTelemetryEnabled) registryTelemetry().failures.add();
+            throw;
+        }
+    }
+    if constexpr (kTelemetryEnabled) registryTelemetry().loads.add();
+    
+    // The replaced version is released outside the lock, after its
+    // in-flight holders are done with it
+    std::shared_ptr<const LoadedModel> replaced;
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto& current = models_[id];
+    if (current && current->version() > version) {
+        // A load started later already finished; it stays current
+        replaced = std::move(model);
+        return current;
+    }
+    replaced = std::move(current);
+    current = model;
+    return model;
+}
+
+std::future<std::shared_ptr<const LoadedModel>> ModelRegistry::loadAsync(const std::string& id,
+                                                                         const ModelSpec& spec) {
+    auto promise = std::make_shared<std::promise<std::shared_ptr<const LoadedModel>>>();
+    auto future = promise->get_future();
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_loads_++;
+    }
+    
+    // Detached so dropping the future does not block; the destructor
+    // waits for pending_loads_ instead
+    std::thread([this, id, spec, promise]() {
+        try {
+            promise->set_value(load(id, spec));
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_loads_--;
+        loads_done_.notify_all();
+    }).detach();
+    
+    return future;
+}
+
+std::shared_ptr<const LoadedModel> ModelRegistry::reload(const std::string& id) {
+    const ModelSpec spec = get(id)->spec();
+    return load(id, spec);
+}
+
+std::shared_ptr<const LoadedModel> ModelRegistry::get(const std::string& id) const {
+    auto model = find(id);
+    if (!model) {
+        throw std::runtime_error("Unknown model id '" + id + "'");
+    }
+    return model;
+}
+
+std::shared_ptr<const LoadedModel> ModelRegistry::find(const std::string& id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = models_.find(id);
+    return it == models_.end() ? nullptr : it->second;
+}
+
+bool ModelRegistry::unload(const std::string& id) {
+    std::shared_ptr<const LoadedModel> removed;
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = models_.find(id);
+    if (it == models_.end()) return false;
+    removed = std::move(it->second);
+    models_.erase(it);
+    return true;
+}
+
+std::vector<std::string> ModelRegistry::ids() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> result;
+    result.reserve(models_.size());
+    for (const auto& entry : models_) {
+        result.push_back(entry.first);
+    }
+    return result;
+}
+
+size_t ModelRegistry::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return models_.size();
+}
+
+} // namespace trajectory
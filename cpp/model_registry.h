@@ -0,0 +1,184 @@
+/**
+ * @file model_registry.h
+ * @brief Named, versioned models with background load and atomic swap
+ * @author Mission Planner Team
+ * 
+ * A ModelRegistry holds several loaded models (aircraft classes, sequence
+ * lengths, precisions) under string ids and routes lookups by id. A new
+ * version is loaded, normalized and warmed up off to the side, then
+ * swapped in under the id in one step. Requests that already hold the
+ * old version finish on it; it is released with its last reference.
+ */
+
+#ifndef MODEL_REGISTRY_H
+#define MODEL_REGISTRY_H
+
+#include "trajectory_inference.h"
+#include "generator_pool.h"
+#include "batch_scheduler.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace trajectory {
+
+/**
+ * @brief How to build one model version
+ */
+struct ModelSpec {
+    GeneratorConfig config;
+    std::string normalization_path;   // "" = built-in defaults; a file that fails to load fails the version
+    size_t num_workers = 2;           // Pooled generators (0 = hardware concurrency)
+    bool batching = false;            // Coalesce submit() through a BatchScheduler
+    SchedulerConfig scheduling;       // With batching
+    std::vector<int> warmup_batch_sizes;  // Shapes run before going live (empty = generator default)
+    
+    ModelSpec() = default;
+    ModelSpec(const GeneratorConfig& generator_config, const std::string& norm_path)
+        : config(generator_config), normalization_path(norm_path) {}
+};
+
+/**
+ * @brief One immutable, ready-to-serve model version
+ * 
+ * Thread-safe: every member may be used concurrently from many threads.
+ */
+class LoadedModel {
+public:
+    /**
+     * @brief Load, normalize and warm up a model version
+     * @throws std::runtime_error if the model or normalization cannot be loaded
+     */
+    LoadedModel(const std::string& id, uint64_t version, const ModelSpec& spec);
+    
+    LoadedModel(const LoadedModel&) = delete;
+    LoadedModel& operator=(const LoadedModel&) = delete;
+    
+    const std::string& id() const { return id_; }
+    
+    /**
+     * @brief 1 for the first load of an id, then increasing with each load
+     */
+    uint64_t version() const { return version_; }
+    
+    const ModelSpec& spec() const { return spec_; }
+    
+    /**
+     * @brief When the version finished loading
+     */
+    std::chrono::system_clock::time_point loadedAt() const { return loaded_at_; }
+    
+    /**
+     * @brief Generators over this version (submitBatch, acquire, ...)
+     */
+    GeneratorPool& pool() const { return *pool_; }
+    
+    /**
+     * @brief Micro-batching front end, or nullptr without spec().batching
+     */
+    BatchScheduler* scheduler() const { return scheduler_.get(); }
+    
+    int getSeqLen() const { return pool_->getSeqLen(); }
+    
+    /**
+     * @brief Queue a request on the scheduler if batching, else on the pool
+     * 
+     * Holding only the future is enough: a swapped-out version finishes
+     * queued work before it is destroyed.
+     */
+    std::future<std::vector<Trajectory>> submit(const Waypoint& start, const Waypoint& end,
+                                                int n_samples) const;
+
+private:
+    std::string id_;
+    uint64_t version_;
+    ModelSpec spec_;
+    std::chrono::system_clock::time_point loaded_at_;
+    std::unique_ptr<GeneratorPool> pool_;
+    std::unique_ptr<BatchScheduler> scheduler_;  // Declared after pool_: shares its session
+};
+
+/**
+ * @brief Thread-safe id -> current model version map
+ */
+class ModelRegistry {
+public:
+    ModelRegistry() = default;
+    
+    /**
+     * @brief Wait for background loads, then release the models
+     */
+    ~ModelRegistry();
+    
+    ModelRegistry(const ModelRegistry&) = delete;
+    ModelRegistry& operator=(const ModelRegistry&) = delete;
+    
+    /**
+     * @brief Load a version on the calling thread and make it current
+     * 
+     * Lookups keep returning the previous version until the new one is
+     * warmed up. If loads of one id overlap, the one started last wins,
+     * whichever finishes first.
+     * 
+     * @param id Model id
+     * @param spec Model, normalization and serving setup
+     * @return The version now current under id
+     * @throws std::runtime_error if loading fails (the previous version stays current)
+     */
+    std::shared_ptr<const LoadedModel> load(const std::string& id, const ModelSpec& spec);
+    
+    /**
+     * @brief load() on a background thread
+     * @return Future for the current version, or the load error
+     */
+    std::future<std::shared_ptr<const LoadedModel>> loadAsync(const std::string& id,
+                                                              const ModelSpec& spec);
+    
+    /**
+     * @brief Load the current spec of id again (e.g. after replacing the model file)
+     * @throws std::runtime_error for an unknown id or if loading fails
+     */
+    std::shared_ptr<const LoadedModel> reload(const std::string& id);
+    
+    /**
+     * @brief Current version of id
+     * @throws std::runtime_error for an unknown id
+     */
+    std::shared_ptr<const LoadedModel> get(const std::string& id) const;
+    
+    /**
+     * @brief Current version of id, or nullptr
+     */
+    std::shared_ptr<const LoadedModel> find(const std::string& id) const;
+    
+    /**
+     * @brief Remove id (holders keep their version until they drop it)
+     * @return false if id was not loaded
+     */
+    bool unload(const std::string& id);
+    
+    /**
+     * @brief Loaded ids in sorted order
+     */
+    std::vector<std::string> ids() const;
+    
+    size_t size() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<const LoadedModel>> models_;
+    std::map<std::string, uint64_t> last_version_;  // Highest version handed out per id
+    
+    std::condition_variable loads_done_;
+    size_t pending_loads_ = 0;
+};
+
+} // namespace trajectory
+
+#endif // MODEL_REGISTRY_H
@@ -0,0 +1,445 @@
+/**
+ * @file obstacle_map.cpp
+ * @brief Uniform-grid obstacle index and segment clearance tests
+ */
+
+#include "obstacle_map.h"
+#include "trajectory_batch.h"
+#include "trajectory_metrics.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace trajectory {
+
+namespace {
+
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+/**
+ * @brief Clip the parametric segment a + t·d, t in [t0, t1], to a box
+ * @return False if the segment misses the box
+ */
+bool clipToBox(const float* a, const float* d, const float* lo, const float* hi,
+               float& t0, float& t1) {
+    for (int axis = 0; axis < 3; ++axis) {
+        if (d[axis] == 0.0f) {
+            if (a[axis] < lo[axis] || a[axis] > hi[axis]) return false;
+            continue;
+        }
+        const float inv = 1.0f / d[axis];
+        float t_near = (lo[axis] - a[axis]) * inv;
+        float t_far = (hi[axis] - a[axis]) * inv;
+        if (t_near > t_far) std::swap(t_near, t_far);
+        t0 = std::max(t0, t_near);
+        t1 = std::min(t1, t_far);
+        if (t0 > t1) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Cell edge that keeps the grid within max_cells
+ * 
+ * Starts from the median obstacle size so a typical obstacle spans a
+ * few cells; a handful of huge no-fly zones does not coarsen the grid
+ * for everything else.
+ */
+float chooseCellSize(std::vector<float> sizes, const std::array<float, 3>& extent,
+                     size_t max_cells) {
+    std::nth_element(sizes.begin(), sizes.begin() + sizes.size() / 2, sizes.end());
+    float cell = sizes[sizes.size() / 2];
+    
+    const double volume = std::max(static_cast<double>(extent[0]), 1e-3) *
+                          std::max(static_cast<double>(extent[1]), 1e-3) *
+                          std::max(static_cast<double>(extent[2]), 1e-3);
+    cell = std::max(cell, static_cast<float>(std::cbrt(volume / static_cast<double>(max_cells))));
+    return cell > 0.0f ? cell : 1.0f;
+}
+
+/**
+ * @brief Signed distance from p to an axis-aligned box (negative inside)
+ */
+float boxDistance(const float* p, const BoxObstacle& b) {
+    const float lo[3] = {b.min_corner.x, b.min_corner.y, b.min_corner.z};
+    const float hi[3] = {b.max_corner.x, b.max_corner.y, b.max_corner.z};
+    float outside = 0.0f;
+    float inside = -kInfinity;
+    for (int axis = 0; axis < 3; ++axis) {
+        // Per-axis excess over the nearer face; negative while between the faces
+        const float q = std::max(lo[axis] - p[axis], p[axis] - hi[axis]);
+        if (q > 0.0f) outside += q * q;
+        inside = std::max(inside, q);
+    }
+    return outside > 0.0f ? std::sqrt(outside) : inside;
+}
+
+} // namespace
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+ObstacleMap::ObstacleMap(std::vector<SphereObstacle> spheres,
+                         std::vector<BoxObstacle> boxes,
+                         const ObstacleMapConfig& config)
+    : spheres_(std::move(spheres)),
+      boxes_(std::move(boxes)),
+      margin_(config.safety_margin),
+      origin_{0.0f, 0.0f, 0.0f},
+      extent_max_{0.0f, 0.0f, 0.0f},
+      dims_{0, 0, 0},
+      cell_size_(0.0f) {
+    if (!(margin_ >= 0.0f)) {
+        throw std::runtime_error("ObstacleMap: safety_margin must be >= 0");
+    }
+    if (config.max_cells == 0) {
+        throw std::runtime_error("ObstacleMap: max_cells must be > 0");
+    }
+    if (size() >= std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("ObstacleMap: too many obstacles");
+    }
+    
+    // Margin-grown bounds of every obstacle, in id order
+    const size_t n = size();
+    std::vector<std::array<float, 6>> bounds(n);
+    for (size_t i = 0; i < spheres_.size(); ++i) {
+        const SphereObstacle& s = spheres_[i];
+        if (!(s.radius >= 0.0f) || !std::isfinite(s.center.x) ||
+            !std::isfinite(s.center.y) || !std::isfinite(s.center.z)) {
+            throw std::runtime_error("ObstacleMap: invalid sphere " + std::to_string(i));
+        }
+        const float r = s.radius + margin_;
+        bounds[i] = {s.center.x - r, s.center.y - r, s.center.z - r,
+                     s.center.x + r, s.center.y + r, s.center.z + r};
+    }
+    for (size_t i = 0; i < boxes_.size(); ++i) {
+        const BoxObstacle& b = boxes_[i];
+        if (!(b.min_corner.x <= b.max_corner.x) || !(b.min_corner.y <= b.max_corner.y) ||
+            !(b.min_corner.z <= b.max_corner.z) || !std::isfinite(b.min_corner.x + b.min_corner.y +
+                                                                  b.min_corner.z + b.max_corner.x +
+                                                                  b.max_corner.y + b.max_corner.z)) {
+            throw std::runtime_error("ObstacleMap: invalid box " + std::to_string(i));
+        }
+        bounds[spheres_.size() + i] = {b.min_corner.x - margin_, b.min_corner.y - margin_,
+                                       b.min_corner.z - margin_, b.max_corner.x + margin_,
+                                       b.max_corner.y + margin_, b.max_corner.z + margin_};
+    }
+    
+    if (n == 0) return;
+    
+    origin_ = {kInfinity, kInfinity, kInfinity};
+    extent_max_ = {-kInfinity, -kInfinity, -kInfinity};
+    std::vector<float> sizes(n);
+    for (size_t i = 0; i < n; ++i) {
+        float largest = 0.0f;
+        for (int axis = 0; axis < 3; ++axis) {
+            origin_[axis] = std::min(origin_[axis], bounds[i][axis]);
+            extent_max_[axis] = std::max(extent_max_[axis], bounds[i][axis + 3]);
+            largest = std::max(largest, bounds[i][axis + 3] - bounds[i][axis]);
+        }
+        sizes[i] = largest;
+    }
+    
+    const std::array<float, 3> extent = {extent_max_[0] - origin_[0],
+                                         extent_max_[1] - origin_[1],
+                                         extent_max_[2] - origin_[2]};
+    cell_size_ = config.cell_size > 0.0f ? config.cell_size
+                                         : chooseCellSize(std::move(sizes), extent, config.max_cells);
+    
+    // Coarsen until the grid fits the cell budget (also caps an explicit cell_size)
+    for (;;) {
+        double total = 1.0;
+        for (int axis = 0; axis < 3; ++axis) {
+            total *= std::max(1.0, std::ceil(static_cast<double>(extent[axis]) / cell_size_));
+        }
+        if (total <= static_cast<double>(config.max_cells)) break;
+        cell_size_ *= 1.25f;
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        dims_[axis] = std::max(1, static_cast<int>(std::ceil(extent[axis] / cell_size_)));
+    }
+    
+    // Cell range an obstacle's bounds overlap, clamped to the grid
+    auto cellRange = [&](const std::array<float, 6>& box, int* first, int* last) {
+        for (int axis = 0; axis < 3; ++axis) {
+            first[axis] = std::clamp(static_cast<int>((box[axis] - origin_[axis]) / cell_size_),
+                                     0, dims_[axis] - 1);
+            last[axis] = std::clamp(static_cast<int>((box[axis + 3] - origin_[axis]) / cell_size_),
+                                    0, dims_[axis] - 1);
+        }
+    };
+    
+    // Two passes into CSR: count per cell, then fill
+    const size_t n_cells = static_cast<size_t>(dims_[0]) * dims_[1] * dims_[2];
+    std::vector<size_t> counts(n_cells + 1, 0);
+    int first[3], last[3];
+    for (size_t i = 0; i < n; ++i) {
+        cellRange(bounds[i], first, last);
+        for (int z = first[2]; z <= last[2]; ++z) {
+            for (int y = first[1]; y <= last[1]; ++y) {
+                for (int x = first[0]; x <= last[0]; ++x) {
+                    ++counts[(static_cast<size_t>(z) * dims_[1] + y) * dims_[0] + x + 1];
+                }
+            }
+        }
+    }
+    for (size_t c = 0; c < n_cells; ++c) {
+        counts[c + 1] += counts[c];
+    }
+    if (counts[n_cells] >= std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("ObstacleMap: grid too dense, raise cell_size");
+    }
+    
+    cell_start_.assign(counts.begin(), counts.end());
+    cell_items_.resize(counts[n_cells]);
+    for (size_t i = 0; i < n; ++i) {
+        cellRange(bounds[i], first, last);
+        for (int z = first[2]; z <= last[2]; ++z) {
+            for (int y = first[1]; y <= last[1]; ++y) {
+                for (int x = first[0]; x <= last[0]; ++x) {
+                    const size_t cell = (static_cast<size_t>(z) * dims_[1] + y) * dims_[0] + x;
+                    cell_items_[counts[cell]++] = static_cast<uint32_t>(i);
+                }
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+bool ObstacleMap::testObstacle(uint32_t id, const float* a, const float* d) const {
+    if (id < spheres_.size()) {
+        // Closest point of the segment to the center
+        const SphereObstacle& s = spheres_[id];
+        const float w[3] = {s.center.x - a[0], s.center.y - a[1], s.center.z - a[2]};
+        const float dd = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+        float t = 0.0f;
+        if (dd > 0.0f) {
+            t = std::clamp((w[0] * d[0] + w[1] * d[1] + w[2] * d[2]) / dd, 0.0f, 1.0f);
+        }
+        const float ex = w[0] - t * d[0];
+        const float ey = w[1] - t * d[1];
+        const float ez = w[2] - t * d[2];
+        const float r = s.radius + margin_;
+        return ex * ex + ey * ey + ez * ez <= r * r;
+    }
+    
+    const BoxObstacle& b = boxes_[id - spheres_.size()];
+    const float lo[3] = {b.min_corner.x - margin_, b.min_corner.y - margin_, b.min_corner.z - margin_};
+    const float hi[3] = {b.max_corner.x + margin_, b.max_corner.y + margin_, b.max_corner.z + margin_};
+    float t0 = 0.0f, t1 = 1.0f;
+    return clipToBox(a, d, lo, hi, t0, t1);
+}
+
+float ObstacleMap::obstacleDistance(uint32_t id, const float* a, const float* d) const {
+    if (id < spheres_.size()) {
+        const SphereObstacle& s = spheres_[id];
+        const float w[3] = {s.center.x - a[0], s.center.y - a[1], s.center.z - a[2]};
+        const float dd = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+        float t = 0.0f;
+        if (dd > 0.0f) {
+            t = std::clamp((w[0] * d[0] + w[1] * d[1] + w[2] * d[2]) / dd, 0.0f, 1.0f);
+        }
+        const float ex = w[0] - t * d[0];
+        const float ey = w[1] - t * d[1];
+        const float ez = w[2] - t * d[2];
+        return std::sqrt(ex * ex + ey * ey + ez * ez) - s.radius;
+    }
+    
+    // The signed box distance is convex along the segment: golden-section search
+    const BoxObstacle& b = boxes_[id - spheres_.size()];
+    auto at = [&](float t) {
+        const float p[3] = {a[0] + t * d[0], a[1] + t * d[1], a[2] + t * d[2]};
+        return boxDistance(p, b);
+    };
+    constexpr float kRatio = 0.618034f;
+    float lo = 0.0f, hi = 1.0f;
+    float t1 = hi - kRatio, t2 = lo + kRatio;
+    float f1 = at(t1), f2 = at(t2);
+    for (int k = 0; k < 40; ++k) {
+        if (f1 <= f2) {
+            hi = t2;
+            t2 = t1;
+            f2 = f1;
+            t1 = hi - kRatio * (hi - lo);
+            f1 = at(t1);
+        } else {
+            lo = t1;
+            t1 = t2;
+            f1 = f2;
+            t2 = lo + kRatio * (hi - lo);
+            f2 = at(t2);
+        }
+    }
+    return std::min({f1, f2, at(0.0f), at(1.0f)});
+}
+
+ObstacleHit ObstacleMap::checkSegment(const Waypoint& a, const Waypoint& b) const {
+    ObstacleHit hit;
+    if (cell_start_.empty()) return hit;
+    
+    const float p[3] = {a.x, a.y, a.z};
+    const float d[3] = {b.x - a.x, b.y - a.y, b.z - a.z};
+    
+    // Most segments never come near an obstacle: reject against the grid bounds
+    float t0 = 0.0f, t1 = 1.0f;
+    if (!clipToBox(p, d, origin_.data(), extent_max_.data(), t0, t1)) return hit;
+    
+    // 3D DDA (Amanatides & Woo) from the entry point to the exit point
+    int cell[3], step[3];
+    float t_max[3], t_delta[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        const float entry = p[axis] + d[axis] * t0;
+        cell[axis] = std::clamp(static_cast<int>((entry - origin_[axis]) / cell_size_),
+                                0, dims_[axis] - 1);
+        if (d[axis] > 0.0f) {
+            step[axis] = 1;
+            t_max[axis] = (origin_[axis] + (cell[axis] + 1) * cell_size_ - p[axis]) / d[axis];
+            t_delta[axis] = cell_size_ / d[axis];
+        } else if (d[axis] < 0.0f) {
+            step[axis] = -1;
+            t_max[axis] = (origin_[axis] + cell[axis] * cell_size_ - p[axis]) / d[axis];
+            t_delta[axis] = -cell_size_ / d[axis];
+        } else {
+            step[axis] = 0;
+            t_max[axis] = kInfinity;
+            t_delta[axis] = kInfinity;
+        }
+    }
+    
+    for (;;) {
+        const size_t index = (static_cast<size_t>(cell[2]) * dims_[1] + cell[1]) * dims_[0] + cell[0];
+        for (uint32_t k = cell_start_[index]; k < cell_start_[index + 1]; ++k) {
+            const uint32_t id = cell_items_[k];
+            if (testObstacle(id, p, d)) {
+                hit.collision = true;
+                if (id < spheres_.size()) {
+                    hit.kind = ObstacleKind::Sphere;
+                    hit.index = id;
+                } else {
+                    hit.kind = ObstacleKind::Box;
+                    hit.index = id - spheres_.size();
+                }
+                return hit;
+            }
+        }
+        
+        const int axis = t_max[0] < t_max[1] ? (t_max[0] < t_max[2] ? 0 : 2)
+                                             : (t_max[1] < t_max[2] ? 1 : 2);
+        if (t_max[axis] > t1) break;
+        cell[axis] += step[axis];
+        if (cell[axis] < 0 || cell[axis] >= dims_[axis]) break;
+        t_max[axis] += t_delta[axis];
+    }
+    
+    return hit;
+}
+
+ObstacleHit ObstacleMap::checkTrajectory(const TrajectoryView& trajectory) const {
+    if (trajectory.empty() || cell_start_.empty()) return ObstacleHit();
+    if (trajectory.size() == 1) return checkSegment(trajectory[0], trajectory[0]);
+    
+    for (size_t i = 0; i + 1 < trajectory.size(); ++i) {
+        ObstacleHit hit = checkSegment(trajectory[i], trajectory[i + 1]);
+        if (hit.collision) {
+            hit.segment = i;
+            return hit;
+        }
+    }
+    return ObstacleHit();
+}
+
+float ObstacleMap::clearance(const TrajectoryView& trajectory, float max_distance) const {
+    float best = max_distance;
+    if (trajectory.empty() || cell_start_.empty()) return best;
+    
+    // Obstacles span several cells; stamp each with the segment that last measured it
+    const size_t n_segments = trajectory.size() > 1 ? trajectory.size() - 1 : 1;
+    std::vector<size_t> measured(size(), n_segments);
+    
+    for (size_t i = 0; i < n_segments; ++i) {
+        const Waypoint& a = trajectory[i];
+        const Waypoint& b = trajectory[std::min(i + 1, trajectory.size() - 1)];
+        const float p[3] = {a.x, a.y, a.z};
+        const float d[3] = {b.x - a.x, b.y - a.y, b.z - a.z};
+        auto measure = [&](uint32_t id) {
+            if (measured[id] == i) return;
+            measured[id] = i;
+            best = std::min(best, obstacleDistance(id, p, d));
+        };
+        
+        // Anything nearer than best overlaps the segment's bounds grown by best
+        const float reach = std::max(best, 0.0f);
+        int first[3], last[3];
+        bool outside = false;
+        for (int axis = 0; axis < 3; ++axis) {
+            const float lo = std::min(p[axis], p[axis] + d[axis]) - reach;
+            const float hi = std::max(p[axis], p[axis] + d[axis]) + reach;
+            if (hi < origin_[axis] || lo > extent_max_[axis]) {
+                outside = true;
+                break;
+            }
+            // Clamp in float first: an unbounded reach must not reach the int cast
+            const float top = static_cast<float>(dims_[axis] - 1);
+            first[axis] = static_cast<int>(std::clamp((lo - origin_[axis]) / cell_size_, 0.0f, top));
+            last[axis] = static_cast<int>(std::clamp((hi - origin_[axis]) / cell_size_, 0.0f, top));
+        }
+        if (outside) continue;
+        
+        // A range covering more cells than there are obstacles is cheaper as a plain scan
+        const double n_cells = static_cast<double>(last[0] - first[0] + 1) *
+                               (last[1] - first[1] + 1) * (last[2] - first[2] + 1);
+        if (n_cells >= static_cast<double>(size())) {
+            for (size_t id = 0; id < size(); ++id) {
+                measure(static_cast<uint32_t>(id));
+            }
+            continue;
+        }
+        for (int z = first[2]; z <= last[2]; ++z) {
+            for (int y = first[1]; y <= last[1]; ++y) {
+                for (int x = first[0]; x <= last[0]; ++x) {
+                    const size_t cell = (static_cast<size_t>(z) * dims_[1] + y) * dims_[0] + x;
+                    for (uint32_t k = cell_start_[cell]; k < cell_start_[cell + 1]; ++k) {
+                        measure(cell_items_[k]);
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+std::vector<ObstacleHit> ObstacleMap::checkTrajectories(const TrajectoryBatch& batch,
+                                                        bool parallel) const {
+    std::vector<ObstacleHit> hits(batch.size());
+    auto body = [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            hits[i] = checkTrajectory(batch.view(i));
+        }
+    };
+    
+    if (parallel && batch.size() > 1 && !empty()) {
+        ThreadPool::shared().parallelFor(0, batch.size(), 16, body);
+    } else {
+        body(0, batch.size());
+    }
+    return hits;
+}
+
+bool isTrajectoryValid(const TrajectoryView& trajectory,
+                       const ObstacleMap& obstacles,
+                       float max_curvature,
+                       float min_altitude,
+                       float max_altitude) {
+    // Cheap kinematic checks first; the clearance walk only runs on survivors
+    if (!isTrajectoryValid(trajectory, max_curvature, min_altitude, max_altitude)) return false;
+    return obstacles.isClear(trajectory);
+}
+
+} // namespace trajectory
@@ -0,0 +1,184 @@
+/**
+ * @file obstacle_map.h
+ * @brief Obstacle and no-fly-zone clearance checks over a uniform grid
+ * @author Mission Planner Team
+ * 
+ * Missions carry thousands of obstacles, so testing every waypoint
+ * against every obstacle does not fit the replanning cycle. ObstacleMap
+ * buckets sphere obstacles and axis-aligned box zones into a uniform
+ * grid once; each trajectory segment then walks only the cells it
+ * crosses (3D DDA) and runs exact segment-vs-volume tests on the
+ * obstacles registered there, stopping at the first collision.
+ */
+
+#ifndef OBSTACLE_MAP_H
+#define OBSTACLE_MAP_H
+
+#include "trajectory_inference.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace trajectory {
+
+/**
+ * @brief Spherical obstacle (the API's center + radius)
+ */
+struct SphereObstacle {
+    Waypoint center;
+    float radius = 0.0f;    // (m)
+};
+
+/**
+ * @brief Axis-aligned box obstacle or no-fly zone
+ */
+struct BoxObstacle {
+    Waypoint min_corner;
+    Waypoint max_corner;
+};
+
+/**
+ * @brief Grid construction options
+ */
+struct ObstacleMapConfig {
+    float safety_margin = 0.0f;   // Required clearance around every obstacle (m)
+    float cell_size = 0.0f;       // Grid cell edge (m), 0 = pick from obstacle sizes
+    size_t max_cells = 1u << 18;  // Upper bound on grid cells (memory cap)
+};
+
+/**
+ * @brief Obstacle kinds, for reporting which one was hit
+ */
+enum class ObstacleKind {
+    Sphere,
+    Box
+};
+
+/**
+ * @brief Result of a clearance check
+ */
+struct ObstacleHit {
+    bool collision = false;              // True if the path enters an obstacle
+    size_t segment = 0;                  // First colliding segment (waypoint i to i+1)
+    ObstacleKind kind = ObstacleKind::Sphere;
+    size_t index = 0;                    // Index into spheres() or boxes()
+};
+
+/**
+ * @brief Immutable spatial index over sphere and box obstacles
+ * 
+ * Queries are const and safe to run concurrently. Volumes are grown by
+ * safety_margin before testing; boxes are grown per axis, which is
+ * slightly conservative at their edges and corners.
+ */
+class ObstacleMap {
+public:
+    /**
+     * @brief Build the grid
+     * @param spheres Sphere obstacles (radius must be >= 0)
+     * @param boxes Box obstacles (min_corner <= max_corner on every axis)
+     * @param config Margin and grid resolution
+     * @throws std::runtime_error on malformed obstacles or configuration
+     */
+    ObstacleMap(std::vector<SphereObstacle> spheres,
+                std::vector<BoxObstacle> boxes = {},
+                const ObstacleMapConfig& config = ObstacleMapConfig());
+    
+    /**
+     * @brief An obstacle the segment a→b enters, if any
+     * 
+     * Cells are walked from a towards b, so the reported obstacle is one
+     * near the first contact, not necessarily the very first.
+     */
+    ObstacleHit checkSegment(const Waypoint& a, const Waypoint& b) const;
+    
+    /**
+     * @brief Check every segment of a trajectory, stopping at the first collision
+     * 
+     * A single-waypoint trajectory is checked as a point.
+     */
+    ObstacleHit checkTrajectory(const TrajectoryView& trajectory) const;
+    
+    /**
+     * @brief Check every trajectory of a batch
+     * @param batch Candidates to check
+     * @param parallel Spread rows over ThreadPool::shared()
+     * @return One result per row
+     */
+    std::vector<ObstacleHit> checkTrajectories(const TrajectoryBatch& batch,
+                                               bool parallel = true) const;
+    
+    /**
+     * @brief True if the trajectory keeps clear of every obstacle
+     */
+    bool isClear(const TrajectoryView& trajectory) const {
+        return !checkTrajectory(trajectory).collision;
+    }
+    
+    /**
+     * @brief Signed distance from the path to the nearest obstacle surface
+     * 
+     * Segments are measured, not just waypoints, so a segment that cuts
+     * through an obstacle between two clear waypoints counts. The result
+     * is negative inside an obstacle (minus the deepest penetration) and
+     * ignores safety_margin. Only cells within the best distance found
+     * so far are searched, so a finite max_distance keeps long paths
+     * through sparse maps cheap.
+     * 
+     * @param trajectory Path to measure (a single waypoint is a point)
+     * @param max_distance Search radius (m); clearer paths return max_distance
+     * @return Minimum signed clearance (m), at most max_distance
+     */
+    float clearance(const TrajectoryView& trajectory,
+                    float max_distance = std::numeric_limits<float>::infinity()) const;
+    
+    const std::vector<SphereObstacle>& spheres() const { return spheres_; }
+    const std::vector<BoxObstacle>& boxes() const { return boxes_; }
+    size_t size() const { return spheres_.size() + boxes_.size(); }
+    bool empty() const { return size() == 0; }
+    
+    /**
+     * @brief Chosen cell edge (m) and grid dimensions
+     */
+    float cellSize() const { return cell_size_; }
+    std::array<int, 3> gridDims() const { return dims_; }
+
+private:
+    bool testObstacle(uint32_t id, const float* a, const float* d) const;
+    float obstacleDistance(uint32_t id, const float* a, const float* d) const;
+    
+    std::vector<SphereObstacle> spheres_;
+    std::vector<BoxObstacle> boxes_;
+    float margin_;
+    
+    // Grid over the margin-grown obstacle bounds; obstacle ids are sphere
+    // indices followed by box indices (offset by spheres_.size())
+    std::array<float, 3> origin_;
+    std::array<float, 3> extent_max_;
+    std::array<int, 3> dims_;
+    float cell_size_;
+    std::vector<uint32_t> cell_start_;  // CSR offsets, one per cell plus one
+    std::vector<uint32_t> cell_items_;  // Obstacle ids per cell
+};
+
+/**
+ * @brief Curvature, altitude and obstacle clearance check in one call
+ * 
+ * @param trajectory Input trajectory
+ * @param obstacles Obstacles to keep clear of
+ * @param max_curvature Maximum allowed curvature (rad/m)
+ * @param min_altitude Minimum allowed altitude (m)
+ * @param max_altitude Maximum allowed altitude (m)
+ * @return True if trajectory is valid
+ */
+bool isTrajectoryValid(const TrajectoryView& trajectory,
+                       const ObstacleMap& obstacles,
+                       float max_curvature = 0.1f,
+                       float min_altitude = 50.0f,
+                       float max_altitude = 1000.0f);
+                       
+} // namespace trajectory
+
+#endif // OBSTACLE_MAP_H
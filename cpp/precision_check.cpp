@@ -0,0 +1,139 @@
+/**
+ * @file precision_check.cpp
+ * @brief Implementation of the reduced-precision accuracy check
+ */
+
+#include "precision_check.h"
+#include "trajectory_batch.h"
+#include "trajectory_metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+namespace trajectory {
+
+namespace {
+
+/**
+ * @brief Generate a batch and return the wall time in milliseconds
+ */
+double timedGenerate(TrajectoryGenerator& generator, const std::vector<GenerationRequest>& requests,
+                     TrajectoryBatch& batch) {
+    const auto start = std::chrono::steady_clock::now();
+    generator.generateBatch(requests.data(), requests.size(), batch);
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // namespace
+
+PrecisionReport comparePrecision(TrajectoryGenerator& baseline,
+                                 TrajectoryGenerator& candidate,
+                                 const std::vector<GenerationRequest>& requests) {
+    if (baseline.getSeed() != candidate.getSeed()) {
+        throw std::runtime_error("comparePrecision: generators must share a latent seed");
+    }
+    
+    PrecisionReport report;
+    report.precision = candidate.getModelSession()->precision();
+    
+    // Pin request ids so both runs draw the same latents
+    std::vector<GenerationRequest> pinned = requests;
+    for (size_t r = 0; r < pinned.size(); ++r) {
+        if (pinned[r].request_id == kAutoRequestId) {
+            pinned[r].request_id = r;
+        }
+    }
+    
+    TrajectoryBatch baseline_batch;
+    TrajectoryBatch candidate_batch;
+    report.baseline_ms = timedGenerate(baseline, pinned, baseline_batch);
+    report.candidate_ms = timedGenerate(candidate, pinned, candidate_batch);
+    
+    if (baseline_batch.seqLen() != candidate_batch.seqLen()) {
+        throw std::runtime_error("comparePrecision: models produce different sequence lengths");
+    }
+    
+    const size_t n = baseline_batch.size();
+    report.trajectories = n;
+    if (n == 0) return report;
+    
+    std::vector<Waypoint> ends;
+    ends.reserve(n);
+    for (const GenerationRequest& request : pinned) {
+        ends.insert(ends.end(), static_cast<size_t>(std::max(0, request.n_samples)), request.end);
+    }
+    
+    const std::vector<TrajectoryMetrics> baseline_metrics = evaluateTrajectories(baseline_batch, ends);
+    const std::vector<TrajectoryMetrics> candidate_metrics = evaluateTrajectories(candidate_batch, ends);
+    
+    double endpoint_base = 0.0, endpoint_cand = 0.0, endpoint_drift = 0.0;
+    double smooth_base = 0.0, smooth_cand = 0.0, smooth_drift = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        const TrajectoryMetrics& b = baseline_metrics[i];
+        const TrajectoryMetrics& c = candidate_metrics[i];
+        
+        endpoint_base += b.endpoint_error;
+        endpoint_cand += c.endpoint_error;
+        endpoint_drift += std::abs(c.endpoint_error - b.endpoint_error);
+        
+        smooth_base += b.smoothness_score;
+        smooth_cand += c.smoothness_score;
+        smooth_drift += std::abs(c.smoothness_score - b.smoothness_score);
+    }
+    
+    double deviation_sum = 0.0;
+    float deviation_max = 0.0f;
+    const size_t seq_len = static_cast<size_t>(baseline_batch.seqLen());
+    for (size_t i = 0; i < n; ++i) {
+        const float* b = baseline_batch.row(i);
+        const float* c = candidate_batch.row(i);
+        for (size_t k = 0; k < seq_len; ++k) {
+            const float dx = c[3 * k] - b[3 * k];
+            const float dy = c[3 * k + 1] - b[3 * k + 1];
+            const float dz = c[3 * k + 2] - b[3 * k + 2];
+            const float d = std::sqrt(dx * dx + dy * dy + dz * dz);
+            deviation_sum += d;
+            deviation_max = std::max(deviation_max, d);
+        }
+    }
+    
+    const double inv_n = 1.0 / static_cast<double>(n);
+    report.baseline_endpoint_error = static_cast<float>(endpoint_base * inv_n);
+    report.candidate_endpoint_error = static_cast<float>(endpoint_cand * inv_n);
+    report.endpoint_error_drift = static_cast<float>(endpoint_drift * inv_n);
+    report.baseline_smoothness = static_cast<float>(smooth_base * inv_n);
+    report.candidate_smoothness = static_cast<float>(smooth_cand * inv_n);
+    report.smoothness_drift = static_cast<float>(smooth_drift * inv_n);
+    report.mean_waypoint_deviation = seq_len
+        ? static_cast<float>(deviation_sum / static_cast<double>(n * seq_len)) : 0.0f;
+    report.max_waypoint_deviation = deviation_max;
+    
+    return report;
+}
+
+bool withinTolerance(const PrecisionReport& report, const PrecisionTolerance& tolerance) {
+    return report.endpoint_error_drift <= tolerance.max_endpoint_error_drift &&
+           report.smoothness_drift <= tolerance.max_smoothness_drift;
+}
+
+std::vector<GenerationRequest> makeCalibrationRequests(size_t n_requests,
+                                                       int samples_per_request,
+                                                       uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<float> horizontal(-1000.0f, 1000.0f);
+    std::uniform_real_distribution<float> altitude(50.0f, 500.0f);
+    
+    std::vector<GenerationRequest> requests;
+    requests.reserve(n_requests);
+    for (size_t r = 0; r < n_requests; ++r) {
+        const Waypoint start(horizontal(rng), horizontal(rng), altitude(rng));
+        const Waypoint end(horizontal(rng), horizontal(rng), altitude(rng));
+        requests.emplace_back(start, end, samples_per_request);
+    }
+    return requests;
+}
+
+} // namespace trajectory
@@ -0,0 +1,91 @@
+/**
+ * @file precision_check.h
+ * @brief Accuracy check of reduced-precision model variants against FP32
+ * @author Mission Planner Team
+ * 
+ * FP16 and INT8 variants trade accuracy for speed. comparePrecision()
+ * runs the same requests with the same latents through an FP32 baseline
+ * and a candidate generator and reports how far the candidate drifts in
+ * endpoint error and smoothness, the metrics the planner ranks by.
+ */
+
+#ifndef PRECISION_CHECK_H
+#define PRECISION_CHECK_H
+
+#include "trajectory_inference.h"
+#include <cstdint>
+#include <vector>
+
+namespace trajectory {
+
+/**
+ * @brief Drift of a candidate model relative to the FP32 baseline
+ */
+struct PrecisionReport {
+    ModelPrecision precision = ModelPrecision::FP32;  // Candidate precision
+    size_t trajectories = 0;                           // Trajectories compared
+    
+    float baseline_endpoint_error = 0.0f;   // Mean endpoint error, FP32 (m)
+    float candidate_endpoint_error = 0.0f;  // Mean endpoint error, candidate (m)
+    float endpoint_error_drift = 0.0f;      // Mean |Δ endpoint error| per trajectory (m)
+    
+    float baseline_smoothness = 0.0f;       // Mean smoothness score, FP32
+    float candidate_smoothness = 0.0f;      // Mean smoothness score, candidate
+    float smoothness_drift = 0.0f;          // Mean |Δ smoothness score| per trajectory
+    
+    float mean_waypoint_deviation = 0.0f;   // Mean distance between paired waypoints (m)
+    float max_waypoint_deviation = 0.0f;    // Largest paired waypoint distance (m)
+    
+    double baseline_ms = 0.0;               // Generation time, FP32
+    double candidate_ms = 0.0;              // Generation time, candidate
+};
+
+/**
+ * @brief Acceptance thresholds for a PrecisionReport
+ */
+struct PrecisionTolerance {
+    float max_endpoint_error_drift = 5.0f;  // Meters
+    float max_smoothness_drift = 0.02f;     // Smoothness score units
+};
+
+/**
+ * @brief Compare a candidate generator against an FP32 baseline
+ * 
+ * Both generators must share a latent seed. Requests with automatic ids
+ * are numbered by position so both runs draw identical latents; neither
+ * generator's request counter is advanced. The normalization of each
+ * generator is used as loaded.
+ * 
+ * @param baseline FP32 generator
+ * @param candidate Reduced-precision generator
+ * @param requests Calibration requests
+ * @return Drift report
+ * @throws std::runtime_error if the seeds or sequence lengths differ
+ */
+PrecisionReport comparePrecision(TrajectoryGenerator& baseline,
+                                 TrajectoryGenerator& candidate,
+                                 const std::vector<GenerationRequest>& requests);
+
+/**
+ * @brief Check a report against tolerances
+ */
+bool withinTolerance(const PrecisionReport& report,
+                     const PrecisionTolerance& tolerance = PrecisionTolerance());
+
+/**
+ * @brief Deterministic calibration requests spread over the mission volume
+ * 
+ * Start and end positions are uniform in x, y ∈ [-1000, 1000] m and
+ * z ∈ [50, 500] m.
+ * 
+ * @param n_requests Number of requests
+ * @param samples_per_request Trajectories per request
+ * @param seed Position sampling seed
+ */
+std::vector<GenerationRequest> makeCalibrationRequests(size_t n_requests,
+                                                       int samples_per_request,
+                                                       uint64_t seed = 1);
+                                                       
+} // namespace trajectory
+
+#endif // PRECISION_CHECK_H
@@ -0,0 +1,80 @@
+/**
+ * @file request_arena.cpp
+ * @brief Implementation of the resettable request arena
+ */
+
+#include "request_arena.h"
+#include <algorithm>
+
+namespace trajectory {
+
+namespace {
+
+constexpr size_t kBlockAlignment = alignof(std::max_align_t);
+
+} // namespace
+
+RequestArena::RequestArena(size_t initial_bytes, std::pmr::memory_resource* upstream)
+    : upstream_(upstream ? upstream : std::pmr::new_delete_resource()),
+      block_(nullptr),
+      block_size_(0),
+      used_(0),
+      high_water_(0) {
+    allocateBlock(std::max<size_t>(initial_bytes, 1024));
+}
+
+RequestArena::~RequestArena() {
+    monotonic_.reset();
+    releaseBlock();
+}
+
+void RequestArena::allocateBlock(size_t bytes) {
+    block_ = upstream_->allocate(bytes, kBlockAlignment);
+    block_size_ = bytes;
+    monotonic_.emplace(block_, block_size_, upstream_);
+}
+
+void RequestArena::releaseBlock() {
+    if (block_) {
+        upstream_->deallocate(block_, block_size_, kBlockAlignment);
+        block_ = nullptr;
+        block_size_ = 0;
+    }
+}
+
+void RequestArena::reset() {
+    high_water_ = std::max(high_water_, used_);
+    
+    // Overflowed into the heap: move to a block that fits the whole
+    // request (plus alignment slack) so the next one stays in the arena.
+    // Otherwise rebuilding the resource frees the overflow chunks and
+    // starts the next request at the head of the same block.
+    monotonic_.reset();
+    if (high_water_ > block_size_) {
+        releaseBlock();
+        allocateBlock(high_water_ + high_water_ / 4);
+    } else {
+        monotonic_.emplace(block_, block_size_, upstream_);
+    }
+    used_ = 0;
+}
+
+void* RequestArena::do_allocate(size_t bytes, size_t alignment) {
+    used_ += bytes;
+    return monotonic_->allocate(bytes, alignment);
+}
+
+void RequestArena::do_deallocate(void*, size_t, size_t) {
+    // Monotonic: memory comes back at reset()
+}
+
+bool RequestArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+RequestArena& RequestArena::threadLocal() {
+    thread_local RequestArena arena;
+    return arena;
+}
+
+} // namespace trajectory
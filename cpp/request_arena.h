@@ -0,0 +1,101 @@
+/**
+ * @file request_arena.h
+ * @brief Resettable per-request monotonic arena (std::pmr)
+ * @author Mission Planner Team
+ * 
+ * Under load, many threads allocating and freeing each request's
+ * buffers contend in malloc. A RequestArena carves a request's whole
+ * working set (batch storage, ranking scratch, result vectors) from one
+ * block with pointer bumps, and reset() releases it all at once. If a
+ * request outgrows the block, the overflow comes from the heap and the
+ * block is enlarged to the high-water mark at the next reset, so in
+ * steady state these buffers need no heap allocation. (ONNX Runtime's
+ * own tensors and the generator's scratch are not covered.)
+ * 
+ * Pass resource() to the pmr-aware APIs: the TrajectoryBatch
+ * constructor, RankingEngine::rank() (which then scores on the calling
+ * thread) and computeCurvatures().
+ */
+
+#ifndef REQUEST_ARENA_H
+#define REQUEST_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace trajectory {
+
+/**
+ * @brief Monotonic arena that keeps and resizes its block across requests
+ * 
+ * Not thread-safe: use one arena per thread (see threadLocal()). Memory
+ * handed out stays valid until reset() or destruction; deallocation is
+ * a no-op.
+ */
+class RequestArena : public std::pmr::memory_resource {
+public:
+    /**
+     * @param initial_bytes Size of the first block
+     * @param upstream Source of the block and of overflow allocations
+     */
+    explicit RequestArena(size_t initial_bytes = 256u << 10,
+                          std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    ~RequestArena() override;
+    
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+    
+    /**
+     * @brief The arena as a resource for pmr containers
+     */
+    std::pmr::memory_resource* resource() { return this; }
+    
+    /**
+     * @brief Release everything allocated since the last reset
+     * 
+     * Containers still using the arena must be gone (or never touched
+     * again). Grows the block if the last request overflowed it.
+     */
+    void reset();
+    
+    /**
+     * @brief Bytes requested since the last reset
+     */
+    size_t bytesUsed() const { return used_; }
+    
+    /**
+     * @brief Largest bytesUsed() seen at any reset
+     */
+    size_t highWaterMark() const { return high_water_; }
+    
+    /**
+     * @brief Size of the current block
+     */
+    size_t blockSize() const { return block_size_; }
+    
+    /**
+     * @brief This thread's arena (created on first use)
+     */
+    static RequestArena& threadLocal();
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    
+    void allocateBlock(size_t bytes);
+    void releaseBlock();
+    
+    std::pmr::memory_resource* upstream_;
+    void* block_;
+    size_t block_size_;
+    size_t used_;
+    size_t high_water_;
+    std::optional<std::pmr::monotonic_buffer_resource> monotonic_;
+};
+
+} // namespace trajectory
+
+#endif // REQUEST_ARENA_H
@@ -0,0 +1,228 @@
+/**
+ * @file telemetry.cpp
+ * @brief Implementation of the telemetry registry and Prometheus export
+ */
+
+#include "telemetry.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace trajectory {
+
+namespace {
+
+uint64_t toBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Format a sample value the way Prometheus parses it
+ */
+std::string formatValue(double value) {
+    if (std::isinf(value)) return value > 0 ? "+Inf" : "-Inf";
+    if (std::isnan(value)) return "NaN";
+    
+    // Shortest form that reads back exactly, so bucket bounds stay readable
+    char text[32];
+    for (int precision = 6; precision <= 17; ++precision) {
+        std::snprintf(text, sizeof(text), "%.*g", precision, value);
+        if (std::strtod(text, nullptr) == value) break;
+    }
+    return text;
+}
+
+/**
+ * @brief name{labels[,extra]}, or just name without any labels
+ */
+std::string seriesName(const std::string& name, const std::string& labels,
+                       const std::string& extra = std::string()) {
+    if (labels.empty() && extra.empty()) return name;
+    
+    std::string out = name + "{" + labels;
+    if (!labels.empty() && !extra.empty()) out += ",";
+    return out + extra + "}";
+}
+
+} // namespace
+
+// ============================================================================
+// TelemetryHistogram
+// ============================================================================
+
+TelemetryHistogram::TelemetryHistogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds))
+    , counts_(new std::atomic<uint64_t>[bounds_.size() + 1])
+{
+    std::sort(bounds_.begin(), bounds_.end());
+    for (size_t i = 0; i <= bounds_.size(); ++i) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void TelemetryHistogram::observe(double value) {
+    size_t bucket = 0;
+    while (bucket < bounds_.size() && value > bounds_[bucket]) {
+        ++bucket;
+    }
+    counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+    
+    uint64_t expected = sum_bits_.load(std::memory_order_relaxed);
+    while (!sum_bits_.compare_exchange_weak(expected, toBits(fromBits(expected) + value),
+                                            std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t TelemetryHistogram::count() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i <= bounds_.size(); ++i) {
+        total += bucketCount(i);
+    }
+    return total;
+}
+
+double TelemetryHistogram::sum() const {
+    return fromBits(sum_bits_.load(std::memory_order_relaxed));
+}
+
+void TelemetryHistogram::reset() {
+    for (size_t i = 0; i <= bounds_.size(); ++i) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+    sum_bits_.store(toBits(0.0), std::memory_order_relaxed);
+}
+
+std::vector<double> latencyBuckets() {
+    return {0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+            0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 10.0};
+}
+
+std::vector<double> ratioBuckets() {
+    return {0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0};
+}
+
+TelemetryHistogram* stageHistogram(const std::string& stage) {
+    if (!kTelemetryEnabled) return nullptr;
+    return &TelemetryRegistry::global().histogram(
+        "trajectory_stage_seconds", "Wall time per pipeline stage in seconds",
+        "stage=\"" + stage + "\"");
+}
+
+// ============================================================================
+// TelemetryRegistry
+// ============================================================================
+
+TelemetryRegistry& TelemetryRegistry::global() {
+    static TelemetryRegistry registry;
+    return registry;
+}
+
+TelemetryRegistry::Series& TelemetryRegistry::series(const std::string& name,
+                                                     const std::string& help,
+                                                     const std::string& labels, Type type,
+                                                     const std::vector<double>* bounds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = families_.find(name);
+    if (it == families_.end()) {
+        Family family;
+        family.type = type;
+        family.help = help;
+        if (bounds) family.bounds = *bounds;
+        it = families_.emplace(name, std::move(family)).first;
+    } else if (it->second.type != type) {
+        throw std::runtime_error("Telemetry metric " + name + " registered with another type");
+    }
+    
+    Family& family = it->second;
+    for (const auto& s : family.series) {
+        if (s->labels == labels) return *s;
+    }
+    
+    auto s = std::make_unique<Series>();
+    s->labels = labels;
+    switch (type) {
+        case Type::Counter: s->counter = std::make_unique<TelemetryCounter>(); break;
+        case Type::Gauge: s->gauge = std::make_unique<TelemetryGauge>(); break;
+        case Type::Histogram: s->histogram = std::make_unique<TelemetryHistogram>(family.bounds); break;
+    }
+    family.series.push_back(std::move(s));
+    return *family.series.back();
+}
+
+TelemetryCounter& TelemetryRegistry::counter(const std::string& name, const std::string& help,
+                                             const std::string& labels) {
+    return *series(name, help, labels, Type::Counter, nullptr).counter;
+}
+
+TelemetryGauge& TelemetryRegistry::gauge(const std::string& name, const std::string& help,
+                                         const std::string& labels) {
+    return *series(name, help, labels, Type::Gauge, nullptr).gauge;
+}
+
+TelemetryHistogram& TelemetryRegistry::histogram(const std::string& name, const std::string& help,
+                                                 const std::string& labels,
+                                                 const std::vector<double>& bounds) {
+    return *series(name, help, labels, Type::Histogram, &bounds).histogram;
+}
+
+std::string TelemetryRegistry::scrape() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream out;
+    
+    for (const auto& entry : families_) {
+        const std::string& name = entry.first;
+        const Family& family = entry.second;
+        
+        static const char* const type_names[] = {"counter", "gauge", "histogram"};
+        out << "# HELP " << name << " " << family.help << "\n";
+        out << "# TYPE " << name << " " << type_names[static_cast<int>(family.type)] << "\n";
+        
+        for (const auto& s : family.series) {
+            if (s->counter) {
+                out << seriesName(name, s->labels) << " " << s->counter->value() << "\n";
+            } else if (s->gauge) {
+                out << seriesName(name, s->labels) << " " << s->gauge->value() << "\n";
+            } else {
+                // Buckets are exported cumulatively, as Prometheus expects
+                const TelemetryHistogram& h = *s->histogram;
+                uint64_t cumulative = 0;
+                for (size_t i = 0; i <= h.bounds().size(); ++i) {
+                    cumulative += h.bucketCount(i);
+                    const std::string le = i < h.bounds().size() ? formatValue(h.bounds()[i]) : "+Inf";
+                    out << seriesName(name + "_bucket", s->labels, "le=\"" + le + "\"") << " "
+                        << cumulative << "\n";
+                }
+                out << seriesName(name + "_sum", s->labels) << " " << formatValue(h.sum()) << "\n";
+                out << seriesName(name + "_count", s->labels) << " " << cumulative << "\n";
+            }
+        }
+    }
+    
+    return out.str();
+}
+
+void TelemetryRegistry::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : families_) {
+        for (auto& s : entry.second.series) {
+            if (s->counter) s->counter->reset();
+            if (s->gauge) s->gauge->reset();
+            if (s->histogram) s->histogram->reset();
+        }
+    }
+}
+
+} // namespace trajectory
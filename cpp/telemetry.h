@@ -0,0 +1,231 @@
+/**
+ * @file telemetry.h
+ * @brief Low-overhead counters, gauges and histograms with a Prometheus pull API
+ * @author Mission Planner Team
+ * 
+ * Hot paths update lock-free atomics; a scraper calls
+ * TelemetryRegistry::global().scrape() and serves the text (Prometheus
+ * exposition format 0.0.4) from its own /metrics endpoint.
+ * 
+ * The library records, when kTelemetryEnabled:
+ * 
+ *   trajectory_stage_seconds{stage=...}   sampling, tensor_setup, session_run,
+ *                                          postprocess, filtering, scoring, ranking,
+ *                                          model_load
+ *   trajectory_batch_fill_ratio           rows per Run / max_batch_size
+ *   trajectory_session_runs_total, trajectory_generated_total
+ *   trajectory_scheduler_*                queue depth, wait time, batch fill
+ *   trajectory_cache_*                    result cache hits, misses, evictions, bytes
+ *   trajectory_model_load*_total          registry loads and failed loads
+ * 
+ * Configure with -DENABLE_TELEMETRY=OFF to compile the library's
+ * instrumentation out; the registry itself stays available (and empty).
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef TRAJECTORY_ENABLE_TELEMETRY
+#define TRAJECTORY_ENABLE_TELEMETRY 1
+#endif
+
+namespace trajectory {
+
+/**
+ * @brief True if the library's hot paths record telemetry
+ * 
+ * Instrumentation sits behind `if constexpr (kTelemetryEnabled)`, so a
+ * disabled build pays nothing, not even the clock reads.
+ */
+constexpr bool kTelemetryEnabled = TRAJECTORY_ENABLE_TELEMETRY != 0;
+
+/**
+ * @brief Monotonically increasing count
+ */
+class TelemetryCounter {
+public:
+    void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+    void reset() { value_.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * @brief Value that goes up and down (queue depth, pool size)
+ */
+class TelemetryGauge {
+public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+    void reset() { set(0); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+/**
+ * @brief Fixed-bucket histogram
+ * 
+ * Bucket bounds are upper bounds (Prometheus "le"), ascending; values
+ * above the last bound land in the implicit +Inf bucket. observe() is a
+ * short linear search and two relaxed atomic updates.
+ */
+class TelemetryHistogram {
+public:
+    explicit TelemetryHistogram(std::vector<double> bounds);
+    
+    void observe(double value);
+    
+    /**
+     * @brief Record a duration in seconds
+     */
+    template <typename Rep, typename Period>
+    void observe(std::chrono::duration<Rep, Period> elapsed) {
+        observe(std::chrono::duration<double>(elapsed).count());
+    }
+    
+    const std::vector<double>& bounds() const { return bounds_; }
+    
+    /**
+     * @brief Observations in bucket i (not cumulative; i == bounds().size() is +Inf)
+     */
+    uint64_t bucketCount(size_t i) const { return counts_[i].load(std::memory_order_relaxed); }
+    
+    uint64_t count() const;
+    double sum() const;
+    void reset();
+
+private:
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;   // bounds_.size() + 1
+    std::atomic<uint64_t> sum_bits_{0};                 // double, updated by CAS
+};
+
+/**
+ * @brief Bucket bounds for latencies, 50 us to 10 s
+ */
+std::vector<double> latencyBuckets();
+
+/**
+ * @brief Bucket bounds for ratios in [0, 1], in steps of 0.1
+ */
+std::vector<double> ratioBuckets();
+
+/**
+ * @brief Named metric families with a text scrape
+ * 
+ * Registration takes a mutex and returns a reference that stays valid
+ * for the registry's lifetime; look metrics up once and keep the
+ * reference on hot paths. Registering the same name and labels again
+ * returns the existing metric.
+ */
+class TelemetryRegistry {
+public:
+    /**
+     * @brief Process-wide registry the library records into
+     */
+    static TelemetryRegistry& global();
+    
+    TelemetryRegistry() = default;
+    TelemetryRegistry(const TelemetryRegistry&) = delete;
+    TelemetryRegistry& operator=(const TelemetryRegistry&) = delete;
+    
+    /**
+     * @brief Counter name{labels}
+     * @param name Metric name (e.g. "trajectory_generated_total")
+     * @param help One-line description for the HELP line
+     * @param labels Prometheus label set without braces (e.g. "stage=\"ranking\""), may be empty
+     * @throws std::runtime_error if name is registered with another type
+     */
+    TelemetryCounter& counter(const std::string& name, const std::string& help,
+                              const std::string& labels = std::string());
+    
+    TelemetryGauge& gauge(const std::string& name, const std::string& help,
+                          const std::string& labels = std::string());
+    
+    /**
+     * @brief Histogram name{labels}
+     * @param bounds Bucket upper bounds (first registration of the family wins)
+     */
+    TelemetryHistogram& histogram(const std::string& name, const std::string& help,
+                                  const std::string& labels = std::string(),
+                                  const std::vector<double>& bounds = latencyBuckets());
+    
+    /**
+     * @brief All metrics in Prometheus text exposition format
+     */
+    std::string scrape() const;
+    
+    /**
+     * @brief Zero every metric (registrations are kept)
+     */
+    void reset();
+
+private:
+    enum class Type { Counter, Gauge, Histogram };
+    
+    struct Series {
+        std::string labels;
+        std::unique_ptr<TelemetryCounter> counter;
+        std::unique_ptr<TelemetryGauge> gauge;
+        std::unique_ptr<TelemetryHistogram> histogram;
+    };
+    
+    struct Family {
+        Type type;
+        std::string help;
+        std::vector<double> bounds;
+        std::vector<std::unique_ptr<Series>> series;
+    };
+    
+    Series& series(const std::string& name, const std::string& help, const std::string& labels,
+                   Type type, const std::vector<double>* bounds);
+    
+    std::map<std::string, Family> families_;   // Sorted, so scrapes are stable
+    mutable std::mutex mutex_;
+};
+
+/**
+ * @brief trajectory_stage_seconds{stage="<stage>"} in the global registry
+ * @return The histogram, or nullptr when telemetry is compiled out
+ */
+TelemetryHistogram* stageHistogram(const std::string& stage);
+
+/**
+ * @brief Observe the lifetime of a scope into a histogram (nullptr = no-op)
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(TelemetryHistogram* histogram) : histogram_(histogram) {
+        if (kTelemetryEnabled && histogram_) start_ = std::chrono::steady_clock::now();
+    }
+    
+    ~ScopedTimer() {
+        if (kTelemetryEnabled && histogram_) {
+            histogram_->observe(std::chrono::steady_clock::now() - start_);
+        }
+    }
+    
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    TelemetryHistogram* histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace trajectory
+
+#endif // TELEMETRY_H
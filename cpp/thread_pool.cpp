@@ -0,0 +1,134 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Implementation of the worker thread pool
+ */
+
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace trajectory {
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : stop_(false) {
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    workers_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+            
+            if (stop_ && tasks_.empty()) return;
+            
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grain,
+                             const std::function<void(size_t, size_t)>& body) {
+    if (end <= begin) return;
+    
+    const size_t count = end - begin;
+    const size_t n_threads = size() + 1;  // workers + caller
+    
+    if (grain == 0) {
+        grain = (count + n_threads - 1) / n_threads;
+    }
+    
+    const size_t n_chunks = (count + grain - 1) / grain;
+    
+    if (n_chunks == 1) {
+        body(begin, end);
+        return;
+    }
+    
+    // Shared with helper tasks, which may start after this call returns
+    // (they then find no chunk left and exit without touching body)
+    struct State {
+        std::atomic<size_t> next{0};
+        size_t done = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    
+    auto state = std::make_shared<State>();
+    
+    auto run_chunks = [state, begin, end, grain, n_chunks, &body]() {
+        for (;;) {
+            const size_t chunk = state->next.fetch_add(1);
+            if (chunk >= n_chunks) return;
+            
+            const size_t chunk_begin = begin + chunk * grain;
+            const size_t chunk_end = std::min(end, chunk_begin + grain);
+            
+            std::exception_ptr error;
+            try {
+                body(chunk_begin, chunk_end);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (error && !state->error) state->error = error;
+            if (++state->done == n_chunks) state->cv.notify_all();
+        }
+    };
+    
+    const size_t n_helpers = std::min(size(), n_chunks - 1);
+    for (size_t i = 0; i < n_helpers; ++i) {
+        enqueue(run_chunks);
+    }
+    
+    run_chunks();
+    
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&]() { return state->done == n_chunks; });
+    
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+} // namespace trajectory
@@ -0,0 +1,95 @@
+/**
+ * @file thread_pool.h
+ * @brief Fixed-size worker pool for parallel scoring and inference
+ * @author Mission Planner Team
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace trajectory {
+
+/**
+ * @brief Fixed-size thread pool with a FIFO task queue
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Start the worker threads
+     * @param num_threads Number of workers (0 = hardware concurrency)
+     */
+    explicit ThreadPool(size_t num_threads = 0);
+    
+    /**
+     * @brief Finish queued tasks and join the workers
+     */
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    /**
+     * @brief Number of worker threads
+     */
+    size_t size() const { return workers_.size(); }
+    
+    /**
+     * @brief Queue a task
+     * @return Future for the task's result (exceptions are forwarded)
+     */
+    template <class F>
+    std::future<typename std::invoke_result<F>::type> submit(F&& f) {
+        using R = typename std::invoke_result<F>::type;
+        
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> result = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return result;
+    }
+    
+    /**
+     * @brief Run body(chunk_begin, chunk_end) over [begin, end) in parallel
+     * 
+     * The range is split into chunks of `grain` items that workers and the
+     * calling thread claim dynamically. The caller always participates,
+     * so calling this from inside a pool task cannot deadlock. The first
+     * exception thrown by body is rethrown after all chunks finish.
+     * 
+     * @param begin First index
+     * @param end One past the last index
+     * @param grain Items per chunk (0 = split evenly across threads)
+     * @param body Function called once per chunk
+     */
+    void parallelFor(size_t begin, size_t end, size_t grain,
+                     const std::function<void(size_t, size_t)>& body);
+    
+    /**
+     * @brief Process-wide pool sized to the hardware (created on first use)
+     */
+    static ThreadPool& shared();
+
+private:
+    void enqueue(std::function<void()> task);
+    void workerLoop();
+    
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_;
+};
+
+} // namespace trajectory
+
+#endif // THREAD_POOL_H
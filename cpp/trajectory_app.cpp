@@ -10,7 +10,14 @@
  */
 
 #include "trajectory_inference.h"
+#include "trajectory_batch.h"
+#include "trajectory_metrics.h"
+#include "trajectory_ranking.h"
 #include "trajectory_plotter.h"
+#include "precision_check.h"
+#include "trajectory_io.h"
+#include "request_arena.h"
+#include "mission_sweep.h"
 #include <iostream>
 #include <iomanip>
 #include <vector>
@@ -18,76 +25,19 @@
 #include <sstream>
 #include <cstring>
 #include <chrono>
+#include <fstream>
 
 using namespace trajectory;
 
 /**
- * @brief Trajectory ranking metrics
- */
-struct TrajectoryRanking {
-    int index;
-    float path_length;
-    float smoothness;
-    float efficiency;
-    float score;
-    
-    bool operator<(const TrajectoryRanking& other) const {
-        return score > other.score;  // Higher score is better
-    }
-};
-
-/**
- * @brief Compute combined quality score for trajectory
+ * @brief Combined quality score used to pick the plotted trajectories
+ * 
+ * Prefer: high smoothness (weight=0.5), high efficiency (weight=0.3),
+ * shorter paths (weight=0.2)
  */
-float computeQualityScore(const Trajectory& traj) {
-    float length = computePathLength(traj);
-    float smoothness = computeSmoothnessScore(traj);
-    
-    // Compute straight-line distance
-    float dx = traj.back().x - traj.front().x;
-    float dy = traj.back().y - traj.front().y;
-    float dz = traj.back().z - traj.front().z;
-    float straight_dist = std::sqrt(dx*dx + dy*dy + dz*dz);
-    
-    float efficiency = (length > 0) ? (straight_dist / length) : 0.0f;
-    
-    // Combined score (weighted)
-    // Prefer: high smoothness (weight=0.5), high efficiency (weight=0.3), shorter paths (weight=0.2)
-    float normalized_length = std::min(1.0f, 1000.0f / std::max(100.0f, length));
-    float score = 0.5f * smoothness + 0.3f * efficiency + 0.2f * normalized_length;
-    
-    return score;
-}
-
-/**
- * @brief Rank trajectories by quality
- */
-std::vector<TrajectoryRanking> rankTrajectories(const std::vector<Trajectory>& trajectories) {
-    std::vector<TrajectoryRanking> rankings;
-    
-    for (size_t i = 0; i < trajectories.size(); ++i) {
-        TrajectoryRanking ranking;
-        ranking.index = i;
-        ranking.path_length = computePathLength(trajectories[i]);
-        ranking.smoothness = computeSmoothnessScore(trajectories[i]);
-        
-        // Compute efficiency
-        const auto& traj = trajectories[i];
-        float dx = traj.back().x - traj.front().x;
-        float dy = traj.back().y - traj.front().y;
-        float dz = traj.back().z - traj.front().z;
-        float straight_dist = std::sqrt(dx*dx + dy*dy + dz*dz);
-        ranking.efficiency = (ranking.path_length > 0) ? (straight_dist / ranking.path_length) : 0.0f;
-        
-        ranking.score = computeQualityScore(trajectories[i]);
-        
-        rankings.push_back(ranking);
-    }
-    
-    // Sort by score (descending)
-    std::sort(rankings.begin(), rankings.end());
-    
-    return rankings;
+float computeQualityScore(const TrajectoryMetrics& metrics) {
+    float normalized_length = std::min(1.0f, 1000.0f / std::max(100.0f, metrics.path_length));
+    return 0.5f * metrics.smoothness_score + 0.3f * metrics.path_efficiency + 0.2f * normalized_length;
 }
 
 /**
@@ -98,17 +48,34 @@ void printUsage(const char* program_name) {
     std::cout << "Options:\n";
     std::cout << "  --start X Y Z          Starting point coordinates (default: 0 0 100)\n";
     std::cout << "  --end X Y Z            Ending point coordinates (default: 800 600 200)\n";
-    std::cout << "  --waypoints N          Number of waypoints in trajectory (default: 50)\n";
+    std::cout << "  --waypoints N          Number of waypoints in trajectory; must match a model exported\n";
+    std::cout << "                         with a fixed length (default: the model's, else 50)\n";
+    std::cout << "  --candidates N         Candidate trajectories to generate and rank, 1-10000 (default: 10)\n";
     std::cout << "  --model PATH           Path to ONNX model (default: ../models/trajectory_generator.onnx)\n";
     std::cout << "  --norm PATH            Path to normalization JSON (default: ../models/trajectory_generator_normalization.json)\n";
+    std::cout << "  --model-cache PATH     Save/reuse the optimized model here for faster startup\n";
+    std::cout << "  --precision P          Model variant: fp32, fp16 or int8 (default: fp32)\n";
+    std::cout << "  --check-precision      Report drift of the --precision variant against FP32\n";
     std::cout << "  --output FILE          Output plot filename (default: trajectories.png)\n";
     std::cout << "  --no-plot              Disable plotting (only generate trajectories)\n";
     std::cout << "  --csv                  Save trajectories to CSV files\n";
+    std::cout << "  --binary FILE          Save all candidates to a binary trajectory file (with\n";
+    std::cout << "                         --missions: the kept trajectories and their scores)\n";
+    std::cout << "  --gpu                  Run inference on CUDA (falls back to CPU)\n";
+    std::cout << "  --tensorrt             With --gpu, prefer TensorRT over plain CUDA\n";
+    std::cout << "  --seed N               Latent seed (default: random; fix it to reproduce or shard runs)\n";
+    std::cout << "  --missions FILE        Sweep every mission in FILE (start x y z, end x y z per line)\n";
+    std::cout << "  --shard K/N            With --missions, run only missions i with i % N == K\n";
+    std::cout << "  --keep N               With --missions, best candidates kept per mission (default: 1)\n";
+    std::cout << "  --sweep-batch N        With --missions, missions per inference batch (default: 64)\n";
+    std::cout << "  --summary FILE         With --missions, write per-mission summary metrics as CSV\n";
+    std::cout << "                         (the only place they are written; --binary keeps just the score)\n";
     std::cout << "  --help                 Show this help message\n\n";
     std::cout << "Examples:\n";
     std::cout << "  " << program_name << " --start 0 0 100 --end 1000 800 300\n";
-    std::cout << "  " << program_name << " --start -500 300 150 --end 600 -400 250 --waypoints 75\n";
+    std::cout << "  " << program_name << " --start -500 300 150 --end 600 -400 250 --candidates 20\n";
     std::cout << "  " << program_name << " --output my_trajectories.png --csv\n";
+    std::cout << "  " << program_name << " --missions missions.csv --seed 42 --shard 0/4 --binary shard0.trj\n";
 }
 
 /**
@@ -118,13 +85,42 @@ struct AppConfig {
     Waypoint start{0.0f, 0.0f, 100.0f};
     Waypoint end{800.0f, 600.0f, 200.0f};
     int num_waypoints = 50;
+    bool waypoints_given = false;   // --waypoints was passed (else the model's length wins)
+    int num_candidates = 10;
     std::string model_path = "../models/trajectory_generator.onnx";
     std::string norm_path = "../models/trajectory_generator_normalization.json";
+    std::string model_cache;
     std::string output_file = "trajectories.png";
     bool enable_plot = true;
     bool save_csv = false;
+    std::string binary_file;
+    bool use_gpu = false;
+    bool use_tensorrt = false;
+    ModelPrecision precision = ModelPrecision::FP32;
+    bool check_precision = false;
+    uint64_t seed = 0;
+    std::string missions_file;
+    std::string summary_file;
+    size_t shard_index = 0;
+    size_t shard_count = 1;
+    size_t keep_best = 1;
+    size_t sweep_batch = 64;
 };
 
+/**
+ * @brief Parse a whole string as a non-negative integer
+ * @return False on signs, trailing characters or overflow
+ */
+bool parseUnsigned(const std::string& text, uint64_t& value) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) return false;
+    try {
+        value = std::stoull(text);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
 bool parseArguments(int argc, char* argv[], AppConfig& config) {
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -154,10 +150,27 @@ bool parseArguments(int argc, char* argv[], AppConfig& config) {
                 return false;
             }
             config.num_waypoints = std::stoi(argv[++i]);
+            config.waypoints_given = true;
             if (config.num_waypoints < 2 || config.num_waypoints > 200) {
                 std::cerr << "Error: waypoints must be between 2 and 200" << std::endl;
                 return false;
             }
+        } else if (arg == "--candidates") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --candidates requires an argument" << std::endl;
+                return false;
+            }
+            uint64_t candidates = 0;
+            if (!parseUnsigned(argv[++i], candidates)) {
+                std::cerr << "Error: --candidates must be an integer" << std::endl;
+                return false;
+            }
+            // Bounds the request arena, which holds every candidate's waypoints
+            if (candidates < 1 || candidates > 10000) {
+                std::cerr << "Error: candidates must be between 1 and 10000" << std::endl;
+                return false;
+            }
+            config.num_candidates = static_cast<int>(candidates);
         } else if (arg == "--model") {
             if (i + 1 >= argc) {
                 std::cerr << "Error: --model requires an argument" << std::endl;
@@ -170,6 +183,30 @@ bool parseArguments(int argc, char* argv[], AppConfig& config) {
                 return false;
             }
             config.norm_path = argv[++i];
+        } else if (arg == "--model-cache") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --model-cache requires an argument" << std::endl;
+                return false;
+            }
+            config.model_cache = argv[++i];
+        } else if (arg == "--precision") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --precision requires an argument" << std::endl;
+                return false;
+            }
+            std::string name = argv[++i];
+            if (name == "fp32") {
+                config.precision = ModelPrecision::FP32;
+            } else if (name == "fp16") {
+                config.precision = ModelPrecision::FP16;
+            } else if (name == "int8") {
+                config.precision = ModelPrecision::INT8;
+            } else {
+                std::cerr << "Error: precision must be fp32, fp16 or int8" << std::endl;
+                return false;
+            }
+        } else if (arg == "--check-precision") {
+            config.check_precision = true;
         } else if (arg == "--output") {
             if (i + 1 >= argc) {
                 std::cerr << "Error: --output requires an argument" << std::endl;
@@ -180,6 +217,87 @@ bool parseArguments(int argc, char* argv[], AppConfig& config) {
             config.enable_plot = false;
         } else if (arg == "--csv") {
             config.save_csv = true;
+        } else if (arg == "--binary") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --binary requires an argument" << std::endl;
+                return false;
+            }
+            config.binary_file = argv[++i];
+        } else if (arg == "--gpu") {
+            config.use_gpu = true;
+        } else if (arg == "--tensorrt") {
+            config.use_gpu = true;
+            config.use_tensorrt = true;
+        } else if (arg == "--seed") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --seed requires an argument" << std::endl;
+                return false;
+            }
+            if (!parseUnsigned(argv[++i], config.seed)) {
+                std::cerr << "Error: --seed must be a non-negative integer" << std::endl;
+                return false;
+            }
+        } else if (arg == "--missions") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --missions requires an argument" << std::endl;
+                return false;
+            }
+            config.missions_file = argv[++i];
+        } else if (arg == "--shard") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --shard requires an argument (K/N)" << std::endl;
+                return false;
+            }
+            std::string shard = argv[++i];
+            size_t slash = shard.find('/');
+            uint64_t index = 0, count = 0;
+            if (slash == std::string::npos || !parseUnsigned(shard.substr(0, slash), index) ||
+                !parseUnsigned(shard.substr(slash + 1), count)) {
+                std::cerr << "Error: --shard must be K/N" << std::endl;
+                return false;
+            }
+            config.shard_index = static_cast<size_t>(index);
+            config.shard_count = static_cast<size_t>(count);
+            if (config.shard_count == 0 || config.shard_index >= config.shard_count) {
+                std::cerr << "Error: --shard needs 0 <= K < N" << std::endl;
+                return false;
+            }
+        } else if (arg == "--keep") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --keep requires an argument" << std::endl;
+                return false;
+            }
+            uint64_t keep = 0;
+            if (!parseUnsigned(argv[++i], keep)) {
+                std::cerr << "Error: --keep must be an integer" << std::endl;
+                return false;
+            }
+            if (keep < 1) {
+                std::cerr << "Error: keep must be at least 1" << std::endl;
+                return false;
+            }
+            config.keep_best = static_cast<size_t>(keep);
+        } else if (arg == "--sweep-batch") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --sweep-batch requires an argument" << std::endl;
+                return false;
+            }
+            uint64_t batch = 0;
+            if (!parseUnsigned(argv[++i], batch)) {
+                std::cerr << "Error: --sweep-batch must be an integer" << std::endl;
+                return false;
+            }
+            if (batch < 1) {
+                std::cerr << "Error: sweep batch must be at least 1" << std::endl;
+                return false;
+            }
+            config.sweep_batch = static_cast<size_t>(batch);
+        } else if (arg == "--summary") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --summary requires an argument" << std::endl;
+                return false;
+            }
+            config.summary_file = argv[++i];
         } else {
             std::cerr << "Error: Unknown argument '" << arg << "'" << std::endl;
             return false;
@@ -189,6 +307,92 @@ bool parseArguments(int argc, char* argv[], AppConfig& config) {
     return true;
 }
 
+/**
+ * @brief Sweep mode: rank every mission of --missions and report aggregates
+ */
+int runMissionSweep(const AppConfig& config, TrajectoryGenerator& generator) {
+    std::cout << "\n--- Mission Sweep ---" << std::endl;
+    
+    std::vector<Mission> missions;
+    if (!loadMissions(config.missions_file, missions)) {
+        return 1;
+    }
+    
+    SweepOptions options;
+    options.candidates = config.num_candidates;
+    options.missions_per_batch = config.sweep_batch;
+    options.keep_best = std::min(config.keep_best, static_cast<size_t>(config.num_candidates));
+    options.shard_index = config.shard_index;
+    options.shard_count = config.shard_count;
+    options.scorer = computeQualityScore;
+    
+    std::cout << "Missions: " << missions.size() << " (shard " << config.shard_index << "/"
+              << config.shard_count << "), " << config.num_candidates << " candidates each" << std::endl;
+    
+    TrajectoryWriter writer;
+    if (!config.binary_file.empty() &&
+        !writer.open(config.binary_file, generator.getSeqLen(), generator.getSeed())) {
+        std::cerr << "✗ Failed to open " << config.binary_file << std::endl;
+        return 1;
+    }
+    
+    std::ofstream summary_csv;
+    if (!config.summary_file.empty()) {
+        summary_csv.open(config.summary_file);
+        if (!summary_csv.is_open()) {
+            std::cerr << "✗ Failed to open " << config.summary_file << std::endl;
+            return 1;
+        }
+        summary_csv << "mission,start_x,start_y,start_z,end_x,end_y,end_z,valid,score,"
+                       "path_length,efficiency,smoothness,max_curvature,endpoint_error\n";
+    }
+    
+    MissionCallback on_result;
+    if (summary_csv.is_open()) {
+        on_result = [&](const MissionResult& result) {
+            const Mission& mission = missions[result.mission];
+            summary_csv << result.mission << ","
+                        << mission.start.x << "," << mission.start.y << "," << mission.start.z << ","
+                        << mission.end.x << "," << mission.end.y << "," << mission.end.z << ","
+                        << result.valid << "," << result.best_score << ","
+                        << result.best.path_length << "," << result.best.path_efficiency << ","
+                        << result.best.smoothness_score << "," << result.best.max_curvature << ","
+                        << result.best.endpoint_error << "\n";
+        };
+    }
+    
+    SweepSummary summary = runSweep(generator, missions, options,
+                                    writer.isOpen() ? &writer : nullptr, on_result);
+    
+    if (writer.isOpen() && !writer.close()) {
+        std::cerr << "✗ Failed to finish " << config.binary_file << std::endl;
+        return 1;
+    }
+    
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "✓ Swept " << summary.missions << " missions (" << summary.generated
+              << " candidates) in " << summary.elapsed_ms << " ms, "
+              << summary.missionsPerSecond() << " missions/s" << std::endl;
+    std::cout << "  Inference:        " << summary.generate_ms << " ms" << std::endl;
+    std::cout << "  Scoring:          " << summary.scoring_ms << " ms (overlapped)" << std::endl;
+    std::cout << "  Mean path length: " << summary.mean_path_length << " m" << std::endl;
+    std::cout << std::setprecision(4);
+    std::cout << "  Mean score:       " << summary.mean_best_score << std::endl;
+    std::cout << "  Mean efficiency:  " << summary.mean_efficiency << std::endl;
+    std::cout << "  Mean smoothness:  " << summary.mean_smoothness << std::endl;
+    std::cout << "  Worst curvature:  " << summary.worst_max_curvature << " rad/m" << std::endl;
+    if (summary.missions_without_valid > 0) {
+        std::cout << "⚠ " << summary.missions_without_valid << " missions had no valid candidate" << std::endl;
+    }
+    if (!config.binary_file.empty()) {
+        std::cout << "✓ Saved " << summary.written << " trajectories to " << config.binary_file << std::endl;
+    }
+    if (summary_csv.is_open()) {
+        std::cout << "✓ Per-mission metrics saved to " << config.summary_file << std::endl;
+    }
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     std::cout << "========================================" << std::endl;
     std::cout << "Trajectory Generator - C++ Application" << std::endl;
@@ -206,6 +410,7 @@ int main(int argc, char* argv[]) {
     std::cout << "  End point:   [" << config.end.x << ", " << config.end.y << ", " << config.end.z << "]" << std::endl;
     std::cout << "  Waypoints:   " << config.num_waypoints << std::endl;
     std::cout << "  Model:       " << config.model_path << std::endl;
+    std::cout << "  Precision:   " << precisionName(config.precision) << std::endl;
     std::cout << "  Output:      " << config.output_file << std::endl;
     
     try {
@@ -213,9 +418,33 @@ int main(int argc, char* argv[]) {
         std::cout << "\n--- Initializing Generator ---" << std::endl;
         
         GeneratorConfig gen_config(config.model_path);
-        gen_config.latent_dim = 64;
+        
+        // latent_dim, seq_len and I/O names from the export's sidecar. A
+        // missing file is reported by loadNormalization() below; a malformed
+        // one is an error rather than a silent fall back to defaults
+        ModelMetadata metadata;
+        if (std::ifstream(config.norm_path)) {
+            metadata = loadModelMetadata(config.norm_path);
+            applyModelMetadata(metadata, gen_config);
+        }
+        if (metadata.seq_len > 0 && metadata.seq_len != config.num_waypoints) {
+            if (config.waypoints_given) {
+                throw std::runtime_error("--waypoints " + std::to_string(config.num_waypoints) +
+                                         " does not match the model, which generates " +
+                                         std::to_string(metadata.seq_len));
+            }
+            std::cout << "  Waypoints:   " << metadata.seq_len << " (fixed by the model)" << std::endl;
+            config.num_waypoints = metadata.seq_len;
+        }
         gen_config.seq_len = config.num_waypoints;
         gen_config.num_threads = 4;
+        gen_config.use_gpu = config.use_gpu;
+        gen_config.use_tensorrt = config.use_tensorrt;
+        gen_config.optimized_model_path = config.model_cache;
+        gen_config.precision = config.precision;
+        gen_config.seed = config.seed;
+        
+        auto init_start = std::chrono::high_resolution_clock::now();
         
         TrajectoryGenerator generator(gen_config);
         
@@ -224,16 +453,77 @@ int main(int argc, char* argv[]) {
             std::cerr << "Warning: Failed to load normalization, using defaults" << std::endl;
         }
         
+        // Pre-run the batch shapes generateMultiple will use, so the timing
+        // below measures steady-state inference rather than first-run setup
+        int n_candidates = config.num_candidates;
+        const int max_batch = generator.getMaxBatchSize();
+        std::vector<int> warmup_sizes = {std::min(n_candidates, max_batch)};
+        if (config.missions_file.empty()) {
+            if (n_candidates > max_batch && n_candidates % max_batch != 0) {
+                warmup_sizes.push_back(n_candidates % max_batch);
+            }
+        } else {
+            // A sweep batch packs many missions, so full batches dominate
+            warmup_sizes = {max_batch};
+        }
+        generator.warmup(warmup_sizes);
+        
+        auto init_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - init_start);
+        std::cout << "✓ Generator ready in " << init_ms.count() << " ms" << std::endl;
+        std::cout << "  Latent seed: " << generator.getSeed() << std::endl;
+        
+        if (config.check_precision) {
+            std::cout << "\n--- Precision Check (" << precisionName(config.precision)
+                      << " vs fp32) ---" << std::endl;
+            
+            GeneratorConfig baseline_config = gen_config;
+            baseline_config.precision = ModelPrecision::FP32;
+            baseline_config.seed = generator.getSeed();
+            
+            TrajectoryGenerator baseline(baseline_config);
+            baseline.loadNormalization(config.norm_path);
+            
+            PrecisionReport report = comparePrecision(baseline, generator,
+                                                      makeCalibrationRequests(32, 8));
+            
+            std::cout << std::fixed << std::setprecision(3);
+            std::cout << "  Trajectories:      " << report.trajectories << std::endl;
+            std::cout << "  Endpoint error:    " << report.baseline_endpoint_error << " -> "
+                      << report.candidate_endpoint_error << " m (drift "
+                      << report.endpoint_error_drift << " m)" << std::endl;
+            std::cout << "  Smoothness:        " << report.baseline_smoothness << " -> "
+                      << report.candidate_smoothness << " (drift "
+                      << report.smoothness_drift << ")" << std::endl;
+            std::cout << "  Waypoint offset:   mean " << report.mean_waypoint_deviation
+                      << " m, max " << report.max_waypoint_deviation << " m" << std::endl;
+            std::cout << "  Generation time:   " << report.baseline_ms << " -> "
+                      << report.candidate_ms << " ms" << std::endl;
+            std::cout << (withinTolerance(report) ? "✓ Within tolerance" : "⚠ Exceeds tolerance")
+                      << std::endl;
+            std::cout.unsetf(std::ios::fixed);
+            std::cout << std::setprecision(6);
+        }
+        
+        if (!config.missions_file.empty()) {
+            return runMissionSweep(config, generator);
+        }
+        
         // Generate diverse trajectories
         std::cout << "\n--- Generating Trajectories ---" << std::endl;
-        std::cout << "Generating 10 candidate trajectories..." << std::endl;
+        std::cout << "Generating " << n_candidates << " candidate trajectories..." << std::endl;
         
         auto start_time = std::chrono::high_resolution_clock::now();
         
-        int n_candidates = 10;
-        std::vector<Trajectory> all_trajectories = generator.generateMultiple(
-            config.start, config.end, n_candidates
-        );
+        // Explicit id so the binary file records which latent stream was used
+        GenerationRequest request(config.start, config.end, n_candidates, generator.nextRequestId());
+        generator.setNextRequestId(request.request_id + 1);
+        
+        // Candidate storage and ranking scratch share one arena block
+        RequestArena arena(static_cast<size_t>(n_candidates) * generator.getSeqLen() * 3 * sizeof(float) +
+                           static_cast<size_t>(n_candidates) * sizeof(RankedTrajectory) + 4096);
+        TrajectoryBatch all_trajectories(arena.resource());
+        generator.generateBatch(&request, 1, all_trajectories);
         
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
@@ -243,7 +533,19 @@ int main(int argc, char* argv[]) {
         
         // Rank trajectories
         std::cout << "\n--- Ranking Trajectories ---" << std::endl;
-        auto rankings = rankTrajectories(all_trajectories);
+        
+        // Only the top 5 are shown, so skip sorting the rest
+        RankingConfig ranking_config;
+        ranking_config.top_k = 5;
+        RankingEngine ranker(ranking_config, computeQualityScore);
+        
+        auto rank_start = std::chrono::high_resolution_clock::now();
+        auto rankings = ranker.rank(all_trajectories, config.end, arena.resource());
+        auto rank_end = std::chrono::high_resolution_clock::now();
+        
+        std::cout << "✓ Scored " << all_trajectories.size() << " candidates in "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(rank_end - rank_start).count()
+                  << " us" << std::endl;
         
         std::cout << "\nTop 5 Trajectories (ranked by quality):\n" << std::endl;
         std::cout << std::setw(5) << "Rank" 
@@ -256,16 +558,16 @@ int main(int argc, char* argv[]) {
         std::vector<Trajectory> top5_trajectories;
         std::vector<std::string> labels;
         
-        for (int i = 0; i < std::min(5, static_cast<int>(rankings.size())); ++i) {
+        for (size_t i = 0; i < rankings.size(); ++i) {
             const auto& rank = rankings[i];
             std::cout << std::setw(5) << (i + 1)
-                      << std::setw(12) << std::fixed << std::setprecision(1) << rank.path_length
-                      << std::setw(12) << std::fixed << std::setprecision(4) << rank.smoothness
-                      << std::setw(12) << std::fixed << std::setprecision(3) << rank.efficiency
+                      << std::setw(12) << std::fixed << std::setprecision(1) << rank.metrics.path_length
+                      << std::setw(12) << std::fixed << std::setprecision(4) << rank.metrics.smoothness_score
+                      << std::setw(12) << std::fixed << std::setprecision(3) << rank.metrics.path_efficiency
                       << std::setw(12) << std::fixed << std::setprecision(4) << rank.score
                       << std::endl;
             
-            top5_trajectories.push_back(all_trajectories[rank.index]);
+            top5_trajectories.push_back(all_trajectories.toTrajectory(rank.index));
             labels.push_back("Trajectory #" + std::to_string(i + 1) + " (Score: " + 
                            std::to_string(rank.score).substr(0, 5) + ")");
         }
@@ -285,6 +587,19 @@ int main(int argc, char* argv[]) {
             plotter.saveToCSV(top5_trajectories, "trajectory");
         }
         
+        // Save all candidates in binary form if requested
+        if (!config.binary_file.empty()) {
+            std::cout << "\n--- Saving Binary ---" << std::endl;
+            TrajectoryWriter writer;
+            if (writer.open(config.binary_file, all_trajectories.seqLen(), generator.getSeed()) &&
+                writer.append(all_trajectories, &request, 1) && writer.close()) {
+                std::cout << "✓ Saved " << all_trajectories.size() << " trajectories to "
+                          << config.binary_file << std::endl;
+            } else {
+                std::cerr << "✗ Failed to save " << config.binary_file << std::endl;
+            }
+        }
+        
         // Plot trajectories
         if (config.enable_plot) {
             std::cout << "\n--- Generating Plot ---" << std::endl;
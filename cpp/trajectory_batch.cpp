@@ -0,0 +1,62 @@
+/**
+ * @file trajectory_batch.cpp
+ * @brief Implementation of contiguous trajectory batch storage
+ */
+
+#include "trajectory_batch.h"
+#include <stdexcept>
+#include <algorithm>
+
+namespace trajectory {
+
+TrajectoryBatch::TrajectoryBatch(int seq_len, size_t capacity,
+                                 std::pmr::memory_resource* resource)
+    : storage_(resource), size_(0), seq_len_(seq_len) {
+    if (seq_len_ < 0) {
+        throw std::runtime_error("TrajectoryBatch seq_len must be non-negative");
+    }
+    reserve(capacity);
+}
+
+void TrajectoryBatch::reset(int seq_len, size_t capacity) {
+    if (seq_len < 0) {
+        throw std::runtime_error("TrajectoryBatch seq_len must be non-negative");
+    }
+    size_ = 0;
+    seq_len_ = seq_len;
+    reserve(capacity);
+}
+
+void TrajectoryBatch::reserve(size_t n) {
+    if (n * stride() > storage_.size()) {
+        storage_.resize(n * stride());
+    }
+}
+
+float* TrajectoryBatch::appendRows(size_t n) {
+    if (seq_len_ == 0) {
+        throw std::runtime_error("TrajectoryBatch seq_len not set");
+    }
+    
+    // Grow geometrically so repeated appends stay amortized O(1)
+    if (size_ + n > capacity()) {
+        reserve(std::max(size_ + n, capacity() * 2));
+    }
+    
+    float* first = row(size_);
+    size_ += n;
+    return first;
+}
+
+std::vector<Trajectory> TrajectoryBatch::toTrajectories() const {
+    std::vector<Trajectory> trajectories;
+    trajectories.reserve(size_);
+    
+    for (size_t i = 0; i < size_; ++i) {
+        trajectories.push_back(toTrajectory(i));
+    }
+    
+    return trajectories;
+}
+
+} // namespace trajectory
@@ -0,0 +1,143 @@
+/**
+ * @file trajectory_batch.h
+ * @brief Contiguous batch storage for generated trajectories
+ * @author Mission Planner Team
+ * 
+ * A TrajectoryBatch holds N trajectories of equal length in one
+ * [N, seq_len, 3] float buffer, the same layout as the ONNX model
+ * output. The generator writes inference results straight into it, and
+ * each row is exposed as a TrajectoryView for the metrics functions.
+ */
+
+#ifndef TRAJECTORY_BATCH_H
+#define TRAJECTORY_BATCH_H
+
+#include "trajectory_inference.h"
+#include <vector>
+#include <cstddef>
+#include <memory_resource>
+
+namespace trajectory {
+
+/**
+ * @brief Batch of equal-length trajectories in one [N, seq_len, 3] buffer
+ */
+class TrajectoryBatch {
+public:
+    /**
+     * @brief Construct an empty batch
+     * @param seq_len Waypoints per trajectory (0 = set by first writer)
+     * @param capacity Number of trajectories to reserve storage for
+     * @param resource Storage allocator (e.g. a RequestArena)
+     */
+    explicit TrajectoryBatch(int seq_len = 0, size_t capacity = 0,
+                             std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    
+    /**
+     * @brief Empty batch whose storage comes from resource
+     */
+    explicit TrajectoryBatch(std::pmr::memory_resource* resource)
+        : TrajectoryBatch(0, 0, resource) {}
+    
+    /**
+     * @brief Clear the batch and change its sequence length
+     * 
+     * Storage is kept, so reusing a batch across requests does not
+     * allocate once it has grown to the working size.
+     * 
+     * @param seq_len Waypoints per trajectory
+     * @param capacity Number of trajectories to reserve storage for
+     */
+    void reset(int seq_len, size_t capacity = 0);
+    
+    /**
+     * @brief Ensure storage for at least n trajectories
+     */
+    void reserve(size_t n);
+    
+    /**
+     * @brief Remove all trajectories (storage is kept)
+     */
+    void clear() { size_ = 0; }
+    
+    /**
+     * @brief Append n uninitialized rows
+     * @param n Number of rows to append
+     * @return Pointer to the first appended row
+     */
+    float* appendRows(size_t n);
+    
+    /**
+     * @brief Shrink the batch to its first n rows
+     */
+    void truncate(size_t n) { if (n < size_) size_ = n; }
+    
+    /**
+     * @brief Number of trajectories in the batch
+     */
+    size_t size() const { return size_; }
+    
+    /**
+     * @brief True if the batch has no trajectories
+     */
+    bool empty() const { return size_ == 0; }
+    
+    /**
+     * @brief Number of trajectories storage is reserved for
+     */
+    size_t capacity() const { return stride() ? storage_.size() / stride() : 0; }
+    
+    /**
+     * @brief Waypoints per trajectory
+     */
+    int seqLen() const { return seq_len_; }
+    
+    /**
+     * @brief Floats per trajectory row (seq_len * 3)
+     */
+    size_t stride() const { return static_cast<size_t>(seq_len_) * 3; }
+    
+    /**
+     * @brief Raw [size, seq_len, 3] buffer
+     */
+    float* data() { return storage_.data(); }
+    const float* data() const { return storage_.data(); }
+    
+    /**
+     * @brief Pointer to the [seq_len, 3] floats of row i
+     */
+    float* row(size_t i) { return storage_.data() + i * stride(); }
+    const float* row(size_t i) const { return storage_.data() + i * stride(); }
+    
+    /**
+     * @brief Lightweight view of trajectory i
+     */
+    TrajectoryView view(size_t i) const {
+        return TrajectoryView(row(i), static_cast<size_t>(seq_len_));
+    }
+    TrajectoryView operator[](size_t i) const { return view(i); }
+    
+    /**
+     * @brief Copy trajectory i into an owning Trajectory
+     */
+    Trajectory toTrajectory(size_t i) const { return view(i).toTrajectory(); }
+    
+    /**
+     * @brief Copy all trajectories into owning Trajectory objects
+     */
+    std::vector<Trajectory> toTrajectories() const;
+    
+    /**
+     * @brief Allocator the storage comes from
+     */
+    std::pmr::memory_resource* memoryResource() const { return storage_.get_allocator().resource(); }
+
+private:
+    std::pmr::vector<float> storage_;
+    size_t size_;
+    int seq_len_;
+};
+
+} // namespace trajectory
+
+#endif // TRAJECTORY_BATCH_H
@@ -0,0 +1,459 @@
+/**
+ * @file trajectory_bench.cpp
+ * @brief Latency and throughput benchmark for the generation pipeline
+ * 
+ * Sweeps execution provider, intra-op thread count, sequence length and
+ * batch size. Each configuration is warmed up, then timed per iteration
+ * with the stages reported separately:
+ * 
+ *   sampling     latent draws and condition normalization
+ *   inference    tensor setup and session Run
+ *   postprocess  denormalization into the batch buffer
+ *   metrics      evaluateTrajectories() over the batch
+ * 
+ * Results are printed as a table and written as JSON so runs can be
+ * compared across commits and machines.
+ */
+
+#include "trajectory_inference.h"
+#include "trajectory_batch.h"
+#include "trajectory_metrics.h"
+#include "trajectory_kernels.h"
+#include "precision_check.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace trajectory;
+
+/**
+ * @brief Print usage information
+ */
+void printUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --model PATH           Path to ONNX model (default: ../models/trajectory_generator.onnx)\n";
+    std::cout << "  --norm PATH            Path to normalization JSON (default: ../models/trajectory_generator_normalization.json)\n";
+    std::cout << "  --precision P          Model variant: fp32, fp16 or int8 (default: fp32)\n";
+    std::cout << "  --batch-sizes LIST     Trajectories per call (default: 1,8,32,64)\n";
+    std::cout << "  --threads LIST         Intra-op thread counts (default: 1,2,4)\n";
+    std::cout << "  --seq-lens LIST        Waypoints per trajectory (default: 50)\n";
+    std::cout << "  --providers LIST       cpu, cuda and/or tensorrt (default: cpu)\n";
+    std::cout << "  --iterations N         Timed iterations per configuration (default: 20)\n";
+    std::cout << "  --warmup N             Untimed iterations per configuration (default: 3)\n";
+    std::cout << "  --io-binding           Bind pre-allocated I/O buffers\n";
+    std::cout << "  --output FILE          JSON report (default: bench.json)\n";
+    std::cout << "  --help                 Show this help message\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << program_name << " --batch-sizes 1,16,64 --threads 1,4 --output cpu.json\n";
+}
+
+/**
+ * @brief Benchmark settings
+ */
+struct BenchConfig {
+    std::string model_path = "../models/trajectory_generator.onnx";
+    std::string norm_path = "../models/trajectory_generator_normalization.json";
+    ModelPrecision precision = ModelPrecision::FP32;
+    std::vector<int> batch_sizes = {1, 8, 32, 64};
+    std::vector<int> threads = {1, 2, 4};
+    std::vector<int> seq_lens = {50};
+    std::vector<std::string> providers = {"cpu"};
+    int iterations = 20;
+    int warmup = 3;
+    bool use_io_binding = false;
+    std::string output_file = "bench.json";
+};
+
+/**
+ * @brief Latency distribution of one stage, in milliseconds
+ */
+struct StageStats {
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+/**
+ * @brief Measurements of one (provider, threads, seq_len, batch) point
+ */
+struct BenchResult {
+    std::string provider;        // Provider the session actually runs on
+    int threads = 0;
+    int seq_len = 0;             // Model output length
+    int batch_size = 0;
+    int iterations = 0;
+    StageStats sampling;
+    StageStats inference;
+    StageStats postprocess;
+    StageStats metrics;
+    StageStats total;
+    double throughput = 0.0;     // Trajectories per second, from the mean total
+};
+
+/**
+ * @brief Parse a whole string as an integer (no trailing characters)
+ */
+bool parseInt(const std::string& text, int& value) {
+    try {
+        size_t used = 0;
+        value = std::stoi(text, &used);
+        return used == text.size();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+/**
+ * @brief Parse a comma-separated list of positive integers
+ */
+bool parseIntList(const std::string& text, std::vector<int>& values) {
+    values.clear();
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        int value = 0;
+        if (!parseInt(item, value) || value < 1) return false;
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+/**
+ * @brief Parse command line arguments
+ */
+bool parseArguments(int argc, char* argv[], BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return false;
+        }
+        if (arg == "--io-binding") {
+            config.use_io_binding = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: Unknown argument or missing value '" << arg << "'" << std::endl;
+            return false;
+        }
+        
+        const std::string value = argv[++i];
+        if (arg == "--model") {
+            config.model_path = value;
+        } else if (arg == "--norm") {
+            config.norm_path = value;
+        } else if (arg == "--output") {
+            config.output_file = value;
+        } else if (arg == "--precision") {
+            if (value == "fp32") {
+                config.precision = ModelPrecision::FP32;
+            } else if (value == "fp16") {
+                config.precision = ModelPrecision::FP16;
+            } else if (value == "int8") {
+                config.precision = ModelPrecision::INT8;
+            } else {
+                std::cerr << "Error: precision must be fp32, fp16 or int8" << std::endl;
+                return false;
+            }
+        } else if (arg == "--batch-sizes" || arg == "--threads" || arg == "--seq-lens") {
+            std::vector<int>& list = arg == "--batch-sizes" ? config.batch_sizes
+                                   : arg == "--threads" ? config.threads : config.seq_lens;
+            if (!parseIntList(value, list)) {
+                std::cerr << "Error: " << arg << " expects positive integers like 1,8,32" << std::endl;
+                return false;
+            }
+        } else if (arg == "--providers") {
+            config.providers.clear();
+            std::stringstream stream(value);
+            std::string name;
+            while (std::getline(stream, name, ',')) {
+                if (name != "cpu" && name != "cuda" && name != "tensorrt") {
+                    std::cerr << "Error: providers must be cpu, cuda or tensorrt" << std::endl;
+                    return false;
+                }
+                config.providers.push_back(name);
+            }
+        } else if (arg == "--iterations" || arg == "--warmup") {
+            int count = 0;
+            if (!parseInt(value, count)) {
+                std::cerr << "Error: " << arg << " must be an integer" << std::endl;
+                return false;
+            }
+            if (count < (arg == "--iterations" ? 1 : 0)) {
+                std::cerr << "Error: " << arg << " is out of range" << std::endl;
+                return false;
+            }
+            (arg == "--iterations" ? config.iterations : config.warmup) = count;
+        } else {
+            std::cerr << "Error: Unknown argument '" << arg << "'" << std::endl;
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Nearest-rank percentiles of a set of samples
+ */
+StageStats computeStats(std::vector<double> samples) {
+    StageStats stats;
+    if (samples.empty()) return stats;
+    
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double s : samples) sum += s;
+    
+    auto rank = [&](double q) {
+        const size_t index = static_cast<size_t>(q * static_cast<double>(samples.size() - 1) + 0.5);
+        return samples[std::min(index, samples.size() - 1)];
+    };
+    
+    stats.mean = sum / static_cast<double>(samples.size());
+    stats.p50 = rank(0.50);
+    stats.p95 = rank(0.95);
+    stats.p99 = rank(0.99);
+    stats.max = samples.back();
+    return stats;
+}
+
+/**
+ * @brief Time one batch size on an already loaded session
+ */
+BenchResult runPoint(const std::shared_ptr<ModelSession>& model, const GeneratorConfig& base,
+                     const NormalizationParams& norm, int batch_size, const BenchConfig& config) {
+    GeneratorConfig gen_config = base;
+    gen_config.max_batch_size = batch_size;
+    gen_config.seed = 1;
+    
+    TrajectoryGenerator generator(model, gen_config);
+    generator.setNormalization(norm);
+    generator.warmup({batch_size});
+    
+    // One single-sample request per row, so every row has its own condition
+    const std::vector<GenerationRequest> requests = makeCalibrationRequests(batch_size, 1);
+    std::vector<Waypoint> ends;
+    for (const GenerationRequest& r : requests) ends.push_back(r.end);
+    
+    const int seq_len = model->outputSeqLen();
+    TrajectoryBatch batch(seq_len, batch_size);
+    std::vector<TrajectoryMetrics> metrics(batch_size);
+    
+    std::vector<double> sampling, inference, postprocess, metric, total;
+    
+    for (int it = 0; it < config.warmup + config.iterations; ++it) {
+        batch.clear();
+        generator.resetStageTimes();
+        
+        const auto start = std::chrono::steady_clock::now();
+        generator.generateBatch(requests.data(), requests.size(), batch);
+        const auto generated = std::chrono::steady_clock::now();
+        evaluateTrajectories(batch.data(), batch.size(), seq_len, ends.data(), metrics.data());
+        const auto end = std::chrono::steady_clock::now();
+        
+        if (it < config.warmup) continue;
+        
+        const GenerationStageTimes& stages = generator.getStageTimes();
+        sampling.push_back(stages.sampling_ms);
+        inference.push_back(stages.inference_ms);
+        postprocess.push_back(stages.postprocess_ms);
+        metric.push_back(std::chrono::duration<double, std::milli>(end - generated).count());
+        total.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    
+    BenchResult result;
+    result.provider = model->executionProvider();
+    result.threads = base.num_threads;
+    result.seq_len = seq_len;
+    result.batch_size = batch_size;
+    result.iterations = config.iterations;
+    result.sampling = computeStats(sampling);
+    result.inference = computeStats(inference);
+    result.postprocess = computeStats(postprocess);
+    result.metrics = computeStats(metric);
+    result.total = computeStats(total);
+    result.throughput = result.total.mean > 0.0 ? batch_size * 1000.0 / result.total.mean : 0.0;
+    return result;
+}
+
+/**
+ * @brief Escape a string for a JSON literal
+ */
+std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+void writeStats(std::ostream& out, const char* name, const StageStats& s, bool last = false) {
+    out << "        " << jsonString(name) << ": {\"mean\": " << s.mean << ", \"p50\": " << s.p50
+        << ", \"p95\": " << s.p95 << ", \"p99\": " << s.p99 << ", \"max\": " << s.max << "}"
+        << (last ? "\n" : ",\n");
+}
+
+/**
+ * @brief Write the report as JSON (times in milliseconds)
+ */
+bool writeReport(const std::string& path, const BenchConfig& config,
+                 const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot write " << path << std::endl;
+        return false;
+    }
+    
+    out << std::fixed << std::setprecision(4);
+    out << "{\n";
+    out << "  \"metadata\": {\n";
+    out << "    \"model\": " << jsonString(config.model_path) << ",\n";
+    out << "    \"precision\": " << jsonString(precisionName(config.precision)) << ",\n";
+    out << "    \"onnxruntime\": " << jsonString(Ort::GetVersionString()) << ",\n";
+    out << "    \"kernel_isa\": " << jsonString(kernelIsaName(activeKernelIsa())) << ",\n";
+    out << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "    \"io_binding\": " << (config.use_io_binding ? "true" : "false") << ",\n";
+    out << "    \"iterations\": " << config.iterations << ",\n";
+    out << "    \"warmup\": " << config.warmup << ",\n";
+    out << "    \"units\": \"ms\"\n";
+    out << "  },\n";
+    out << "  \"results\": [\n";
+    
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << "    {\n";
+        out << "      \"provider\": " << jsonString(r.provider) << ",\n";
+        out << "      \"threads\": " << r.threads << ",\n";
+        out << "      \"seq_len\": " << r.seq_len << ",\n";
+        out << "      \"batch_size\": " << r.batch_size << ",\n";
+        out << "      \"iterations\": " << r.iterations << ",\n";
+        out << "      \"throughput\": " << r.throughput << ",\n";
+        out << "      \"stages\": {\n";
+        writeStats(out, "sampling", r.sampling);
+        writeStats(out, "inference", r.inference);
+        writeStats(out, "postprocess", r.postprocess);
+        writeStats(out, "metrics", r.metrics);
+        writeStats(out, "total", r.total, true);
+        out << "      }\n";
+        out << "    }" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    
+    out << "  ]\n";
+    out << "}\n";
+    return out.good();
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parseArguments(argc, argv, config)) {
+        return 1;
+    }
+    
+    const int max_batch = *std::max_element(config.batch_sizes.begin(), config.batch_sizes.end());
+    std::vector<BenchResult> results;
+    
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(10) << "Provider" << std::setw(8) << "Threads" << std::setw(8) << "SeqLen"
+              << std::setw(7) << "Batch" << std::setw(11) << "Sample" << std::setw(11) << "Infer"
+              << std::setw(11) << "Post" << std::setw(11) << "Metrics" << std::setw(11) << "p50"
+              << std::setw(11) << "p99" << std::setw(12) << "Traj/s" << std::endl;
+    std::cout << std::string(111, '-') << std::endl;
+    
+    try {
+        for (const std::string& provider : config.providers) {
+            bool provider_available = true;
+            
+            for (int threads : config.threads) {
+                std::vector<int> measured_seq_lens;
+                
+                for (int seq_len : config.seq_lens) {
+                    if (std::find(measured_seq_lens.begin(), measured_seq_lens.end(), seq_len) !=
+                        measured_seq_lens.end()) {
+                        continue;
+                    }
+                    
+                    GeneratorConfig gen_config(config.model_path);
+                    gen_config.precision = config.precision;
+                    gen_config.seq_len = seq_len;
+                    gen_config.num_threads = threads;
+                    gen_config.max_batch_size = max_batch;
+                    gen_config.use_io_binding = config.use_io_binding;
+                    gen_config.use_gpu = provider != "cpu";
+                    gen_config.use_tensorrt = provider == "tensorrt";
+                    
+                    // A model exported with a fixed length rejects every other one
+                    std::shared_ptr<ModelSession> model;
+                    try {
+                        model = std::make_shared<ModelSession>(gen_config);
+                    } catch (const std::runtime_error& e) {
+                        std::cout << "  seq_len " << seq_len << " skipped: " << e.what() << std::endl;
+                        continue;
+                    }
+                    
+                    // A fallback would only re-measure the CPU numbers under a GPU label
+                    if (provider != "cpu" && !model->onGpu()) {
+                        std::cout << "  " << provider << " unavailable, skipping" << std::endl;
+                        provider_available = false;
+                        break;
+                    }
+                    
+                    measured_seq_lens.push_back(seq_len);
+                    
+                    TrajectoryGenerator loader(model, gen_config);
+                    if (!loader.loadNormalization(config.norm_path)) {
+                        std::cerr << "Warning: Failed to load normalization, using defaults" << std::endl;
+                    }
+                    
+                    for (int batch_size : config.batch_sizes) {
+                        BenchResult r = runPoint(model, gen_config, loader.getNormalization(),
+                                                 batch_size, config);
+                        std::cout << std::setw(10) << r.provider << std::setw(8) << r.threads
+                                  << std::setw(8) << r.seq_len << std::setw(7) << r.batch_size
+                                  << std::setw(11) << r.sampling.mean << std::setw(11) << r.inference.mean
+                                  << std::setw(11) << r.postprocess.mean << std::setw(11) << r.metrics.mean
+                                  << std::setw(11) << r.total.p50 << std::setw(11) << r.total.p99
+                                  << std::setw(12) << std::setprecision(0) << r.throughput
+                                  << std::setprecision(3) << std::endl;
+                        results.push_back(r);
+                    }
+                }
+                if (provider_available && measured_seq_lens.empty()) {
+                    throw std::runtime_error("the model supports none of the requested seq_len values");
+                }
+                
+                if (!provider_available) break;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "\n❌ Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    std::cout << "\nStage columns are mean ms per call; p50/p99 are end-to-end." << std::endl;
+    
+    if (!writeReport(config.output_file, config, results)) {
+        return 1;
+    }
+    std::cout << "✓ Wrote " << results.size() << " results to " << config.output_file << std::endl;
+    
+    return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file trajectory_cache.cpp
+ * @brief Implementation of the LRU generation result cache
+ */
+
+#include "trajectory_cache.h"
+#include "trajectory_inference.h"
+#include "telemetry.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace trajectory {
+
+namespace {
+
+/**
+ * @brief Cache metrics, shared by all caches in the process
+ */
+struct CacheTelemetry {
+    TelemetryCounter& hits = TelemetryRegistry::global().counter(
+        "trajectory_cache_hits_total", "Result cache lookups served from the cache");
+    TelemetryCounter& misses = TelemetryRegistry::global().counter(
+        "trajectory_cache_misses_total", "Result cache lookups that had to generate");
+    TelemetryCounter& evictions = TelemetryRegistry::global().counter(
+        "trajectory_cache_evictions_total", "Entries evicted to stay under max_bytes");
+    TelemetryGauge& bytes = TelemetryRegistry::global().gauge(
+        "trajectory_cache_bytes", "Approximate memory held by result caches");
+};
+
+CacheTelemetry& cacheTelemetry() {
+    static CacheTelemetry telemetry;
+    return telemetry;
+}
+
+uint64_t mix(uint64_t h, uint64_t v) {
+    // splitmix64 finalizer over the running hash
+    h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h;
+}
+
+/**
+ * @brief Approximate heap footprint of one entry
+ */
+size_t entryBytes(const CachedResult& result) {
+    constexpr size_t kNodeOverhead = 128;  // list/map nodes, control block, Entry
+    return sizeof(CachedResult) + kNodeOverhead +
+           result.trajectories.capacity() * result.trajectories.stride() * sizeof(float) +
+           result.metrics.capacity() * sizeof(TrajectoryMetrics);
+}
+
+} // namespace
+
+size_t TrajectoryCache::KeyHash::operator()(const Key& key) const {
+    uint64_t h = key.seed;
+    for (int64_t c : key.cell) h = mix(h, static_cast<uint64_t>(c));
+    h = mix(h, static_cast<uint64_t>(key.n_samples));
+    h = mix(h, static_cast<uint64_t>(key.seq_len));
+    return static_cast<size_t>(h);
+}
+
+TrajectoryCache::TrajectoryCache(const TrajectoryCacheConfig& config)
+    : config_(config) {
+    if (!(config_.quantum > 0.0f)) {
+        throw std::runtime_error("TrajectoryCache: quantum must be > 0");
+    }
+}
+
+TrajectoryCache::~TrajectoryCache() {
+    clear();
+}
+
+TrajectoryCache::Key TrajectoryCache::makeKey(const TrajectoryGenerator& generator,
+                                              const Waypoint& start,
+                                              const Waypoint& end,
+                                              int n_samples) const {
+    const NormalizationParams& norm = generator.getNormalization();
+    const float values[6] = {start.x, start.y, start.z, end.x, end.y, end.z};
+    
+    Key key;
+    for (int i = 0; i < 6; ++i) {
+        const double normalized = (values[i] - norm.mean[i % 3]) / norm.std[i % 3];
+        key.cell[i] = std::llround(normalized / config_.quantum);
+    }
+    key.seed = generator.getSeed();
+    key.n_samples = n_samples;
+    key.seq_len = generator.getSeqLen();
+    return key;
+}
+
+std::shared_ptr<const CachedResult> TrajectoryCache::find(const Key& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        stats_.misses++;
+        if constexpr (kTelemetryEnabled) cacheTelemetry().misses.add();
+        return nullptr;
+    }
+    
+    lru_.splice(lru_.begin(), lru_, it->second);
+    stats_.hits++;
+    if constexpr (kTelemetryEnabled) cacheTelemetry().hits.add();
+    return it->second->result;
+}
+
+std::shared_ptr<const CachedResult> TrajectoryCache::insert(const Key& key,
+                                                            std::shared_ptr<const CachedResult> result) {
+    const size_t bytes = entryBytes(*result);
+    if (bytes > config_.max_bytes) return result;
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // Another thread generated the same key meanwhile: keep the stored one
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->result;
+    }
+    
+    lru_.push_front(Entry{key, result, bytes});
+    index_.emplace(key, lru_.begin());
+    stats_.bytes += bytes;
+    int64_t delta = static_cast<int64_t>(bytes);
+    
+    while (stats_.bytes > config_.max_bytes) {
+        const Entry& victim = lru_.back();
+        stats_.bytes -= victim.bytes;
+        delta -= static_cast<int64_t>(victim.bytes);
+        index_.erase(victim.key);
+        lru_.pop_back();
+        stats_.evictions++;
+        if constexpr (kTelemetryEnabled) cacheTelemetry().evictions.add();
+    }
+    stats_.entries = lru_.size();
+    
+    if constexpr (kTelemetryEnabled) cacheTelemetry().bytes.add(delta);
+    return result;
+}
+
+std::shared_ptr<const CachedResult> TrajectoryCache::lookup(const TrajectoryGenerator& generator,
+                                                            const Waypoint& start,
+                                                            const Waypoint& end,
+                                                            int n_samples) {
+    if (n_samples <= 0) return nullptr;
+    return find(makeKey(generator, start, end, n_samples));
+}
+
+std::shared_ptr<const CachedResult> TrajectoryCache::generate(TrajectoryGenerator& generator,
+                                                              const Waypoint& start,
+                                                              const Waypoint& end,
+                                                              int n_samples) {
+    if (n_samples <= 0) return std::make_shared<CachedResult>();
+    
+    // Non-finite coordinates have no cell; serve them uncached
+    const bool cacheable = std::isfinite(start.x) && std::isfinite(start.y) && std::isfinite(start.z) &&
+                           std::isfinite(end.x) && std::isfinite(end.y) && std::isfinite(end.z);
+    
+    Key key{};
+    if (cacheable) {
+        key = makeKey(generator, start, end, n_samples);
+        if (auto hit = find(key)) return hit;
+    }
+    
+    // Latents depend on (seed, request id); deriving the id from the key
+    // makes a regenerated entry identical to the evicted one
+    uint64_t request_id = cacheable ? static_cast<uint64_t>(KeyHash()(key)) : kAutoRequestId;
+    if (cacheable && request_id == kAutoRequestId) request_id ^= 1;
+    
+    auto result = std::make_shared<CachedResult>();
+    GenerationRequest request(start, end, n_samples, request_id);
+    generator.generateBatch(&request, 1, result->trajectories);
+    result->metrics = evaluateTrajectories(result->trajectories, end);
+    
+    if (!cacheable) return result;
+    return insert(key, std::move(result));
+}
+
+void TrajectoryCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if constexpr (kTelemetryEnabled) {
+        cacheTelemetry().bytes.add(-static_cast<int64_t>(stats_.bytes));
+    }
+    lru_.clear();
+    index_.clear();
+    stats_.entries = 0;
+    stats_.bytes = 0;
+}
+
+TrajectoryCacheStats TrajectoryCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace trajectory
@@ -0,0 +1,149 @@
+/**
+ * @file trajectory_cache.h
+ * @brief LRU result cache for repeated (start, end) queries
+ * @author Mission Planner Team
+ * 
+ * Operators and route previews ask for the same or nearly the same
+ * start/end pairs over and over. TrajectoryCache sits in front of a
+ * TrajectoryGenerator and keys results on the normalized start/end
+ * (quantized), the generator seed and the sample count; a hit returns
+ * the stored trajectories and metrics without touching ONNX Runtime.
+ */
+
+#ifndef TRAJECTORY_CACHE_H
+#define TRAJECTORY_CACHE_H
+
+#include "trajectory_batch.h"
+#include "trajectory_metrics.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace trajectory {
+
+/**
+ * @brief Cache sizing and key resolution
+ */
+struct TrajectoryCacheConfig {
+    float quantum = 1e-3f;          // Key resolution in normalized units (std devs)
+    size_t max_bytes = 64u << 20;   // Evict least recently used entries beyond this
+};
+
+/**
+ * @brief One cached query result (immutable, shared with callers)
+ */
+struct CachedResult {
+    TrajectoryBatch trajectories;             // n_samples rows
+    std::vector<TrajectoryMetrics> metrics;   // Per row, against the query end
+};
+
+/**
+ * @brief Hit/miss counters and occupancy
+ */
+struct TrajectoryCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+    
+    double hitRate() const {
+        const uint64_t lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / lookups : 0.0;
+    }
+};
+
+/**
+ * @brief Thread-safe LRU cache of generation results
+ * 
+ * A miss generates with a request id derived from the key, so a query
+ * that was evicted and generated again gets the same trajectories back.
+ * Queries whose start and end fall in the same quantization cell share
+ * one entry, generated from whichever of them missed first. Concurrent
+ * misses on the same key may both generate; the first stored is kept.
+ * Use one cache per model and normalization.
+ */
+class TrajectoryCache {
+public:
+    explicit TrajectoryCache(const TrajectoryCacheConfig& config = TrajectoryCacheConfig());
+    ~TrajectoryCache();
+    
+    TrajectoryCache(const TrajectoryCache&) = delete;
+    TrajectoryCache& operator=(const TrajectoryCache&) = delete;
+    
+    /**
+     * @brief Cached result for the query, generating it on a miss
+     * 
+     * The lock is not held during generation, so one cache can front
+     * several generators (e.g. a GeneratorPool's).
+     * 
+     * @param generator Generator used on a miss
+     * @param start Starting waypoint
+     * @param end Ending waypoint
+     * @param n_samples Number of trajectories
+     * @return Shared, immutable result (valid after eviction)
+     */
+    std::shared_ptr<const CachedResult> generate(TrajectoryGenerator& generator,
+                                                 const Waypoint& start,
+                                                 const Waypoint& end,
+                                                 int n_samples);
+    
+    /**
+     * @brief Cached result, or nullptr (counts as a hit or miss)
+     */
+    std::shared_ptr<const CachedResult> lookup(const TrajectoryGenerator& generator,
+                                               const Waypoint& start,
+                                               const Waypoint& end,
+                                               int n_samples);
+    
+    /**
+     * @brief Drop every entry (counters are kept)
+     */
+    void clear();
+    
+    TrajectoryCacheStats stats() const;
+    const TrajectoryCacheConfig& getConfig() const { return config_; }
+
+private:
+    struct Key {
+        std::array<int64_t, 6> cell;  // Quantized normalized start and end
+        uint64_t seed;
+        int n_samples;
+        int seq_len;
+        
+        bool operator==(const Key& other) const {
+            return cell == other.cell && seed == other.seed &&
+                   n_samples == other.n_samples && seq_len == other.seq_len;
+        }
+    };
+    
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    
+    struct Entry {
+        Key key;
+        std::shared_ptr<const CachedResult> result;
+        size_t bytes;
+    };
+    
+    Key makeKey(const TrajectoryGenerator& generator, const Waypoint& start,
+                const Waypoint& end, int n_samples) const;
+    std::shared_ptr<const CachedResult> find(const Key& key);
+    std::shared_ptr<const CachedResult> insert(const Key& key, std::shared_ptr<const CachedResult> result);
+    
+    TrajectoryCacheConfig config_;
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;   // Most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+    TrajectoryCacheStats stats_;
+};
+
+} // namespace trajectory
+
+#endif // TRAJECTORY_CACHE_H
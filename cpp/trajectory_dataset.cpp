@@ -0,0 +1,120 @@
+/**
+ * @file trajectory_dataset.cpp
+ * @brief Implementation of chunked dataset evaluation
+ */
+
+#include "trajectory_dataset.h"
+#include <algorithm>
+#include <limits>
+
+namespace trajectory {
+
+namespace {
+
+/**
+ * @brief Metrics of one chunk, scored against its records' expected ends
+ */
+void evaluateChunk(const TrajectoryChunk& chunk, bool fast_acos, std::vector<Waypoint>& ends,
+                   TrajectoryMetrics* results) {
+    ends.resize(chunk.count);
+    for (size_t i = 0; i < chunk.count; ++i) {
+        ends[i] = chunk.infos ? chunk.infos[i].end : chunk[i].back();
+    }
+    evaluateTrajectories(chunk.rows, chunk.count, chunk.seq_len, ends.data(), results, fast_acos);
+}
+
+/**
+ * @brief Per-chunk partial sums for summarizeDataset()
+ */
+struct ChunkTotals {
+    double path_length = 0.0;
+    double efficiency = 0.0;
+    double smoothness = 0.0;
+    double endpoint_error = 0.0;
+    double score = 0.0;
+    float max_endpoint_error = 0.0f;
+    float max_curvature = 0.0f;
+    float min_altitude = std::numeric_limits<float>::max();
+    float max_altitude = std::numeric_limits<float>::lowest();
+};
+
+size_t chunkRows(const DatasetEvalOptions& options) {
+    return std::max<size_t>(options.chunk_rows, 1);
+}
+
+} // namespace
+
+void evaluateDataset(const TrajectoryReader& reader, TrajectoryMetrics* results,
+                     const DatasetEvalOptions& options) {
+    reader.forEachChunk(chunkRows(options), [&](const TrajectoryChunk& chunk) {
+        std::vector<Waypoint> ends;
+        evaluateChunk(chunk, options.fast_acos, ends, results + chunk.first);
+    }, options.parallel);
+}
+
+std::vector<TrajectoryMetrics> evaluateDataset(const TrajectoryReader& reader,
+                                               const DatasetEvalOptions& options) {
+    std::vector<TrajectoryMetrics> results(reader.size());
+    evaluateDataset(reader, results.data(), options);
+    return results;
+}
+
+DatasetSummary summarizeDataset(const TrajectoryReader& reader, const DatasetEvalOptions& options,
+                                const TrajectoryScorer& scorer) {
+    DatasetSummary summary;
+    summary.trajectories = reader.size();
+    if (reader.empty()) return summary;
+    
+    const size_t chunk_rows = chunkRows(options);
+    std::vector<ChunkTotals> totals(reader.numChunks(chunk_rows));
+    
+    reader.forEachChunk(chunk_rows, [&](const TrajectoryChunk& chunk) {
+        std::vector<Waypoint> ends;
+        std::vector<TrajectoryMetrics> metrics(chunk.count);
+        evaluateChunk(chunk, options.fast_acos, ends, metrics.data());
+        
+        ChunkTotals& t = totals[chunk.index];
+        for (const TrajectoryMetrics& m : metrics) {
+            t.path_length += m.path_length;
+            t.efficiency += m.path_efficiency;
+            t.smoothness += m.smoothness_score;
+            t.endpoint_error += m.endpoint_error;
+            t.max_endpoint_error = std::max(t.max_endpoint_error, m.endpoint_error);
+            t.max_curvature = std::max(t.max_curvature, m.max_curvature);
+            t.min_altitude = std::min(t.min_altitude, m.min_altitude);
+            t.max_altitude = std::max(t.max_altitude, m.max_altitude);
+            if (scorer) {
+                t.score += scorer(m);
+            }
+        }
+    }, options.parallel);
+    
+    // Combine in chunk order so the sums do not depend on scheduling
+    ChunkTotals all;
+    for (const ChunkTotals& t : totals) {
+        all.path_length += t.path_length;
+        all.efficiency += t.efficiency;
+        all.smoothness += t.smoothness;
+        all.endpoint_error += t.endpoint_error;
+        all.score += t.score;
+        all.max_endpoint_error = std::max(all.max_endpoint_error, t.max_endpoint_error);
+        all.max_curvature = std::max(all.max_curvature, t.max_curvature);
+        all.min_altitude = std::min(all.min_altitude, t.min_altitude);
+        all.max_altitude = std::max(all.max_altitude, t.max_altitude);
+    }
+    
+    const double inv_n = 1.0 / static_cast<double>(summary.trajectories);
+    summary.mean_path_length = static_cast<float>(all.path_length * inv_n);
+    summary.mean_efficiency = static_cast<float>(all.efficiency * inv_n);
+    summary.mean_smoothness = static_cast<float>(all.smoothness * inv_n);
+    summary.mean_endpoint_error = static_cast<float>(all.endpoint_error * inv_n);
+    summary.mean_score = static_cast<float>(all.score * inv_n);
+    summary.max_endpoint_error = all.max_endpoint_error;
+    summary.max_curvature = all.max_curvature;
+    summary.min_altitude = all.min_altitude;
+    summary.max_altitude = all.max_altitude;
+    
+    return summary;
+}
+
+} // namespace trajectory
@@ -0,0 +1,81 @@
+/**
+ * @file trajectory_dataset.h
+ * @brief Chunked, parallel evaluation of stored trajectory archives
+ * @author Mission Planner Team
+ * 
+ * Runs the batch metrics over a memory-mapped TrajectoryReader file in
+ * chunks, straight from the mapping, so regression scoring of a full
+ * archive never loads it into RAM. Expected ends come from each record's
+ * info; recovered files (no record info) use each trajectory's own last
+ * waypoint, so their endpoint error is zero.
+ */
+
+#ifndef TRAJECTORY_DATASET_H
+#define TRAJECTORY_DATASET_H
+
+#include "trajectory_io.h"
+#include "trajectory_metrics.h"
+#include "trajectory_ranking.h"
+#include <cstddef>
+#include <vector>
+
+namespace trajectory {
+
+/**
+ * @brief Options for evaluateDataset() and summarizeDataset()
+ */
+struct DatasetEvalOptions {
+    size_t chunk_rows = 4096;    // Rows per chunk (one task each)
+    bool parallel = true;        // Spread chunks over ThreadPool::shared()
+    bool fast_acos = false;      // Use fastAcos() for the curvature angles
+};
+
+/**
+ * @brief Aggregate metrics over a dataset
+ */
+struct DatasetSummary {
+    size_t trajectories = 0;
+    float mean_path_length = 0.0f;      // m
+    float mean_efficiency = 0.0f;
+    float mean_smoothness = 0.0f;
+    float mean_endpoint_error = 0.0f;   // m
+    float max_endpoint_error = 0.0f;    // m
+    float max_curvature = 0.0f;         // rad/m, worst single trajectory
+    float min_altitude = 0.0f;          // m, lowest waypoint
+    float max_altitude = 0.0f;          // m, highest waypoint
+    float mean_score = 0.0f;            // Mean scorer output (0 without a scorer)
+};
+
+/**
+ * @brief Evaluate every trajectory of a dataset
+ * @param reader Open dataset
+ * @param results Receives reader.size() metrics, in file order
+ * @param options Chunking and threading
+ */
+void evaluateDataset(const TrajectoryReader& reader, TrajectoryMetrics* results,
+                     const DatasetEvalOptions& options = DatasetEvalOptions());
+
+/**
+ * @brief Evaluate every trajectory of a dataset
+ * @return Metrics in file order
+ */
+std::vector<TrajectoryMetrics> evaluateDataset(const TrajectoryReader& reader,
+                                               const DatasetEvalOptions& options = DatasetEvalOptions());
+
+/**
+ * @brief Aggregate metrics over a dataset without storing per-row results
+ * 
+ * Partial sums are kept per chunk and combined in chunk order, so the
+ * result does not depend on the thread count.
+ * 
+ * @param reader Open dataset
+ * @param options Chunking and threading
+ * @param scorer Optional quality score to average (e.g. RankingEngine::weightedScorer())
+ */
+DatasetSummary summarizeDataset(const TrajectoryReader& reader,
+                                const DatasetEvalOptions& options = DatasetEvalOptions(),
+                                const TrajectoryScorer& scorer = TrajectoryScorer());
+
+} // namespace trajectory
+
+#endif // TRAJECTORY_DATASET_H
@@ -0,0 +1,254 @@
+/**
+ * @file trajectory_diversity.cpp
+ * @brief Implementation of exact, sampled and sketched diversity
+ */
+
+#include "trajectory_diversity.h"
+#include "trajectory_batch.h"
+#include "trajectory_kernels.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace trajectory {
+
+namespace {
+
+/**
+ * @brief Mean waypoint distance between two rows
+ */
+double pairDistance(const float* a, const float* b, int seq_len) {
+    float distance = 0.0f;
+    
+    for (int k = 0; k < seq_len; ++k) {
+        float dx = a[k * 3 + 0] - b[k * 3 + 0];
+        float dy = a[k * 3 + 1] - b[k * 3 + 1];
+        float dz = a[k * 3 + 2] - b[k * 3 + 2];
+        distance += std::sqrt(dx*dx + dy*dy + dz*dz);
+    }
+    
+    return distance / seq_len;
+}
+
+void runChunks(bool parallel, size_t n, size_t grain,
+               const std::function<void(size_t, size_t)>& body) {
+    if (parallel && n > 1) {
+        ThreadPool::shared().parallelFor(0, n, grain, body);
+    } else {
+        body(0, n);
+    }
+}
+
+/**
+ * @brief Sum of per-pair mean distances over all i < j, tiled
+ * 
+ * The pair matrix is cut into tile_size x tile_size tiles (only I <= J),
+ * so both operands of a tile stay in L2 while its pairs are evaluated.
+ * Per-tile sums are reduced in a fixed order for reproducibility.
+ */
+double tiledDistanceSum(const float* rows, size_t n, int seq_len,
+                        size_t tile_size, bool parallel) {
+    const size_t stride = static_cast<size_t>(seq_len) * 3;
+    const size_t n_tiles = (n + tile_size - 1) / tile_size;
+    
+    std::vector<std::pair<size_t, size_t>> tiles;
+    tiles.reserve(n_tiles * (n_tiles + 1) / 2);
+    for (size_t ti = 0; ti < n_tiles; ++ti) {
+        for (size_t tj = ti; tj < n_tiles; ++tj) {
+            tiles.push_back({ti, tj});
+        }
+    }
+    
+    std::vector<double> tile_sums(tiles.size(), 0.0);
+    
+    runChunks(parallel, tiles.size(), 1, [&](size_t first, size_t last) {
+        for (size_t t = first; t < last; ++t) {
+            const size_t a0 = tiles[t].first * tile_size;
+            const size_t b0 = tiles[t].second * tile_size;
+            const size_t n_a = std::min(tile_size, n - a0);
+            const size_t n_b = std::min(tile_size, n - b0);
+            
+            if (a0 == b0) {
+                tile_sums[t] = kernelPairwiseDistanceSum(rows + a0 * stride, n_a, seq_len);
+            } else {
+                tile_sums[t] = kernelCrossDistanceSum(rows + a0 * stride, n_a,
+                                                      rows + b0 * stride, n_b, seq_len);
+            }
+        }
+    });
+    
+    double total = 0.0;
+    for (double sum : tile_sums) {
+        total += sum;
+    }
+    return total;
+}
+
+// Samples per independently seeded group. Each group has its own
+// generator, so drawn pairs do not depend on how work is split across threads.
+constexpr size_t kSampleGroup = 1024;
+
+/**
+ * @brief Uniform random pairs (i != j) for one sample group
+ */
+struct PairSampler {
+    std::mt19937_64 rng;
+    std::uniform_int_distribution<size_t> first;
+    std::uniform_int_distribution<size_t> second;
+    
+    PairSampler(uint64_t seed, size_t group, size_t n)
+        : rng(seed + 0x9e3779b97f4a7c15ULL * (group + 1)), first(0, n - 1), second(0, n - 2) {}
+    
+    std::pair<size_t, size_t> next() {
+        size_t i = first(rng);
+        size_t j = second(rng);
+        if (j >= i) ++j;
+        return {i, j};
+    }
+};
+
+/**
+ * @brief Mean and standard error of f(i, j) over sampled pairs
+ */
+template <class PairFn>
+void samplePairs(size_t n, size_t n_samples, uint64_t seed, bool parallel,
+                 PairFn f, double& mean, double& std_error) {
+    const size_t n_groups = (n_samples + kSampleGroup - 1) / kSampleGroup;
+    std::vector<double> sums(n_groups, 0.0);
+    std::vector<double> sums_sq(n_groups, 0.0);
+    
+    runChunks(parallel, n_groups, 1, [&](size_t first, size_t last) {
+        for (size_t g = first; g < last; ++g) {
+            PairSampler sampler(seed, g, n);
+            const size_t count = std::min(kSampleGroup, n_samples - g * kSampleGroup);
+            
+            for (size_t s = 0; s < count; ++s) {
+                auto pair = sampler.next();
+                double value = f(pair.first, pair.second);
+                sums[g] += value;
+                sums_sq[g] += value * value;
+            }
+        }
+    });
+    
+    double sum = 0.0, sum_sq = 0.0;
+    for (size_t g = 0; g < n_groups; ++g) {
+        sum += sums[g];
+        sum_sq += sums_sq[g];
+    }
+    
+    mean = sum / n_samples;
+    double variance = (n_samples > 1)
+        ? std::max(0.0, (sum_sq - n_samples * mean * mean) / (n_samples - 1))
+        : 0.0;
+    std_error = std::sqrt(variance / n_samples);
+}
+
+DiversityResult exactDiversity(const TrajectoryBatch& batch, const DiversityOptions& options) {
+    DiversityResult result;
+    
+    const size_t n = batch.size();
+    const double n_pairs = 0.5 * static_cast<double>(n) * (n - 1);
+    const size_t tile_size = std::max<size_t>(1, options.tile_size);
+    
+    double total = tiledDistanceSum(batch.data(), n, batch.seqLen(), tile_size, options.parallel);
+    
+    result.diversity = static_cast<float>(total / n_pairs);
+    result.pairs_evaluated = n * (n - 1) / 2;
+    return result;
+}
+
+DiversityResult sampledDiversity(const TrajectoryBatch& batch, const DiversityOptions& options) {
+    DiversityResult result;
+    
+    const int seq_len = batch.seqLen();
+    double mean = 0.0, std_error = 0.0;
+    
+    samplePairs(batch.size(), options.max_pairs, options.seed, options.parallel,
+                [&](size_t i, size_t j) { return pairDistance(batch.row(i), batch.row(j), seq_len); },
+                mean, std_error);
+    
+    result.diversity = static_cast<float>(mean);
+    result.error_estimate = static_cast<float>(std_error);
+    result.pairs_evaluated = options.max_pairs;
+    result.exact = false;
+    return result;
+}
+
+DiversityResult sketchDiversity(const TrajectoryBatch& batch, const DiversityOptions& options) {
+    DiversityResult result;
+    
+    const size_t n = batch.size();
+    const int seq_len = batch.seqLen();
+    const int sketch_len = std::max(2, options.sketch_points);
+    
+    // Uniformly spaced waypoints, always keeping both endpoints
+    std::vector<int> picks(sketch_len);
+    for (int k = 0; k < sketch_len; ++k) {
+        picks[k] = static_cast<int>(std::lround(static_cast<double>(k) * (seq_len - 1) / (sketch_len - 1)));
+    }
+    
+    TrajectoryBatch sketch(sketch_len, n);
+    float* dst = sketch.appendRows(n);
+    for (size_t i = 0; i < n; ++i) {
+        const float* src = batch.row(i);
+        for (int k = 0; k < sketch_len; ++k) {
+            std::copy(src + picks[k] * 3, src + picks[k] * 3 + 3, dst + (i * sketch_len + k) * 3);
+        }
+    }
+    
+    const double n_pairs = 0.5 * static_cast<double>(n) * (n - 1);
+    const size_t tile_size = std::max<size_t>(1, options.tile_size);
+    double sketch_mean = tiledDistanceSum(sketch.data(), n, sketch_len, tile_size,
+                                          options.parallel) / n_pairs;
+    
+    // Control variate: correct the sketch by the mean full-minus-sketch
+    // difference on sampled pairs; its standard error is the estimate
+    const size_t n_calibration = std::max<size_t>(2, options.calibration_pairs);
+    double bias = 0.0, std_error = 0.0;
+    
+    samplePairs(n, n_calibration, options.seed, options.parallel,
+                [&](size_t i, size_t j) {
+                    return pairDistance(batch.row(i), batch.row(j), seq_len)
+                         - pairDistance(sketch.row(i), sketch.row(j), sketch_len);
+                },
+                bias, std_error);
+    
+    result.diversity = static_cast<float>(sketch_mean + bias);
+    result.error_estimate = static_cast<float>(std_error);
+    result.pairs_evaluated = n_calibration;
+    result.exact = false;
+    return result;
+}
+
+} // namespace
+
+DiversityResult computeDiversity(const TrajectoryBatch& batch, const DiversityOptions& options) {
+    const size_t n = batch.size();
+    
+    if (n < 2 || batch.seqLen() < 1) return DiversityResult();
+    
+    const size_t total_pairs = n * (n - 1) / 2;
+    
+    switch (options.mode) {
+        case DiversityMode::Sampled:
+            if (options.max_pairs > 0 && options.max_pairs < total_pairs) {
+                return sampledDiversity(batch, options);
+            }
+            break;
+        case DiversityMode::Sketch:
+            if (std::max(2, options.sketch_points) < batch.seqLen()) {
+                return sketchDiversity(batch, options);
+            }
+            break;
+        default:
+            break;
+    }
+    
+    return exactDiversity(batch, options);
+}
+
+} // namespace trajectory
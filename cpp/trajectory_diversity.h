@@ -0,0 +1,74 @@
+/**
+ * @file trajectory_diversity.h
+ * @brief Exact and approximate batch diversity for online selection
+ * @author Mission Planner Team
+ * 
+ * Diversity is the average pairwise mean-waypoint distance used by
+ * computeDiversity(). All-pairs is O(N² · seq_len); at 1000 candidates
+ * that is ~500k trajectory comparisons, too slow for a selection gate.
+ * This module offers three modes:
+ * 
+ *   Exact   - cache-tiled all-pairs over the thread pool
+ *   Sampled - mean over random pairs, with a standard-error estimate
+ *   Sketch  - all pairs on downsampled trajectories, bias-corrected on
+ *             a calibration sample of full-resolution pairs
+ */
+
+#ifndef TRAJECTORY_DIVERSITY_H
+#define TRAJECTORY_DIVERSITY_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace trajectory {
+
+class TrajectoryBatch;
+
+/**
+ * @brief Diversity computation strategy
+ */
+enum class DiversityMode {
+    Exact,
+    Sampled,
+    Sketch
+};
+
+/**
+ * @brief Options for computeDiversity(batch, options)
+ */
+struct DiversityOptions {
+    DiversityMode mode = DiversityMode::Exact;
+    bool parallel = true;            // Spread work over ThreadPool::shared()
+    size_t tile_size = 64;           // Exact/Sketch: rows per cache tile
+    size_t max_pairs = 20000;        // Sampled: random pairs to evaluate
+    int sketch_points = 10;          // Sketch: waypoints kept per trajectory
+    size_t calibration_pairs = 256;  // Sketch: full-resolution pairs for bias correction
+    uint64_t seed = 0x5eed;          // Sampled/Sketch: pair sampling seed
+};
+
+/**
+ * @brief Diversity value with its accuracy
+ */
+struct DiversityResult {
+    float diversity = 0.0f;        // Average pairwise distance (m)
+    float error_estimate = 0.0f;   // 1σ error of diversity (0 when exact)
+    size_t pairs_evaluated = 0;    // Full-resolution pair distances computed
+    bool exact = true;             // True if every pair was evaluated exactly
+};
+
+/**
+ * @brief Compute batch diversity with the selected strategy
+ * 
+ * Sampled and Sketch fall back to Exact when they would not save work
+ * (max_pairs >= N(N-1)/2, or sketch_points >= seq_len). Results are
+ * deterministic for a given seed, independent of thread count.
+ * 
+ * @param batch Trajectories to compare
+ * @param options Strategy and tuning
+ * @return Diversity and error estimate
+ */
+DiversityResult computeDiversity(const TrajectoryBatch& batch, const DiversityOptions& options);
+
+} // namespace trajectory
+
+#endif // TRAJECTORY_DIVERSITY_H
@@ -0,0 +1,175 @@
+/**
+ * @file trajectory_filter.cpp
+ * @brief Implementation of constraint filtering and the valid-candidate search
+ */
+
+#include "trajectory_filter.h"
+#include "trajectory_batch.h"
+#include "trajectory_metrics.h"
+#include "obstacle_map.h"
+#include "thread_pool.h"
+#include "telemetry.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace trajectory {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Altitude window on raw rows: z only, exits at the first violation
+ */
+bool altitudeOk(const float* xyz, size_t n, float min_altitude, float max_altitude) {
+    for (size_t i = 0; i < n; ++i) {
+        const float z = xyz[i * 3 + 2];
+        if (!(z >= min_altitude && z <= max_altitude)) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Curvature limit over each interior waypoint
+ */
+bool curvatureOk(const float* xyz, size_t n, float max_curvature) {
+    if (n < 3) return true;
+    
+    float v1[3] = {xyz[3] - xyz[0], xyz[4] - xyz[1], xyz[5] - xyz[2]};
+    float norm1 = std::sqrt(v1[0]*v1[0] + v1[1]*v1[1] + v1[2]*v1[2]);
+    
+    for (size_t i = 2; i < n; ++i) {
+        const float* p = xyz + i * 3;
+        const float v2[3] = {p[0] - p[-3], p[1] - p[-2], p[2] - p[-1]};
+        const float norm2 = std::sqrt(v2[0]*v2[0] + v2[1]*v2[1] + v2[2]*v2[2]);
+        
+        float curvature;
+        if (turnCurvature(v1, norm1, v2, norm2, curvature) && curvature > max_curvature) {
+            return false;
+        }
+        
+        v1[0] = v2[0];
+        v1[1] = v2[1];
+        v1[2] = v2[2];
+        norm1 = norm2;
+    }
+    return true;
+}
+
+} // namespace
+
+ConstraintFailure checkConstraints(const TrajectoryView& trajectory,
+                                   const TrajectoryConstraints& constraints) {
+    if (trajectory.empty() ||
+        !altitudeOk(trajectory.xyz, trajectory.size(), constraints.min_altitude,
+                    constraints.max_altitude)) {
+        return ConstraintFailure::Altitude;
+    }
+    if (!curvatureOk(trajectory.xyz, trajectory.size(), constraints.max_curvature)) {
+        return ConstraintFailure::Curvature;
+    }
+    if (constraints.obstacles && !constraints.obstacles->isClear(trajectory)) {
+        return ConstraintFailure::Obstacle;
+    }
+    return ConstraintFailure::None;
+}
+
+FilterStats filterBatch(TrajectoryBatch& batch,
+                        const TrajectoryConstraints& constraints,
+                        size_t first_row,
+                        bool parallel) {
+    static TelemetryHistogram* const filtering_time = stageHistogram("filtering");
+    ScopedTimer timer(filtering_time);
+    
+    FilterStats stats;
+    if (first_row >= batch.size()) return stats;
+    
+    const size_t n = batch.size() - first_row;
+    std::vector<ConstraintFailure> failures(n);
+    auto body = [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            failures[i] = checkConstraints(batch.view(first_row + i), constraints);
+        }
+    };
+    if (parallel && n > 1) {
+        ThreadPool::shared().parallelFor(0, n, 8, body);
+    } else {
+        body(0, n);
+    }
+    
+    // Stable compaction within the buffer
+    const size_t stride = batch.stride();
+    size_t kept = first_row;
+    for (size_t i = 0; i < n; ++i) {
+        switch (failures[i]) {
+            case ConstraintFailure::None:
+                if (kept != first_row + i) {
+                    std::memcpy(batch.row(kept), batch.row(first_row + i), stride * sizeof(float));
+                }
+                ++kept;
+                break;
+            case ConstraintFailure::Altitude: ++stats.rejected_altitude; break;
+            case ConstraintFailure::Curvature: ++stats.rejected_curvature; break;
+            case ConstraintFailure::Obstacle: ++stats.rejected_obstacle; break;
+        }
+    }
+    stats.checked = n;
+    batch.truncate(kept);
+    return stats;
+}
+
+ValidSearchResult generateValid(TrajectoryGenerator& generator,
+                                const Waypoint& start,
+                                const Waypoint& end,
+                                const TrajectoryConstraints& constraints,
+                                const ValidSearchOptions& options,
+                                TrajectoryBatch& out) {
+    const auto search_start = Clock::now();
+    const auto deadline = search_start + options.deadline;
+    
+    ValidSearchResult result;
+    const size_t base = out.size();
+    const int max_rows = options.rows_per_run > 0 ? options.rows_per_run
+                                                  : generator.getMaxBatchSize();
+    
+    while (result.valid < options.target && result.generated < options.max_candidates) {
+        // Size the run to what is still needed at the observed acceptance
+        // rate (with some headroom), once there is a rate to go by
+        size_t rows = static_cast<size_t>(max_rows);
+        const size_t passed = result.generated - result.stats.rejected();
+        if (passed > 0) {
+            const double rate = static_cast<double>(passed) / result.generated;
+            const double needed = (options.target - result.valid) / rate * 1.25;
+            rows = std::min(rows, static_cast<size_t>(std::ceil(needed)));
+        }
+        rows = std::max<size_t>(1, std::min(rows, options.max_candidates - result.generated));
+        
+        const size_t first_row = out.size();
+        generator.generateMultiple(start, end, static_cast<int>(rows), out);
+        
+        const FilterStats stats = filterBatch(out, constraints, first_row, options.parallel);
+        result.generated += rows;
+        result.runs += 1;
+        result.stats.checked += stats.checked;
+        result.stats.rejected_altitude += stats.rejected_altitude;
+        result.stats.rejected_curvature += stats.rejected_curvature;
+        result.stats.rejected_obstacle += stats.rejected_obstacle;
+        result.valid = out.size() - base;
+        
+        if (Clock::now() >= deadline) break;
+    }
+    
+    // Keep exactly the target when the last run overshot it
+    if (result.valid > options.target) {
+        out.truncate(base + options.target);
+        result.valid = options.target;
+    }
+    
+    result.reached_target = result.valid >= options.target;
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - search_start).count();
+    return result;
+}
+
+} // namespace trajectory
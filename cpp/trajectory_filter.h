@@ -0,0 +1,144 @@
+/**
+ * @file trajectory_filter.h
+ * @brief Early-reject constraint filtering and generate-until-valid search
+ * @author Mission Planner Team
+ * 
+ * Generating a fixed number of candidates and validating them afterwards
+ * gives no bound on how many valid ones come back. This module checks
+ * curvature, the altitude window and obstacle clearance on batch rows
+ * right after denormalization, compacts the survivors in place (nothing
+ * is copied into Trajectory objects), and keeps running batches until K
+ * valid candidates are found or a deadline passes.
+ */
+
+#ifndef TRAJECTORY_FILTER_H
+#define TRAJECTORY_FILTER_H
+
+#include "trajectory_inference.h"
+#include <chrono>
+#include <cstddef>
+
+namespace trajectory {
+
+class ObstacleMap;
+
+/**
+ * @brief Limits a candidate must satisfy (as in isTrajectoryValid)
+ */
+struct TrajectoryConstraints {
+    float max_curvature = 0.1f;             // Maximum allowed curvature (rad/m)
+    float min_altitude = 50.0f;             // Minimum allowed altitude (m)
+    float max_altitude = 1000.0f;           // Maximum allowed altitude (m)
+    const ObstacleMap* obstacles = nullptr; // Optional clearance check (not owned)
+};
+
+/**
+ * @brief First constraint a trajectory failed
+ */
+enum class ConstraintFailure {
+    None,
+    Altitude,
+    Curvature,
+    Obstacle
+};
+
+/**
+ * @brief Check one trajectory, cheapest test first, stopping at the first failure
+ * 
+ * Agrees with isTrajectoryValid() (plus ObstacleMap clearance when
+ * constraints.obstacles is set). Empty trajectories fail on altitude.
+ * 
+ * @param trajectory Input trajectory
+ * @param constraints Limits to check
+ * @return ConstraintFailure::None if every constraint holds
+ */
+ConstraintFailure checkConstraints(const TrajectoryView& trajectory,
+                                   const TrajectoryConstraints& constraints);
+
+/**
+ * @brief Rejections by reason
+ */
+struct FilterStats {
+    size_t checked = 0;
+    size_t rejected_altitude = 0;
+    size_t rejected_curvature = 0;
+    size_t rejected_obstacle = 0;
+    
+    size_t rejected() const { return rejected_altitude + rejected_curvature + rejected_obstacle; }
+};
+
+/**
+ * @brief Drop rows that violate the constraints, keeping the rest in order
+ * 
+ * Rows [first_row, size) are checked and the passing ones are moved down
+ * within the batch buffer; rows before first_row are left untouched.
+ * 
+ * @param batch Batch to filter in place
+ * @param constraints Limits to check
+ * @param first_row First row to check
+ * @param parallel Spread the checks over ThreadPool::shared()
+ * @return Counts for the checked rows
+ */
+FilterStats filterBatch(TrajectoryBatch& batch,
+                        const TrajectoryConstraints& constraints,
+                        size_t first_row = 0,
+                        bool parallel = true);
+
+/**
+ * @brief Stopping rules for generateValid()
+ */
+struct ValidSearchOptions {
+    size_t target = 5;                          // Valid candidates wanted
+    std::chrono::microseconds deadline{100000}; // Wall-clock budget (checked between runs)
+    size_t max_candidates = 10000;              // Give up after generating this many
+    int rows_per_run = 0;                       // Rows per session run (0 = max_batch_size)
+    bool parallel = true;                       // Parallel constraint checks
+};
+
+/**
+ * @brief Outcome of generateValid()
+ */
+struct ValidSearchResult {
+    size_t valid = 0;          // Rows appended to the output batch
+    size_t generated = 0;      // Candidates generated in total
+    size_t runs = 0;           // Session runs
+    FilterStats stats;         // Rejections by reason
+    double elapsed_ms = 0.0;
+    bool reached_target = false;
+    
+    /**
+     * @brief Fraction of generated candidates that passed
+     */
+    float acceptanceRate() const {
+        return generated ? static_cast<float>(generated - stats.rejected()) / generated : 0.0f;
+    }
+};
+
+/**
+ * @brief Generate batches until options.target valid candidates are found
+ * 
+ * Each run generates fresh samples (a new request id), filters them
+ * straight after denormalization and appends the survivors to out; once
+ * the acceptance rate is known, later runs are shrunk to roughly what is
+ * still needed. Stops at the target (surplus valid rows are dropped), at
+ * max_candidates, or when the deadline has passed — inference is not
+ * interrupted, so the deadline can be overrun by at most one run.
+ * 
+ * @param generator Generator to sample from
+ * @param start Starting waypoint
+ * @param end Ending waypoint
+ * @param constraints Limits every returned candidate satisfies
+ * @param options Target and budgets
+ * @param out Output batch (valid rows appended)
+ * @return Counts and timing
+ */
+ValidSearchResult generateValid(TrajectoryGenerator& generator,
+                                const Waypoint& start,
+                                const Waypoint& end,
+                                const TrajectoryConstraints& constraints,
+                                const ValidSearchOptions& options,
+                                TrajectoryBatch& out);
+
+} // namespace trajectory
+
+#endif // TRAJECTORY_FILTER_H
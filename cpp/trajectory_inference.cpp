@@ -4,116 +4,693 @@
  */
 
 #include "trajectory_inference.h"
+#include "trajectory_batch.h"
+#include "telemetry.h"
+#include "json_value.h"
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <cmath>
 #include <random>
 #include <stdexcept>
 #include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
 #include <numeric>
 
-// JSON parsing (simple implementation for normalization params)
-#include <regex>
-
 namespace trajectory {
 
-// Helper function to parse simple JSON (for normalization params)
-static NormalizationParams parseNormalizationJSON(const std::string& filepath) {
-    NormalizationParams params;
+namespace {
+
+void readVector3(const JsonValue& root, const char* key, const std::string& path,
+                 std::array<float, 3>& out) {
+    const JsonValue* value = root.find(key);
+    if (!value || !value->isArray() || value->size() != 3) {
+        throw std::runtime_error(path + ": \"" + key + "\" must be an array of 3 numbers");
+    }
+    for (size_t i = 0; i < 3; ++i) {
+        const JsonValue& element = (*value)[i];
+        if (!element.isNumber() || !std::isfinite(element.asNumber())) {
+            throw std::runtime_error(path + ": \"" + key + "\"[" + std::to_string(i) +
+                                     "] must be a finite number");
+        }
+        out[i] = static_cast<float>(element.asNumber());
+    }
+}
+
+int readDimension(const JsonValue& root, const char* key, const std::string& path) {
+    const JsonValue* value = root.find(key);
+    if (!value || value->isNull()) return 0;
+    
+    const double number = value->isNumber() ? value->asNumber() : -1.0;
+    if (!(number >= 1.0 && number <= 1e6) || number != static_cast<double>(static_cast<int>(number))) {
+        throw std::runtime_error(path + ": \"" + key + "\" must be a positive integer");
+    }
+    return static_cast<int>(number);
+}
+
+std::vector<std::string> readNames(const JsonValue& root, const char* key, const std::string& path) {
+    std::vector<std::string> names;
+    const JsonValue* value = root.find(key);
+    if (!value || value->isNull()) return names;
     
-    std::ifstream file(filepath);
+    if (!value->isArray()) {
+        throw std::runtime_error(path + ": \"" + key + "\" must be an array of strings");
+    }
+    for (const JsonValue& element : value->values()) {
+        if (!element.isString() || element.asString().empty()) {
+            throw std::runtime_error(path + ": \"" + key + "\" must be an array of strings");
+        }
+        names.push_back(element.asString());
+    }
+    return names;
+}
+
+} // namespace
+
+ModelMetadata loadModelMetadata(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
     if (!file.is_open()) {
-        throw std::runtime_error("Failed to open normalization file: " + filepath);
+        throw std::runtime_error("Failed to open normalization file: " + path);
+    }
+    
+    const std::string content((std::istreambuf_iterator<char>(file)),
+                              std::istreambuf_iterator<char>());
+    
+    JsonValue root;
+    try {
+        root = JsonValue::parse(content);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(path + ": " + e.what());
+    }
+    if (!root.isObject()) {
+        throw std::runtime_error(path + ": expected a JSON object");
+    }
+    
+    ModelMetadata metadata;
+    readVector3(root, "mean", path, metadata.normalization.mean);
+    readVector3(root, "std", path, metadata.normalization.std);
+    for (float s : metadata.normalization.std) {
+        if (!(s > 0.0f)) throw std::runtime_error(path + ": \"std\" values must be > 0");
+    }
+    
+    metadata.latent_dim = readDimension(root, "latent_dim", path);
+    metadata.seq_len = readDimension(root, "seq_len", path);
+    metadata.input_names = readNames(root, "input_names", path);
+    metadata.output_names = readNames(root, "output_names", path);
+    if (!metadata.input_names.empty() && metadata.input_names.size() != 3) {
+        throw std::runtime_error(path + ": \"input_names\" must list latent, start and end");
+    }
+    return metadata;
+}
+
+void applyModelMetadata(const ModelMetadata& metadata, GeneratorConfig& config) {
+    if (metadata.latent_dim > 0) config.latent_dim = metadata.latent_dim;
+    if (metadata.seq_len > 0) config.seq_len = metadata.seq_len;
+    if (!metadata.input_names.empty()) config.input_names = metadata.input_names;
+    if (!metadata.output_names.empty()) config.output_name = metadata.output_names.front();
+}
+
+const char* precisionName(ModelPrecision precision) {
+    switch (precision) {
+        case ModelPrecision::FP16: return "fp16";
+        case ModelPrecision::INT8: return "int8";
+        default: return "fp32";
+    }
+}
+
+std::string modelVariantPath(const std::string& model_path, ModelPrecision precision) {
+    if (precision == ModelPrecision::FP32) return model_path;
+    
+    const std::string suffix = std::string("_") + precisionName(precision);
+    
+    // Split at the extension of the file name (not of a directory)
+    const size_t slash = model_path.find_last_of("/\\");
+    size_t dot = model_path.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        dot = model_path.size();
     }
     
-    std::string content((std::istreambuf_iterator<char>(file)),
-                        std::istreambuf_iterator<char>());
+    const std::string stem = model_path.substr(0, dot);
+    if (stem.size() >= suffix.size() &&
+        stem.compare(stem.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        return model_path;
+    }
+    
+    return stem + suffix + model_path.substr(dot);
+}
+
+// ============================================================================
+// ModelSession Implementation
+// ============================================================================
+
+namespace {
+
+bool providerAvailable(const char* name) {
+    const std::vector<std::string> providers = Ort::GetAvailableProviders();
+    return std::find(providers.begin(), providers.end(), name) != providers.end();
+}
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+/**
+ * @brief Generator metrics in the global telemetry registry, looked up once
+ */
+struct GeneratorTelemetry {
+    TelemetryHistogram& sampling = *stageHistogram("sampling");
+    TelemetryHistogram& tensor_setup = *stageHistogram("tensor_setup");
+    TelemetryHistogram& session_run = *stageHistogram("session_run");
+    TelemetryHistogram& postprocess = *stageHistogram("postprocess");
+    TelemetryHistogram& batch_fill = TelemetryRegistry::global().histogram(
+        "trajectory_batch_fill_ratio", "Rows per session run over max_batch_size",
+        std::string(), ratioBuckets());
+    TelemetryCounter& runs = TelemetryRegistry::global().counter(
+        "trajectory_session_runs_total", "ONNX session runs");
+    TelemetryCounter& generated = TelemetryRegistry::global().counter(
+        "trajectory_generated_total", "Trajectories generated");
+};
+
+GeneratorTelemetry& generatorTelemetry() {
+    static GeneratorTelemetry telemetry;
+    return telemetry;
+}
+
+Clock::time_point telemetryNow() {
+    return kTelemetryEnabled ? Clock::now() : Clock::time_point();
+}
+
+/**
+ * @brief Call run(), attributing the time since setup_start to tensor setup
+ */
+template <typename RunFn>
+void timedRun(Clock::time_point setup_start, RunFn&& run) {
+    if constexpr (kTelemetryEnabled) {
+        const auto run_start = Clock::now();
+        run();
+        const auto run_end = Clock::now();
+        
+        GeneratorTelemetry& telemetry = generatorTelemetry();
+        telemetry.tensor_setup.observe(run_start - setup_start);
+        telemetry.session_run.observe(run_end - run_start);
+    } else {
+        run();
+    }
+}
+
+uint64_t resolveSeed(uint64_t seed) {
+    if (seed != 0) return seed;
+    
+    // No fixed seed: pick one per generator (getSeed() reports it)
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) ^ device() ^
+           static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+bool cacheIsFresh(const std::string& model_path, const std::string& cache_path) {
+    std::error_code ec;
+    const auto cache_time = std::filesystem::last_write_time(cache_path, ec);
+    if (ec) return false;
+    
+    const auto model_time = std::filesystem::last_write_time(model_path, ec);
+    return !ec && cache_time >= model_time;
+}
+
+void appendTensorRT(Ort::SessionOptions& options, int device_id, const std::string& cache_dir) {
+    const OrtApi& api = Ort::GetApi();
+    
+    OrtTensorRTProviderOptionsV2* trt_options = nullptr;
+    Ort::ThrowOnError(api.CreateTensorRTProviderOptions(&trt_options));
+    std::unique_ptr<OrtTensorRTProviderOptionsV2, decltype(api.ReleaseTensorRTProviderOptions)>
+        guard(trt_options, api.ReleaseTensorRTProviderOptions);
+    
+    const std::string device = std::to_string(device_id);
+    const char* keys[] = {"device_id", "trt_engine_cache_enable", "trt_engine_cache_path"};
+    const char* values[] = {device.c_str(), "1", cache_dir.c_str()};
+    const size_t n_options = cache_dir.empty() ? 1 : 3;
+    Ort::ThrowOnError(api.UpdateTensorRTProviderOptions(trt_options, keys, values, n_options));
+    
+    options.AppendExecutionProvider_TensorRT_V2(*trt_options);
+}
+
+void appendCUDA(Ort::SessionOptions& options, int device_id) {
+    OrtCUDAProviderOptions cuda_options;
+    cuda_options.device_id = device_id;
+    options.AppendExecutionProvider_CUDA(cuda_options);
+}
+
+/**
+ * @brief Environment owning the process-wide thread pools
+ * 
+ * ORT keeps one environment per process and builds the global pools
+ * when it is first created, so this must come before any per-session
+ * generator's environment. Later callers share the pools as they are.
+ */
+std::shared_ptr<Ort::Env> globalPoolEnv(const GeneratorConfig& config) {
+    static std::mutex mutex;
+    static std::weak_ptr<Ort::Env> shared;
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    if (auto env = shared.lock()) return env;
     
-    // Simple regex parsing for mean and std arrays
-    std::regex mean_regex(R"("mean"\s*:\s*\[([\d\.\-\s,]+)\])");
-    std::regex std_regex(R"("std"\s*:\s*\[([\d\.\-\s,]+)\])");
+    Ort::ThreadingOptions threading;
+    threading.SetGlobalIntraOpNumThreads(config.num_threads);
+    threading.SetGlobalInterOpNumThreads(config.inter_op_threads);
+    threading.SetGlobalSpinControl(config.allow_spinning ? 1 : 0);
+    if (!config.thread_affinity.empty()) {
+        Ort::ThrowOnError(Ort::GetApi().SetGlobalIntraOpThreadAffinity(
+            threading, config.thread_affinity.c_str()));
+    }
     
-    std::smatch match;
+    auto env = std::make_shared<Ort::Env>(threading, ORT_LOGGING_LEVEL_WARNING, "TrajectoryGenerator");
+    shared = env;
+    return env;
+}
+
+std::unique_ptr<Ort::SessionOptions> makeSessionOptions(const GeneratorConfig& config) {
+    auto options = std::make_unique<Ort::SessionOptions>();
+    options->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+    options->SetExecutionMode(config.parallel_execution ? ExecutionMode::ORT_PARALLEL
+                                                        : ExecutionMode::ORT_SEQUENTIAL);
     
-    // Parse mean
-    if (std::regex_search(content, match, mean_regex)) {
-        std::string values = match[1].str();
-        std::istringstream iss(values);
-        std::string token;
-        int idx = 0;
-        while (std::getline(iss, token, ',') && idx < 3) {
-            params.mean[idx++] = std::stof(token);
+    // Thread counts, spinning and affinity of the global pool were fixed
+    // when its environment was created
+    if (config.use_global_thread_pool) {
+        options->DisablePerSessionThreads();
+    } else {
+        options->SetIntraOpNumThreads(config.num_threads);
+        if (config.inter_op_threads > 0) {
+            options->SetInterOpNumThreads(config.inter_op_threads);
+        }
+        if (!config.allow_spinning) {
+            options->AddConfigEntry("session.intra_op.allow_spinning", "0");
+            options->AddConfigEntry("session.inter_op.allow_spinning", "0");
+        }
+        if (!config.thread_affinity.empty()) {
+            options->AddConfigEntry("session.intra_op_thread_affinities", config.thread_affinity.c_str());
         }
     }
     
-    // Parse std
-    if (std::regex_search(content, match, std_regex)) {
-        std::string values = match[1].str();
-        std::istringstream iss(values);
-        std::string token;
-        int idx = 0;
-        while (std::getline(iss, token, ',') && idx < 3) {
-            params.std[idx++] = std::stof(token);
+    // The unrolled LSTM decoder returns corrupted trajectories on the second
+    // and later runs of a given input shape when ORT replays its cached
+    // memory pattern, so the planner is disabled for this model.
+    options->DisableMemPattern();
+    
+    if (!config.profile_prefix.empty()) {
+#ifdef _WIN32
+        std::wstring prefix_w(config.profile_prefix.begin(), config.profile_prefix.end());
+        options->EnableProfiling(prefix_w.c_str());
+#else
+        options->EnableProfiling(config.profile_prefix.c_str());
+#endif
+    }
+    
+    return options;
+}
+
+/**
+ * @brief Register GPU providers on options, best first
+ * @return Provider the session will prefer ("TensorRT", "CUDA" or "CPU")
+ */
+std::string appendGpuProviders(Ort::SessionOptions& options, const GeneratorConfig& config) {
+    std::string provider = "CPU";
+    
+    // CUDA is registered after TensorRT so it picks up any nodes
+    // TensorRT cannot take; both fall back to the CPU provider last
+    if (config.use_tensorrt) {
+        if (!providerAvailable("TensorrtExecutionProvider")) {
+            std::cerr << "Warning: TensorRT provider not available in this ONNX Runtime build" << std::endl;
+        } else {
+            try {
+                // Built engines are cached next to the optimized CPU graph
+                std::string cache_dir;
+                if (!config.optimized_model_path.empty()) {
+                    cache_dir = std::filesystem::path(config.optimized_model_path)
+                                    .parent_path().string();
+                    if (cache_dir.empty()) cache_dir = ".";
+                }
+                appendTensorRT(options, config.gpu_device_id, cache_dir);
+                provider = "TensorRT";
+            } catch (const Ort::Exception& e) {
+                std::cerr << "Warning: TensorRT provider unavailable: " << e.what() << std::endl;
+            }
         }
     }
     
-    return params;
+    if (!providerAvailable("CUDAExecutionProvider")) {
+        std::cerr << "Warning: CUDA provider not available in this ONNX Runtime build "
+                  << "(use the onnxruntime-linux-x64-gpu package)" << std::endl;
+        return provider;
+    }
+    
+    try {
+        appendCUDA(options, config.gpu_device_id);
+        if (provider == "CPU") provider = "CUDA";
+    } catch (const Ort::Exception& e) {
+        std::cerr << "Warning: CUDA provider unavailable: " << e.what() << std::endl;
+    }
+    
+    return provider;
 }
 
-TrajectoryGenerator::TrajectoryGenerator(const GeneratorConfig& config)
-    : config_(config)
-    , memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault))
-    , rng_state_(static_cast<unsigned int>(std::time(nullptr)))
+} // namespace
+
+ModelSession::ModelSession(const GeneratorConfig& config)
+    : output_seq_len_(config.seq_len)
+    , provider_("CPU")
+    , device_id_(config.gpu_device_id)
+    , loaded_from_cache_(false)
+    , model_path_(modelVariantPath(config.model_path, config.precision))
+    , precision_(config.precision)
+    , half_inputs_(false)
+    , half_output_(false)
+    , profiling_(!config.profile_prefix.empty())
 {
     // Initialize ONNX Runtime environment
-    env_ = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "TrajectoryGenerator");
+    if (config.use_global_thread_pool) {
+        try {
+            env_ = globalPoolEnv(config);
+        } catch (const Ort::Exception& e) {
+            throw std::runtime_error(std::string("Failed to create the global thread pool: ") + e.what());
+        }
+    } else {
+        env_ = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "TrajectoryGenerator");
+    }
     
     // Create session options
-    session_options_ = std::make_unique<Ort::SessionOptions>();
-    session_options_->SetIntraOpNumThreads(config_.num_threads);
-    session_options_->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+    session_options_ = makeSessionOptions(config);
     
-    // GPU support (if requested and available)
-    if (config_.use_gpu) {
-        // Note: Requires CUDA/TensorRT provider to be available
-        // OrtCUDAProviderOptions cuda_options;
-        // session_options_->AppendExecutionProvider_CUDA(cuda_options);
-        std::cerr << "Warning: GPU support not implemented in this version" << std::endl;
+    // GPU providers (if requested and available)
+    if (config.use_gpu) {
+        provider_ = appendGpuProviders(*session_options_, config);
     }
     
     // Load model
     try {
-#ifdef _WIN32
-        std::wstring model_path_w(config_.model_path.begin(), config_.model_path.end());
-        session_ = std::make_unique<Ort::Session>(*env_, model_path_w.c_str(), *session_options_);
-#else
-        session_ = std::make_unique<Ort::Session>(*env_, config_.model_path.c_str(), *session_options_);
-#endif
-        
-        // Get input/output names
-        Ort::AllocatorWithDefaultOptions allocator;
-        
-        // Input names: latent, start, end
-        input_names_.push_back("latent");
-        input_names_.push_back("start");
-        input_names_.push_back("end");
-        
-        // Output names: trajectory
-        output_names_.push_back("trajectory");
+        try {
+            loadModel(config);
+        } catch (const Ort::Exception& e) {
+            // Providers can register fine and still fail at session creation
+            // (no device, driver mismatch); retry once on the CPU
+            if (provider_ == "CPU") throw;
+            
+            std::cerr << "Warning: " << provider_ << " session failed (" << e.what()
+                      << "), falling back to CPU" << std::endl;
+            provider_ = "CPU";
+            session_options_ = makeSessionOptions(config);
+            loadModel(config);
+        }
         
-        std::cout << "✓ ONNX model loaded successfully: " << config_.model_path << std::endl;
+        bindModelIO(config);
         
+        std::cout << "✓ ONNX model loaded successfully: " << model_path_
+                  << " (" << provider_ << (loaded_from_cache_ ? ", cached optimized graph" : "")
+                  << ")" << std::endl;
+                  
     } catch (const Ort::Exception& e) {
         throw std::runtime_error(std::string("Failed to load ONNX model: ") + e.what());
     }
 }
 
+void ModelSession::loadModel(const GeneratorConfig& config) {
+    const std::string cache_path = config.optimized_model_path.empty()
+        ? std::string()
+        : modelVariantPath(config.optimized_model_path, config.precision);
+    
+    // Only CPU graphs are cached; GPU providers claim nodes with their own
+    // kernels, which do not survive serialization (TensorRT keeps its own
+    // engine cache instead)
+    if (cache_path.empty() || onGpu()) {
+        createSession(model_path_);
+        return;
+    }
+    
+    if (cacheIsFresh(model_path_, cache_path)) {
+        // Already optimized, so skip the graph transformers entirely
+        session_options_->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+        try {
+            createSession(cache_path);
+            loaded_from_cache_ = true;
+            return;
+        } catch (const Ort::Exception& e) {
+            std::cerr << "Warning: ignoring unreadable optimized model " << cache_path
+                      << ": " << e.what() << std::endl;
+        }
+    }
+    
+    // Optimize once and write the result through a temporary file, so a
+    // process starting concurrently never opens a half-written cache.
+    // ORT_ENABLE_EXTENDED rather than ALL: ALL adds layout transforms tied to
+    // this CPU, and the cache may be shared by differently equipped hosts.
+    const std::string temp_path = cache_path + ".tmp" +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    
+    session_options_ = makeSessionOptions(config);
+    session_options_->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+#ifdef _WIN32
+    std::wstring temp_path_w(temp_path.begin(), temp_path.end());
+    session_options_->SetOptimizedModelFilePath(temp_path_w.c_str());
+#else
+    session_options_->SetOptimizedModelFilePath(temp_path.c_str());
+#endif
+    if (cache_path.size() >= 4 && cache_path.compare(cache_path.size() - 4, 4, ".ort") == 0) {
+        session_options_->AddConfigEntry("session.save_model_format", "ORT");
+    }
+    
+    createSession(model_path_);
+    
+    std::error_code ec;
+    std::filesystem::rename(temp_path, cache_path, ec);
+    if (ec) {
+        std::cerr << "Warning: could not write optimized model cache " << cache_path
+                  << ": " << ec.message() << std::endl;
+        std::filesystem::remove(temp_path, ec);
+    }
+}
+
+void ModelSession::createSession(const std::string& path) {
+#ifdef _WIN32
+    std::wstring model_path_w(path.begin(), path.end());
+    session_ = std::make_unique<Ort::Session>(*env_, model_path_w.c_str(), *session_options_);
+#else
+    session_ = std::make_unique<Ort::Session>(*env_, path.c_str(), *session_options_);
+#endif
+}
+
+void ModelSession::bindModelIO(const GeneratorConfig& config) {
+    Ort::AllocatorWithDefaultOptions allocator;
+    
+    std::vector<std::string> model_inputs;
+    for (size_t i = 0; i < session_->GetInputCount(); ++i) {
+        model_inputs.push_back(session_->GetInputNameAllocated(i, allocator).get());
+    }
+    std::vector<std::string> model_outputs;
+    for (size_t i = 0; i < session_->GetOutputCount(); ++i) {
+        model_outputs.push_back(session_->GetOutputNameAllocated(i, allocator).get());
+    }
+    
+    auto listNames = [](const std::vector<std::string>& names) {
+        std::string out;
+        for (const std::string& name : names) out += (out.empty() ? "" : ", ") + name;
+        return out;
+    };
+    auto indexOf = [&](const std::vector<std::string>& names, const std::string& name, const char* kind) {
+        auto it = std::find(names.begin(), names.end(), name);
+        if (it == names.end()) {
+            throw std::runtime_error(model_path_ + " has no " + std::string(kind) + " '" + name + "' (has: " +
+                                     listNames(names) + ")");
+        }
+        return static_cast<size_t>(it - names.begin());
+    };
+    
+    // Without configured names, the export's order is the contract:
+    // inputs (latent, start, end), first output the trajectory
+    if (config.input_names.empty()) {
+        if (model_inputs.size() != 3) {
+            throw std::runtime_error(model_path_ + " has " + std::to_string(model_inputs.size()) +
+                                     " inputs (" + listNames(model_inputs) +
+                                     "), expected latent, start and end");
+        }
+        input_name_storage_ = model_inputs;
+    } else {
+        if (config.input_names.size() != 3) {
+            throw std::runtime_error("config.input_names must list latent, start and end");
+        }
+        input_name_storage_ = config.input_names;
+    }
+    if (model_outputs.empty()) {
+        throw std::runtime_error(model_path_ + " has no outputs");
+    }
+    output_name_storage_.assign(1, config.output_name.empty() ? model_outputs.front() : config.output_name);
+    
+    size_t input_index[3];
+    for (size_t i = 0; i < 3; ++i) {
+        input_index[i] = indexOf(model_inputs, input_name_storage_[i], "input");
+    }
+    const size_t output_index = indexOf(model_outputs, output_name_storage_[0], "output");
+    
+    input_names_.clear();
+    for (const std::string& name : input_name_storage_) input_names_.push_back(name.c_str());
+    output_names_.assign(1, output_name_storage_[0].c_str());
+    
+    // Check the graph against the configured shapes (-1 = dynamic)
+    auto shapeOf = [&](size_t index, bool output) {
+        return output ? session_->GetOutputTypeInfo(index).GetTensorTypeAndShapeInfo().GetShape()
+                      : session_->GetInputTypeInfo(index).GetTensorTypeAndShapeInfo().GetShape();
+    };
+    auto checkDim = [&](const std::vector<int64_t>& shape, size_t rank, size_t axis, int64_t expected,
+                        const std::string& name, const char* what) {
+        if (shape.size() != rank) {
+            throw std::runtime_error(model_path_ + ": tensor '" + name + "' has rank " + std::to_string(shape.size()) +
+                                     ", expected " + std::to_string(rank));
+        }
+        if (shape[axis] > 0 && shape[axis] != expected) {
+            throw std::runtime_error(model_path_ + ": tensor '" + name + "' has " + std::to_string(shape[axis]) +
+                                     " " + what + ", expected " + std::to_string(expected));
+        }
+    };
+    
+    checkDim(shapeOf(input_index[0], false), 2, 1, config.latent_dim, input_name_storage_[0],
+             "latent dims (config.latent_dim)");
+    checkDim(shapeOf(input_index[1], false), 2, 1, 3, input_name_storage_[1], "coordinates");
+    checkDim(shapeOf(input_index[2], false), 2, 1, 3, input_name_storage_[2], "coordinates");
+    
+    // A length baked into the model must be the configured one: [batch, seq_len, 3]
+    const std::vector<int64_t> output_shape = shapeOf(output_index, true);
+    checkDim(output_shape, 3, 2, 3, output_name_storage_[0], "coordinates");
+    checkDim(output_shape, 3, 1, config.seq_len, output_name_storage_[0], "waypoints (config.seq_len)");
+    
+    // FP16 exports may keep float16 at the graph boundary
+    half_inputs_ = session_->GetInputTypeInfo(input_index[0]).GetTensorTypeAndShapeInfo().GetElementType()
+                   == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+    half_output_ = session_->GetOutputTypeInfo(output_index).GetTensorTypeAndShapeInfo().GetElementType()
+                   == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+}
+
+ModelSession::~ModelSession() = default;
+
+std::string ModelSession::endProfiling() {
+    if (!profiling_) return std::string();
+    profiling_ = false;
+    
+    Ort::AllocatorWithDefaultOptions allocator;
+    return session_->EndProfilingAllocated(allocator).get();
+}
+
+// ============================================================================
+// TrajectoryGenerator Implementation
+// ============================================================================
+
+TrajectoryGenerator::TrajectoryGenerator(const GeneratorConfig& config)
+    : config_(config)
+    , memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault))
+    , output_seq_len_(config.seq_len)
+    , sampler_(resolveSeed(config.seed))
+    , next_request_id_(0)
+{
+    if (config_.max_batch_size < 1) {
+        throw std::runtime_error("max_batch_size must be at least 1");
+    }
+    
+    model_ = std::make_shared<ModelSession>(config_);
+    initialize();
+}
+
+TrajectoryGenerator::TrajectoryGenerator(std::shared_ptr<ModelSession> model,
+                                         const GeneratorConfig& config)
+    : config_(config)
+    , model_(std::move(model))
+    , memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault))
+    , output_seq_len_(config.seq_len)
+    , sampler_(resolveSeed(config.seed))
+    , next_request_id_(0)
+{
+    if (!model_) {
+        throw std::runtime_error("TrajectoryGenerator requires a model session");
+    }
+    if (config_.max_batch_size < 1) {
+        throw std::runtime_error("max_batch_size must be at least 1");
+    }
+    
+    initialize();
+}
+
+void TrajectoryGenerator::initialize() {
+    output_seq_len_ = model_->outputSeqLen();
+    
+    if (model_->onGpu()) {
+        try {
+            Ort::MemoryInfo pinned_info("CudaPinned", OrtDeviceAllocator,
+                                        model_->deviceId(), OrtMemTypeCPUOutput);
+            pinned_allocator_ = std::make_unique<Ort::Allocator>(model_->session(), pinned_info);
+        } catch (const Ort::Exception& e) {
+            std::cerr << "Warning: pinned host memory unavailable, using pageable buffers: "
+                      << e.what() << std::endl;
+        }
+    }
+    
+    // Allocate input staging buffers for the largest batch
+    latent_buffer_.allocate(static_cast<size_t>(config_.max_batch_size) * config_.latent_dim,
+                            pinned_allocator_.get());
+    start_buffer_.allocate(static_cast<size_t>(config_.max_batch_size) * 3, pinned_allocator_.get());
+    end_buffer_.allocate(static_cast<size_t>(config_.max_batch_size) * 3, pinned_allocator_.get());
+    
+    const size_t output_count = static_cast<size_t>(config_.max_batch_size) * output_seq_len_ * 3;
+    const bool mixed_precision = model_->halfInputs() || model_->halfOutput();
+    
+    if (config_.use_io_binding || mixed_precision) {
+        output_buffer_.allocate(output_count, pinned_allocator_.get());
+    }
+    
+    if (config_.use_io_binding && !mixed_precision) {
+        bindings_.resize(config_.max_batch_size + 1);
+    }
+    
+    if (model_->halfInputs()) {
+        half_input_buffer_.resize(latent_buffer_.size() + start_buffer_.size() + end_buffer_.size());
+    }
+    if (model_->halfOutput()) {
+        half_output_buffer_.resize(output_count);
+    }
+}
+
 TrajectoryGenerator::~TrajectoryGenerator() = default;
 
+void TrajectoryGenerator::HostBuffer::allocate(size_t count, Ort::Allocator* pinned) {
+    if (pinned) {
+        pinned_ = std::unique_ptr<void, std::function<void(void*)>>(
+            pinned->Alloc(count * sizeof(float)), [pinned](void* p) { pinned->Free(p); });
+        data_ = static_cast<float*>(pinned_.get());
+        std::fill(data_, data_ + count, 0.0f);
+    } else {
+        storage_.assign(count, 0.0f);
+        data_ = storage_.data();
+    }
+    size_ = count;
+}
+
+void TrajectoryGenerator::warmup(const std::vector<int>& batch_sizes) {
+    std::vector<int> sizes = batch_sizes;
+    if (sizes.empty()) {
+        sizes = {1, config_.max_batch_size};
+    }
+    
+    // Neutral inputs: zero latent at the normalized origin
+    std::fill(latent_buffer_.data(), latent_buffer_.data() + latent_buffer_.size(), 0.0f);
+    std::fill(start_buffer_.data(), start_buffer_.data() + start_buffer_.size(), 0.0f);
+    std::fill(end_buffer_.data(), end_buffer_.data() + end_buffer_.size(), 0.0f);
+    
+    for (int size : sizes) {
+        runSession(std::max(1, std::min(size, config_.max_batch_size)), nullptr);
+    }
+}
+
 bool TrajectoryGenerator::loadNormalization(const std::string& norm_path) {
     try {
-        norm_params_ = parseNormalizationJSON(norm_path);
+        norm_params_ = loadModelMetadata(norm_path).normalization;
         
         std::cout << "✓ Normalization loaded:" << std::endl;
         std::cout << "  Mean: [" << norm_params_.mean[0] << ", " 
@@ -144,201 +721,382 @@ Waypoint TrajectoryGenerator::denormalize(const std::array<float, 3>& normalized
     );
 }
 
-std::vector<float> TrajectoryGenerator::sampleLatent() {
-    // Sample from standard normal distribution
-    std::vector<float> latent(config_.latent_dim);
-    
-    // Simple Box-Muller transform for normal distribution
-    std::mt19937 gen(rng_state_++);
-    std::normal_distribution<float> dist(0.0f, 1.0f);
+void TrajectoryGenerator::denormalizeInPlace(float* xyz, size_t n_points) const {
+    const float sx = norm_params_.std[0], mx = norm_params_.mean[0];
+    const float sy = norm_params_.std[1], my = norm_params_.mean[1];
+    const float sz = norm_params_.std[2], mz = norm_params_.mean[2];
     
-    for (int i = 0; i < config_.latent_dim; ++i) {
-        latent[i] = dist(gen);
+    // Straight-line multiply-add over the interleaved buffer; the compiler
+    // vectorizes this loop, which replaces the per-waypoint denormalize().
+    for (size_t i = 0; i < n_points; ++i) {
+        xyz[i * 3 + 0] = xyz[i * 3 + 0] * sx + mx;
+        xyz[i * 3 + 1] = xyz[i * 3 + 1] * sy + my;
+        xyz[i * 3 + 2] = xyz[i * 3 + 2] * sz + mz;
     }
+}
+
+void TrajectoryGenerator::stageRows(int row, int count, const GenerationRequest& request,
+                                    uint64_t request_id, int first_sample) {
+    sampler_.fill(&latent_buffer_[static_cast<size_t>(row) * config_.latent_dim],
+                  static_cast<size_t>(count), config_.latent_dim, request_id,
+                  static_cast<uint64_t>(first_sample));
     
-    return latent;
+    auto start_norm = normalize(request.start);
+    auto end_norm = normalize(request.end);
+    for (int i = row; i < row + count; ++i) {
+        std::copy(start_norm.begin(), start_norm.end(), &start_buffer_[i * 3]);
+        std::copy(end_norm.begin(), end_norm.end(), &end_buffer_[i * 3]);
+    }
 }
 
-Trajectory TrajectoryGenerator::runInference(const std::vector<float>& latent,
-                                             const Waypoint& start,
-                                             const Waypoint& end) {
-    // Normalize inputs
-    auto start_norm = normalize(start);
-    auto end_norm = normalize(end);
+TrajectoryGenerator::BoundBatch& TrajectoryGenerator::getBinding(int batch_size) {
+    auto& slot = bindings_[batch_size];
+    if (slot) return *slot;
     
-    // Prepare input tensors
-    std::vector<int64_t> latent_shape = {1, config_.latent_dim};
-    std::vector<int64_t> waypoint_shape = {1, 3};
+    const int64_t latent_shape[] = {batch_size, config_.latent_dim};
+    const int64_t waypoint_shape[] = {batch_size, 3};
+    const int64_t output_shape[] = {batch_size, output_seq_len_, 3};
     
-    // Create input tensors
-    auto latent_tensor = Ort::Value::CreateTensor<float>(
-        memory_info_, 
-        const_cast<float*>(latent.data()), 
-        latent.size(),
-        latent_shape.data(), 
-        latent_shape.size()
-    );
+    slot = std::make_unique<BoundBatch>();
+    slot->latent = Ort::Value::CreateTensor<float>(
+        memory_info_, latent_buffer_.data(),
+        static_cast<size_t>(batch_size) * config_.latent_dim, latent_shape, 2);
+    slot->start = Ort::Value::CreateTensor<float>(
+        memory_info_, start_buffer_.data(),
+        static_cast<size_t>(batch_size) * 3, waypoint_shape, 2);
+    slot->end = Ort::Value::CreateTensor<float>(
+        memory_info_, end_buffer_.data(),
+        static_cast<size_t>(batch_size) * 3, waypoint_shape, 2);
+    slot->output = Ort::Value::CreateTensor<float>(
+        memory_info_, output_buffer_.data(),
+        static_cast<size_t>(batch_size) * output_seq_len_ * 3, output_shape, 3);
     
-    auto start_tensor = Ort::Value::CreateTensor<float>(
-        memory_info_,
-        const_cast<float*>(start_norm.data()),
-        start_norm.size(),
-        waypoint_shape.data(),
-        waypoint_shape.size()
-    );
+    slot->binding = Ort::IoBinding(model_->session());
+    slot->binding.BindInput(model_->inputNames()[0], slot->latent);
+    slot->binding.BindInput(model_->inputNames()[1], slot->start);
+    slot->binding.BindInput(model_->inputNames()[2], slot->end);
+    slot->binding.BindOutput(model_->outputNames()[0], slot->output);
     
-    auto end_tensor = Ort::Value::CreateTensor<float>(
-        memory_info_,
-        const_cast<float*>(end_norm.data()),
-        end_norm.size(),
-        waypoint_shape.data(),
-        waypoint_shape.size()
-    );
+    return *slot;
+}
+
+const float* TrajectoryGenerator::runMixedPrecision(int batch_size, float* output) {
+    const auto setup_start = telemetryNow();
+    const int64_t latent_shape[] = {batch_size, config_.latent_dim};
+    const int64_t waypoint_shape[] = {batch_size, 3};
+    const int64_t output_shape[] = {batch_size, output_seq_len_, 3};
+    const size_t latent_count = static_cast<size_t>(batch_size) * config_.latent_dim;
+    const size_t waypoint_count = static_cast<size_t>(batch_size) * 3;
+    const size_t output_count = static_cast<size_t>(batch_size) * output_seq_len_ * 3;
     
-    // Prepare inputs
-    std::vector<Ort::Value> input_tensors;
-    input_tensors.push_back(std::move(latent_tensor));
-    input_tensors.push_back(std::move(start_tensor));
-    input_tensors.push_back(std::move(end_tensor));
-    
-    // Run inference
-    auto output_tensors = session_->Run(
-        Ort::RunOptions{nullptr},
-        input_names_.data(),
-        input_tensors.data(),
-        input_tensors.size(),
-        output_names_.data(),
-        output_names_.size()
-    );
+    // Inputs: float views, or float16 copies packed back to back
+    Ort::Float16_t* half = half_input_buffer_.data();
+    auto make_input = [&](float* values, size_t count, const int64_t* shape, size_t rank) {
+        if (!model_->halfInputs()) {
+            return Ort::Value::CreateTensor<float>(memory_info_, values, count, shape, rank);
+        }
+        
+        Ort::Float16_t* converted = half;
+        for (size_t i = 0; i < count; ++i) {
+            converted[i] = Ort::Float16_t(values[i]);
+        }
+        half += count;
+        return Ort::Value::CreateTensor<Ort::Float16_t>(memory_info_, converted, count, shape, rank);
+    };
     
-    // Extract output
-    float* output_data = output_tensors[0].GetTensorMutableData<float>();
-    auto output_shape = output_tensors[0].GetTensorTypeAndShapeInfo().GetShape();
+    Ort::Value input_tensors[] = {
+        make_input(latent_buffer_.data(), latent_count, latent_shape, 2),
+        make_input(start_buffer_.data(), waypoint_count, waypoint_shape, 2),
+        make_input(end_buffer_.data(), waypoint_count, waypoint_shape, 2)
+    };
     
-    int seq_len = static_cast<int>(output_shape[1]);
+    float* dest = output ? output : output_buffer_.data();
+    Ort::Value output_tensor = model_->halfOutput()
+        ? Ort::Value::CreateTensor<Ort::Float16_t>(memory_info_, half_output_buffer_.data(),
+                                                   output_count, output_shape, 3)
+        : Ort::Value::CreateTensor<float>(memory_info_, dest, output_count, output_shape, 3);
     
-    // Convert to trajectory
-    Trajectory trajectory;
-    trajectory.reserve(seq_len);
+    timedRun(setup_start, [&]() {
+        model_->session().Run(
+            run_options_,
+            model_->inputNames().data(),
+            input_tensors,
+            3,
+            model_->outputNames().data(),
+            &output_tensor,
+            1
+        );
+    });
     
-    for (int i = 0; i < seq_len; ++i) {
-        std::array<float, 3> normalized = {
-            output_data[i * 3 + 0],
-            output_data[i * 3 + 1],
-            output_data[i * 3 + 2]
-        };
-        
-        trajectory.push_back(denormalize(normalized));
+    if (model_->halfOutput()) {
+        for (size_t i = 0; i < output_count; ++i) {
+            dest[i] = half_output_buffer_[i].ToFloat();
+        }
     }
     
-    return trajectory;
+    return dest;
 }
 
-Trajectory TrajectoryGenerator::generate(const Waypoint& start, const Waypoint& end) {
-    if (!isReady()) {
-        throw std::runtime_error("Generator not initialized");
+const float* TrajectoryGenerator::runSession(int batch_size, float* output) {
+    const int64_t output_shape[] = {batch_size, output_seq_len_, 3};
+    const size_t output_count = static_cast<size_t>(batch_size) * output_seq_len_ * 3;
+    
+    if (model_->halfInputs() || model_->halfOutput()) {
+        return runMixedPrecision(batch_size, output);
     }
     
-    // Sample latent vector
-    auto latent = sampleLatent();
+    const auto setup_start = telemetryNow();
     
-    // Run inference
-    return runInference(latent, start, end);
-}
-
-std::vector<Trajectory> TrajectoryGenerator::generateMultiple(const Waypoint& start,
-                                                              const Waypoint& end,
-                                                              int n_samples) {
-    if (!isReady()) {
-        throw std::runtime_error("Generator not initialized");
+    if (config_.use_io_binding) {
+        BoundBatch& bound = getBinding(batch_size);
+        
+        // Rebind the output only when the destination buffer moved
+        float* dest = output ? output : output_buffer_.data();
+        if (bound.output_data != dest) {
+            bound.output = Ort::Value::CreateTensor<float>(
+                memory_info_, dest, output_count, output_shape, 3);
+            bound.binding.BindOutput(model_->outputNames()[0], bound.output);
+            bound.output_data = dest;
+        }
+        
+        // Steady state: tensors and binding already exist for this size
+        timedRun(setup_start, [&]() { model_->session().Run(run_options_, bound.binding); });
+        return dest;
     }
     
-    std::vector<Trajectory> trajectories;
-    trajectories.reserve(n_samples);
+    // Prepare input tensors over the staging buffers
+    const int64_t latent_shape[] = {batch_size, config_.latent_dim};
+    const int64_t waypoint_shape[] = {batch_size, 3};
+    
+    Ort::Value input_tensors[] = {
+        Ort::Value::CreateTensor<float>(
+            memory_info_, latent_buffer_.data(),
+            static_cast<size_t>(batch_size) * config_.latent_dim, latent_shape, 2),
+        Ort::Value::CreateTensor<float>(
+            memory_info_, start_buffer_.data(),
+            static_cast<size_t>(batch_size) * 3, waypoint_shape, 2),
+        Ort::Value::CreateTensor<float>(
+            memory_info_, end_buffer_.data(),
+            static_cast<size_t>(batch_size) * 3, waypoint_shape, 2)
+    };
     
-    for (int i = 0; i < n_samples; ++i) {
-        trajectories.push_back(generate(start, end));
+    if (output) {
+        // Caller-owned destination: ONNX Runtime writes into it directly
+        Ort::Value output_tensor = Ort::Value::CreateTensor<float>(
+            memory_info_, output, output_count, output_shape, 3);
+        
+        timedRun(setup_start, [&]() {
+            model_->session().Run(
+                run_options_,
+                model_->inputNames().data(),
+                input_tensors,
+                3,
+                model_->outputNames().data(),
+                &output_tensor,
+                1
+            );
+        });
+        return output;
     }
     
-    return trajectories;
+    // Run inference, ONNX Runtime allocates the output
+    timedRun(setup_start, [&]() {
+        output_tensors_ = model_->session().Run(
+            run_options_,
+            model_->inputNames().data(),
+            input_tensors,
+            3,
+            model_->outputNames().data(),
+            model_->outputNames().size()
+        );
+    });
+    
+    // Extract output: [batch_size, seq_len, 3]
+    auto actual_shape = output_tensors_[0].GetTensorTypeAndShapeInfo().GetShape();
+    output_seq_len_ = static_cast<int>(actual_shape[1]);
+    
+    return output_tensors_[0].GetTensorData<float>();
 }
 
-// Utility functions
-
-float computePathLength(const Trajectory& trajectory) {
-    float length = 0.0f;
+void TrajectoryGenerator::runInference(int batch_size, std::vector<Trajectory>& trajectories) {
+    const auto run_start = Clock::now();
+    const float* output_data = runSession(batch_size);
+    const auto run_end = Clock::now();
+    const int seq_len = output_seq_len_;
     
-    for (size_t i = 1; i < trajectory.size(); ++i) {
-        float dx = trajectory[i].x - trajectory[i-1].x;
-        float dy = trajectory[i].y - trajectory[i-1].y;
-        float dz = trajectory[i].z - trajectory[i-1].z;
+    // Convert each row to a trajectory
+    for (int b = 0; b < batch_size; ++b) {
+        const float* row = output_data + static_cast<size_t>(b) * seq_len * 3;
+        
+        Trajectory trajectory;
+        trajectory.reserve(seq_len);
         
-        length += std::sqrt(dx*dx + dy*dy + dz*dz);
+        for (int i = 0; i < seq_len; ++i) {
+            std::array<float, 3> normalized = {
+                row[i * 3 + 0],
+                row[i * 3 + 1],
+                row[i * 3 + 2]
+            };
+            
+            trajectory.push_back(denormalize(normalized));
+        }
+        
+        trajectories.push_back(std::move(trajectory));
     }
     
-    return length;
+    recordRun(batch_size, elapsedMs(run_start, run_end), elapsedMs(run_end, Clock::now()));
 }
 
-float computeAverageCurvature(const Trajectory& trajectory) {
-    if (trajectory.size() < 3) return 0.0f;
+void TrajectoryGenerator::recordRun(int batch_size, double inference_ms, double postprocess_ms) {
+    stage_times_.inference_ms += inference_ms;
+    stage_times_.postprocess_ms += postprocess_ms;
+    stage_times_.runs += 1;
+    stage_times_.rows += static_cast<size_t>(batch_size);
     
-    std::vector<float> curvatures;
+    if constexpr (kTelemetryEnabled) {
+        GeneratorTelemetry& telemetry = generatorTelemetry();
+        telemetry.postprocess.observe(postprocess_ms * 1e-3);
+        telemetry.batch_fill.observe(static_cast<double>(batch_size) / config_.max_batch_size);
+        telemetry.runs.add();
+        telemetry.generated.add(static_cast<uint64_t>(batch_size));
+    }
+}
+
+void TrajectoryGenerator::runInference(int batch_size, TrajectoryBatch& batch) {
+    if (batch.seqLen() != output_seq_len_) {
+        if (!batch.empty()) {
+            throw std::runtime_error("TrajectoryBatch sequence length does not match model");
+        }
+        batch.reset(output_seq_len_, batch_size);
+    }
     
-    for (size_t i = 1; i < trajectory.size() - 1; ++i) {
-        // Vectors
-        float v1x = trajectory[i].x - trajectory[i-1].x;
-        float v1y = trajectory[i].y - trajectory[i-1].y;
-        float v1z = trajectory[i].z - trajectory[i-1].z;
-        
-        float v2x = trajectory[i+1].x - trajectory[i].x;
-        float v2y = trajectory[i+1].y - trajectory[i].y;
-        float v2z = trajectory[i+1].z - trajectory[i].z;
-        
-        float norm1 = std::sqrt(v1x*v1x + v1y*v1y + v1z*v1z);
-        float norm2 = std::sqrt(v2x*v2x + v2y*v2y + v2z*v2z);
+    // Model output lands in the batch storage and is denormalized in place
+    float* rows = batch.appendRows(batch_size);
+    const auto run_start = Clock::now();
+    runSession(batch_size, rows);
+    const auto run_end = Clock::now();
+    denormalizeInPlace(rows, static_cast<size_t>(batch_size) * output_seq_len_);
+    
+    recordRun(batch_size, elapsedMs(run_start, run_end), elapsedMs(run_end, Clock::now()));
+}
+
+void TrajectoryGenerator::generateRows(const GenerationRequest* requests,
+                                       size_t num_requests,
+                                       std::vector<Trajectory>* trajectories,
+                                       TrajectoryBatch* batch,
+                                       std::vector<uint64_t>* request_ids) {
+    if (!isReady()) {
+        throw std::runtime_error("Generator not initialized");
+    }
+    
+    auto flush = [&](int rows) {
+        if (batch) {
+            runInference(rows, *batch);
+        } else {
+            runInference(rows, *trajectories);
+        }
+    };
+    
+    if (request_ids) {
+        request_ids->clear();
+        request_ids->reserve(num_requests);
+    }
+    
+    // Stage rows across request boundaries and flush whenever a batch fills
+    int row = 0;
+    for (size_t r = 0; r < num_requests; ++r) {
+        const uint64_t request_id = (requests[r].request_id == kAutoRequestId)
+                                        ? next_request_id_++
+                                        : requests[r].request_id;
+        if (request_ids) request_ids->push_back(request_id);
         
-        if (norm1 > 1e-6f && norm2 > 1e-6f) {
-            float dot = v1x*v2x + v1y*v2y + v1z*v2z;
-            float cos_angle = dot / (norm1 * norm2);
-            cos_angle = std::max(-1.0f, std::min(1.0f, cos_angle));
-            
-            float angle = std::acos(cos_angle);
-            float curvature = angle / norm1;
+        int sample = 0;
+        while (sample < requests[r].n_samples) {
+            const int count = std::min(requests[r].n_samples - sample, config_.max_batch_size - row);
+            const auto stage_start = Clock::now();
+            stageRows(row, count, requests[r], request_id, sample);
+            const double sampling_ms = elapsedMs(stage_start, Clock::now());
+            stage_times_.sampling_ms += sampling_ms;
+            if constexpr (kTelemetryEnabled) {
+                generatorTelemetry().sampling.observe(sampling_ms * 1e-3);
+            }
+            row += count;
+            sample += count;
             
-            curvatures.push_back(curvature);
+            if (row == config_.max_batch_size) {
+                flush(row);
+                row = 0;
+            }
         }
     }
     
-    if (curvatures.empty()) return 0.0f;
+    if (row > 0) {
+        flush(row);
+    }
+}
+
+Trajectory TrajectoryGenerator::generate(const Waypoint& start, const Waypoint& end) {
+    // Stage a single row and run inference
+    std::vector<Trajectory> trajectories;
+    GenerationRequest request(start, end, 1);
+    generateRows(&request, 1, &trajectories, nullptr);
+    
+    return std::move(trajectories.front());
+}
+
+std::vector<Trajectory> TrajectoryGenerator::generateMultiple(const Waypoint& start,
+                                                              const Waypoint& end,
+                                                              int n_samples) {
+    std::vector<Trajectory> trajectories;
+    if (n_samples <= 0) return trajectories;
+    trajectories.reserve(n_samples);
+    
+    // Pack candidates into batches of at most max_batch_size rows
+    GenerationRequest request(start, end, n_samples);
+    generateRows(&request, 1, &trajectories, nullptr);
     
-    float sum = std::accumulate(curvatures.begin(), curvatures.end(), 0.0f);
-    return sum / curvatures.size();
+    return trajectories;
 }
 
-float computeSmoothnessScore(const Trajectory& trajectory) {
-    float avg_curvature = computeAverageCurvature(trajectory);
-    return 1.0f / (1.0f + avg_curvature);
+void TrajectoryGenerator::generateMultiple(const Waypoint& start,
+                                           const Waypoint& end,
+                                           int n_samples,
+                                           TrajectoryBatch& batch) {
+    GenerationRequest request(start, end, n_samples);
+    generateBatch(&request, 1, batch);
 }
 
-void printTrajectoryStats(const Trajectory& trajectory) {
-    float path_length = computePathLength(trajectory);
-    float avg_curvature = computeAverageCurvature(trajectory);
-    float smoothness = computeSmoothnessScore(trajectory);
+BatchResult TrajectoryGenerator::generateBatch(const GenerationRequest* requests,
+                                               size_t num_requests) {
+    BatchResult result;
+    result.offsets.reserve(num_requests + 1);
+    result.offsets.push_back(0);
     
-    // Compute straight-line distance
-    float dx = trajectory.back().x - trajectory.front().x;
-    float dy = trajectory.back().y - trajectory.front().y;
-    float dz = trajectory.back().z - trajectory.front().z;
-    float straight_dist = std::sqrt(dx*dx + dy*dy + dz*dz);
+    size_t total = 0;
+    for (size_t r = 0; r < num_requests; ++r) {
+        total += static_cast<size_t>(std::max(0, requests[r].n_samples));
+        result.offsets.push_back(total);
+    }
+    result.trajectories.reserve(total);
     
-    float efficiency = straight_dist / path_length;
+    generateRows(requests, num_requests, &result.trajectories, nullptr, &result.request_ids);
+    
+    return result;
+}
+
+void TrajectoryGenerator::generateBatch(const GenerationRequest* requests,
+                                        size_t num_requests,
+                                        TrajectoryBatch& batch) {
+    size_t total = 0;
+    for (size_t r = 0; r < num_requests; ++r) {
+        total += static_cast<size_t>(std::max(0, requests[r].n_samples));
+    }
+    
+    if (batch.seqLen() == output_seq_len_) {
+        batch.reserve(batch.size() + total);
+    }
     
-    std::cout << "Trajectory Statistics:" << std::endl;
-    std::cout << "  Path length: " << path_length << " m" << std::endl;
-    std::cout << "  Straight-line distance: " << straight_dist << " m" << std::endl;
-    std::cout << "  Efficiency: " << efficiency << std::endl;
-    std::cout << "  Avg curvature: " << avg_curvature << " rad/m" << std::endl;
-    std::cout << "  Smoothness score: " << smoothness << std::endl;
+    generateRows(requests, num_requests, nullptr, &batch);
 }
 
 } // namespace trajectory
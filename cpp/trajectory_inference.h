@@ -7,10 +7,13 @@
 #ifndef TRAJECTORY_INFERENCE_H
 #define TRAJECTORY_INFERENCE_H
 
+#include "latent_sampler.h"
 #include <vector>
 #include <string>
 #include <memory>
 #include <array>
+#include <functional>
+#include <cstdint>
 #include <onnxruntime_cxx_api.h>
 
 namespace trajectory {
@@ -27,11 +30,55 @@ struct Waypoint {
     Waypoint(float x_, float y_, float z_) : x(x_), y(y_), z(z_) {}
 };
 
+static_assert(sizeof(Waypoint) == 3 * sizeof(float),
+              "Waypoint must be laid out as three packed floats");
+
 /**
  * @brief Trajectory represented as sequence of waypoints
  */
 using Trajectory = std::vector<Waypoint>;
 
+/**
+ * @brief Non-owning view of a trajectory stored as contiguous x, y, z floats
+ * 
+ * A Trajectory and each row of a TrajectoryBatch share this [count, 3]
+ * layout, so the metrics functions accept either one without copying.
+ * A Trajectory converts implicitly; the view must not outlive it.
+ */
+struct TrajectoryView {
+    const float* xyz = nullptr;  // [count, 3]
+    size_t count = 0;
+    
+    TrajectoryView() = default;
+    TrajectoryView(const float* data, size_t n) : xyz(data), count(n) {}
+    TrajectoryView(const Trajectory& trajectory)
+        : xyz(trajectory.empty() ? nullptr : &trajectory[0].x), 
+          count(trajectory.size()) {}
+    
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    
+    Waypoint operator[](size_t i) const {
+        return Waypoint(xyz[i * 3 + 0], xyz[i * 3 + 1], xyz[i * 3 + 2]);
+    }
+    Waypoint front() const { return (*this)[0]; }
+    Waypoint back() const { return (*this)[count - 1]; }
+    
+    /**
+     * @brief Copy the viewed waypoints into an owning Trajectory
+     */
+    Trajectory toTrajectory() const {
+        Trajectory trajectory;
+        trajectory.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            trajectory.push_back((*this)[i]);
+        }
+        return trajectory;
+    }
+};
+
+class TrajectoryBatch;
+
 /**
  * @brief Normalization parameters for data preprocessing
  */
@@ -43,22 +90,293 @@ struct NormalizationParams {
         : mean({0.0f, 0.0f, 0.0f}), std({1.0f, 1.0f, 1.0f}) {}
 };
 
+/**
+ * @brief Numeric precision of the exported model variant
+ */
+enum class ModelPrecision {
+    FP32,   // <model>.onnx
+    FP16,   // <model>_fp16.onnx: float16 weights, float16 or float32 I/O
+    INT8    // <model>_int8.onnx: int8-quantized weights, float32 I/O
+};
+
+/**
+ * @brief Short name of a precision ("fp32", "fp16", "int8")
+ */
+const char* precisionName(ModelPrecision precision);
+
+/**
+ * @brief Path of a model variant next to the FP32 export
+ * 
+ * Inserts "_fp16" / "_int8" before the extension, e.g.
+ * models/trajectory_generator.onnx -> models/trajectory_generator_fp16.onnx.
+ * Paths that already carry the suffix are returned unchanged.
+ */
+std::string modelVariantPath(const std::string& model_path, ModelPrecision precision);
+
 /**
  * @brief Configuration for trajectory generator
+ * 
+ * When several generators share a host, give each num_threads equal to
+ * the cores it owns and turn allow_spinning off so idle workers sleep
+ * instead of burning CPU. Either pin each pool with thread_affinity (list
+ * cores of one NUMA node to keep a generator on it), or set
+ * use_global_thread_pool so every session in the process runs on one
+ * pool. The global pool is sized by the first generator that creates it.
  */
 struct GeneratorConfig {
     std::string model_path;
+    ModelPrecision precision = ModelPrecision::FP32;  // Variant of model_path to load
     int latent_dim = 64;
     int seq_len = 50;
-    int num_threads = 4;
-    bool use_gpu = false;
+    int num_threads = 4;         // Intra-op threads (0 = one per core)
+    int inter_op_threads = 0;    // Inter-op threads with parallel_execution (0 = ORT default)
+    bool parallel_execution = false; // Run independent graph branches concurrently (ORT_PARALLEL)
+    bool allow_spinning = true;  // Pool threads busy-wait for work before sleeping
+    std::string thread_affinity; // Intra-op pinning, num_threads - 1 groups: "1;2;3" or "0-3;4-7" ("" = off)
+    bool use_global_thread_pool = false; // Share one process-wide ORT pool instead of a pool per session
+    int max_batch_size = 32;     // Max trajectories packed into one ONNX Run
+    bool use_io_binding = false; // Bind pre-allocated I/O buffers once per batch size
+    bool use_gpu = false;        // Run on CUDA, falling back to CPU if unavailable
+    bool use_tensorrt = false;   // With use_gpu: try TensorRT first (CUDA covers unsupported nodes)
+    int gpu_device_id = 0;
+    std::string optimized_model_path; // Cache of the optimized graph, reused while newer than the model ("" = off)
+    uint64_t seed = 0;           // Latent RNG seed (0 = pick a random one; see getSeed())
+    std::string profile_prefix;  // Write an ORT profiling trace named <prefix>_<timestamp>.json ("" = off)
+    std::vector<std::string> input_names; // Latent, start and end inputs (empty = the model's inputs in order)
+    std::string output_name;     // Trajectory output ("" = the model's first output)
     
     GeneratorConfig() = default;
     GeneratorConfig(const std::string& path) : model_path(path) {}
 };
 
+/**
+ * @brief Contents of a model's JSON sidecar (<model>_normalization.json)
+ * 
+ * mean and std are required. The export also records latent_dim,
+ * seq_len, input_names and output_names; older sidecars without them
+ * leave those fields at 0 / empty.
+ */
+struct ModelMetadata {
+    NormalizationParams normalization;
+    int latent_dim = 0;
+    int seq_len = 0;
+    std::vector<std::string> input_names;
+    std::vector<std::string> output_names;
+};
+
+/**
+ * @brief Parse a model sidecar file
+ * @param path Path to the JSON file
+ * @return Parsed metadata
+ * @throws std::runtime_error if the file is missing, malformed or has invalid values
+ */
+ModelMetadata loadModelMetadata(const std::string& path);
+
+/**
+ * @brief Copy the model fields present in metadata into config
+ * 
+ * ModelSession checks the result against the loaded graph, so a sidecar
+ * that does not belong to the model fails at load time.
+ */
+void applyModelMetadata(const ModelMetadata& metadata, GeneratorConfig& config);
+
+/**
+ * @brief Request id meaning "assign the generator's next id"
+ */
+constexpr uint64_t kAutoRequestId = ~0ull;
+
+/**
+ * @brief One (start, end) request inside a heterogeneous batch
+ * 
+ * Latent vectors are a function of (seed, request_id, sample index), so a
+ * request replayed with the same seed and id reproduces its trajectories.
+ */
+struct GenerationRequest {
+    Waypoint start;
+    Waypoint end;
+    int n_samples = 1;
+    uint64_t request_id = kAutoRequestId;
+    
+    GenerationRequest() = default;
+    GenerationRequest(const Waypoint& s, const Waypoint& e, int n = 1,
+                      uint64_t id = kAutoRequestId)
+        : start(s), end(e), n_samples(n), request_id(id) {}
+};
+
+/**
+ * @brief Flat result arena for a batch of generation requests
+ * 
+ * All trajectories are stored back to back in request order. The
+ * trajectories of request i occupy the half-open index range
+ * [offsets[i], offsets[i + 1]) of the trajectories vector.
+ */
+struct BatchResult {
+    std::vector<Trajectory> trajectories;
+    std::vector<size_t> offsets;  // num_requests + 1 entries
+    std::vector<uint64_t> request_ids;  // Id each request was sampled under
+    
+    /**
+     * @brief Number of requests in the batch
+     */
+    size_t numRequests() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    
+    /**
+     * @brief Number of trajectories generated for a request
+     */
+    size_t count(size_t request) const { return offsets[request + 1] - offsets[request]; }
+    
+    /**
+     * @brief Access the j-th trajectory of a request
+     */
+    const Trajectory& at(size_t request, size_t j) const {
+        return trajectories[offsets[request] + j];
+    }
+};
+
+/**
+ * @brief Wall time a generator spent per stage, accumulated across calls
+ */
+struct GenerationStageTimes {
+    double sampling_ms = 0.0;      // Latent draws and condition normalization
+    double inference_ms = 0.0;     // Tensor setup and session Run
+    double postprocess_ms = 0.0;   // Denormalization (and Trajectory conversion)
+    size_t runs = 0;               // Session runs
+    size_t rows = 0;               // Trajectories generated
+};
+
+/**
+ * @brief ONNX Runtime environment and loaded model
+ * 
+ * Holds everything that is immutable after loading, so one instance can
+ * be shared by several TrajectoryGenerators running on different threads
+ * (Ort::Session::Run is thread-safe). The model is loaded once no matter
+ * how many generators use it.
+ */
+class ModelSession {
+public:
+    /**
+     * @brief Create the ORT environment and load config.model_path
+     * @param config Generator configuration (model path, threads, GPU)
+     */
+    explicit ModelSession(const GeneratorConfig& config);
+    
+    ~ModelSession();
+    
+    ModelSession(const ModelSession&) = delete;
+    ModelSession& operator=(const ModelSession&) = delete;
+    
+    /**
+     * @brief Loaded ONNX session
+     */
+    Ort::Session& session() { return *session_; }
+    
+    /**
+     * @brief Sequence length of the model output [batch, seq_len, 3]
+     * @return config.seq_len (a model with a different fixed length is rejected)
+     */
+    int outputSeqLen() const { return output_seq_len_; }
+    
+    const std::vector<const char*>& inputNames() const { return input_names_; }
+    const std::vector<const char*>& outputNames() const { return output_names_; }
+    
+    /**
+     * @brief Execution provider the session ended up on
+     * @return "TensorRT", "CUDA" or "CPU"
+     */
+    const std::string& executionProvider() const { return provider_; }
+    
+    /**
+     * @brief True if the model runs on a GPU provider
+     */
+    bool onGpu() const { return provider_ != "CPU"; }
+    
+    /**
+     * @brief CUDA device the session runs on (meaningful when onGpu())
+     */
+    int deviceId() const { return device_id_; }
+    
+    /**
+     * @brief True if the session was loaded from config.optimized_model_path
+     */
+    bool loadedFromCache() const { return loaded_from_cache_; }
+    
+    /**
+     * @brief Model file actually loaded (after variant resolution)
+     */
+    const std::string& modelPath() const { return model_path_; }
+    
+    /**
+     * @brief Precision variant the session was loaded as
+     */
+    ModelPrecision precision() const { return precision_; }
+    
+    /**
+     * @brief True if the model takes float16 inputs
+     */
+    bool halfInputs() const { return half_inputs_; }
+    
+    /**
+     * @brief True if the model returns float16 trajectories
+     */
+    bool halfOutput() const { return half_output_; }
+    
+    /**
+     * @brief True if the session records an ORT profile (config.profile_prefix)
+     */
+    bool profiling() const { return profiling_; }
+    
+    /**
+     * @brief Stop ORT profiling and write the trace
+     * 
+     * The trace (chrome://tracing JSON) covers every Run since the
+     * session was created. Call it while no other thread is running the
+     * session; later runs are no longer recorded.
+     * 
+     * @return Trace file path, or "" if the session was not profiling
+     */
+    std::string endProfiling();
+
+private:
+    /**
+     * @brief Load the model, through the optimized-graph cache if configured
+     */
+    void loadModel(const GeneratorConfig& config);
+    
+    /**
+     * @brief Create the session for a model file over session_options_
+     */
+    void createSession(const std::string& path);
+    
+    /**
+     * @brief Resolve I/O names and check the graph's shapes against config
+     */
+    void bindModelIO(const GeneratorConfig& config);
+    
+    std::shared_ptr<Ort::Env> env_;
+    std::unique_ptr<Ort::SessionOptions> session_options_;
+    std::unique_ptr<Ort::Session> session_;
+    
+    std::vector<std::string> input_name_storage_;
+    std::vector<std::string> output_name_storage_;
+    std::vector<const char*> input_names_;   // Point into the storage vectors
+    std::vector<const char*> output_names_;
+    int output_seq_len_;
+    std::string provider_;
+    int device_id_;
+    bool loaded_from_cache_;
+    std::string model_path_;
+    ModelPrecision precision_;
+    bool half_inputs_;
+    bool half_output_;
+    bool profiling_;
+};
+
 /**
  * @brief Main class for trajectory generation inference
+ * 
+ * A generator owns its RNG, staging buffers and I/O bindings and is not
+ * safe for concurrent calls. Use one generator per thread over a shared
+ * ModelSession, or a GeneratorPool (generator_pool.h).
  */
 class TrajectoryGenerator {
 public:
@@ -68,6 +386,14 @@ public:
      */
     explicit TrajectoryGenerator(const GeneratorConfig& config);
     
+    /**
+     * @brief Construct a generator over an already loaded model
+     * @param model Shared model session
+     * @param config Generator configuration (model_path and ORT options
+     *               are taken from whoever created the session)
+     */
+    TrajectoryGenerator(std::shared_ptr<ModelSession> model, const GeneratorConfig& config);
+    
     /**
      * @brief Destructor
      */
@@ -90,6 +416,11 @@ public:
     
     /**
      * @brief Generate multiple diverse trajectories
+     * 
+     * Candidates are packed into batches of up to config.max_batch_size
+     * rows, so n_samples trajectories cost ceil(n_samples / max_batch_size)
+     * ONNX runs instead of one run per trajectory.
+     * 
      * @param start Starting waypoint
      * @param end Ending waypoint
      * @param n_samples Number of trajectories to generate
@@ -99,19 +430,132 @@ public:
                                              const Waypoint& end,
                                              int n_samples);
     
+    /**
+     * @brief Generate trajectories for many (start, end) pairs at once
+     * 
+     * Rows from consecutive requests are fused into shared batches of up
+     * to config.max_batch_size, so a batch of R requests with S samples in
+     * total costs ceil(S / max_batch_size) ONNX runs.
+     * 
+     * @param requests Pointer to the first request
+     * @param num_requests Number of requests
+     * @return Flat result arena indexed by request
+     */
+    BatchResult generateBatch(const GenerationRequest* requests, size_t num_requests);
+    
+    /**
+     * @brief Generate trajectories for many (start, end) pairs at once
+     * @param requests Requests to process
+     * @return Flat result arena indexed by request
+     */
+    BatchResult generateBatch(const std::vector<GenerationRequest>& requests) {
+        return generateBatch(requests.data(), requests.size());
+    }
+    
+    /**
+     * @brief Generate multiple trajectories directly into a batch buffer
+     * 
+     * Rows are appended to the batch; ONNX output is written into the
+     * batch storage and denormalized in place, with no per-trajectory
+     * allocation or copy.
+     * 
+     * @param start Starting waypoint
+     * @param end Ending waypoint
+     * @param n_samples Number of trajectories to generate
+     * @param batch Output batch (rows appended)
+     */
+    void generateMultiple(const Waypoint& start,
+                          const Waypoint& end,
+                          int n_samples,
+                          TrajectoryBatch& batch);
+    
+    /**
+     * @brief Generate trajectories for many requests into a batch buffer
+     * 
+     * Rows are appended in request order, so the rows of request i start
+     * at the sum of n_samples over requests [0, i).
+     * 
+     * @param requests Pointer to the first request
+     * @param num_requests Number of requests
+     * @param batch Output batch (rows appended)
+     */
+    void generateBatch(const GenerationRequest* requests, size_t num_requests,
+                       TrajectoryBatch& batch);
+    
+    /**
+     * @brief Pre-run representative batch sizes before serving
+     * 
+     * The first Run of each input shape pays one-off allocation and kernel
+     * setup (and, with use_io_binding, builds that size's binding). Warming
+     * up moves that cost out of the first real request. Does not advance
+     * the latent RNG.
+     * 
+     * @param batch_sizes Sizes to run, clamped to [1, max_batch_size]
+     *                    (empty = 1 and max_batch_size)
+     */
+    void warmup(const std::vector<int>& batch_sizes = std::vector<int>());
+    
     /**
      * @brief Check if model is loaded and ready
      * @return True if ready for inference
      */
-    bool isReady() const { return session_ != nullptr; }
+    bool isReady() const { return model_ != nullptr; }
     
     /**
      * @brief Get sequence length of generated trajectories
      * @return Sequence length
      */
     int getSeqLen() const { return config_.seq_len; }
+    
+    /**
+     * @brief Get maximum number of trajectories per ONNX run
+     * @return Maximum batch size
+     */
+    int getMaxBatchSize() const { return config_.max_batch_size; }
+    
+    /**
+     * @brief Seed of the latent sampler (log it to replay requests later)
+     */
+    uint64_t getSeed() const { return sampler_.seed(); }
+    
+    /**
+     * @brief Id the next request without an explicit request_id will get
+     */
+    uint64_t nextRequestId() const { return next_request_id_; }
+    
+    /**
+     * @brief Set the id assigned to the next request without an explicit one
+     */
+    void setNextRequestId(uint64_t id) { next_request_id_ = id; }
+    
+    /**
+     * @brief Current normalization parameters
+     */
+    const NormalizationParams& getNormalization() const { return norm_params_; }
+    
+    /**
+     * @brief Replace the normalization parameters
+     */
+    void setNormalization(const NormalizationParams& params) { norm_params_ = params; }
+    
+    /**
+     * @brief Model session used by this generator
+     */
+    std::shared_ptr<ModelSession> getModelSession() const { return model_; }
+    
+    /**
+     * @brief Time spent per stage since construction or resetStageTimes()
+     */
+    const GenerationStageTimes& getStageTimes() const { return stage_times_; }
+    
+    void resetStageTimes() { stage_times_ = GenerationStageTimes(); }
 
 private:
+    /**
+     * @brief Size buffers for the model; shared by both constructors
+     */
+    void initialize();
+    
     /**
      * @brief Normalize a waypoint
      */
@@ -123,61 +567,138 @@ private:
     Waypoint denormalize(const std::array<float, 3>& normalized) const;
     
     /**
-     * @brief Sample from standard normal distribution
+     * @brief Denormalize contiguous [n_points, 3] model output in place
      */
-    std::vector<float> sampleLatent();
+    void denormalizeInPlace(float* xyz, size_t n_points) const;
     
     /**
-     * @brief Run ONNX inference
+     * @brief Fill consecutive rows of the input staging buffers
+     * @param row First row in the batch (row + count <= max_batch_size)
+     * @param count Number of rows
+     * @param request Request the rows belong to
+     * @param request_id Resolved id of the request
+     * @param first_sample Index of the first row's sample within the request
      */
-    Trajectory runInference(const std::vector<float>& latent,
-                           const Waypoint& start,
-                           const Waypoint& end);
-
+    void stageRows(int row, int count, const GenerationRequest& request,
+                   uint64_t request_id, int first_sample);
+    
+    /**
+     * @brief Run the ONNX session on the first batch_size staged rows
+     * @param batch_size Number of staged rows
+     * @param output Destination for [batch_size, output_seq_len_, 3] floats,
+     *               or nullptr to use generator-owned storage
+     * @return Pointer to normalized output, valid until the next call
+     */
+    const float* runSession(int batch_size, float* output = nullptr);
+    
+    /**
+     * @brief runSession() for models with float16 inputs or output
+     * 
+     * Staging stays float; values are converted at the session boundary.
+     * I/O binding is not used on this path.
+     */
+    const float* runMixedPrecision(int batch_size, float* output);
+    
+    /**
+     * @brief Stage all rows of the requests and run them in full batches
+     * 
+     * Exactly one of trajectories / batch is non-null and receives results.
+     * If request_ids is non-null it receives the id of every request.
+     */
+    void generateRows(const GenerationRequest* requests, size_t num_requests,
+                      std::vector<Trajectory>* trajectories,
+                      TrajectoryBatch* batch,
+                      std::vector<uint64_t>* request_ids = nullptr);
+    
+    /**
+     * @brief Run the first batch_size staged rows into a batch buffer
+     */
+    void runInference(int batch_size, TrajectoryBatch& batch);
+    
+    /**
+     * @brief Run ONNX inference on the first batch_size staged rows
+     * @param batch_size Number of staged rows
+     * @param trajectories Output vector, generated trajectories are appended
+     */
+    void runInference(int batch_size, std::vector<Trajectory>& trajectories);
+    
+    /**
+     * @brief Add one session run to the stage times
+     */
+    void recordRun(int batch_size, double inference_ms, double postprocess_ms);
+    
+    /**
+     * @brief Pre-bound input/output tensors for one batch size
+     * 
+     * Tensors are views over the generator's staging and output buffers,
+     * so once a binding exists, running that batch size allocates nothing.
+     */
+    struct BoundBatch {
+        Ort::IoBinding binding;
+        Ort::Value latent;
+        Ort::Value start;
+        Ort::Value end;
+        Ort::Value output;
+        const float* output_data = nullptr;  // Buffer the output is bound to
+        
+        BoundBatch() : binding(nullptr), latent(nullptr), start(nullptr), 
+                       end(nullptr), output(nullptr) {}
+    };
+    
+    /**
+     * @brief Get (creating on first use) the binding for a batch size
+     */
+    BoundBatch& getBinding(int batch_size);
+    
+    /**
+     * @brief Float buffer in pageable or device-pinned host memory
+     * 
+     * GPU sessions stage inputs and outputs in pinned memory so the
+     * transfers to and from the device are direct DMA copies.
+     */
+    class HostBuffer {
+    public:
+        void allocate(size_t count, Ort::Allocator* pinned);
+        
+        float* data() { return data_; }
+        size_t size() const { return size_; }
+        float& operator[](size_t i) { return data_[i]; }
+    
+    private:
+        std::vector<float> storage_;
+        std::unique_ptr<void, std::function<void(void*)>> pinned_;
+        float* data_ = nullptr;
+        size_t size_ = 0;
+    };
+    
     GeneratorConfig config_;
     NormalizationParams norm_params_;
     
-    // ONNX Runtime objects
-    std::unique_ptr<Ort::Env> env_;
-    std::unique_ptr<Ort::Session> session_;
-    std::unique_ptr<Ort::SessionOptions> session_options_;
+    // ONNX Runtime objects (session shared, memory info per generator)
+    std::shared_ptr<ModelSession> model_;
     Ort::MemoryInfo memory_info_;
+    std::unique_ptr<Ort::Allocator> pinned_allocator_;  // GPU sessions only
     
-    // Input/output names
-    std::vector<const char*> input_names_;
-    std::vector<const char*> output_names_;
+    // Input staging buffers, sized for max_batch_size rows
+    HostBuffer latent_buffer_;   // [max_batch_size, latent_dim]
+    HostBuffer start_buffer_;    // [max_batch_size, 3]
+    HostBuffer end_buffer_;      // [max_batch_size, 3]
     
-    // Random number generator state
-    unsigned int rng_state_;
+    // Output buffer and bindings used when config_.use_io_binding is set
+    HostBuffer output_buffer_;   // [max_batch_size, output_seq_len_, 3]
+    std::vector<std::unique_ptr<BoundBatch>> bindings_;  // indexed by batch size
+    std::vector<Ort::Float16_t> half_input_buffer_;      // float16-I/O models: latent|start|end
+    std::vector<Ort::Float16_t> half_output_buffer_;     // float16-I/O models: trajectory
+    std::vector<Ort::Value> output_tensors_;             // unbound-mode outputs
+    Ort::RunOptions run_options_;
+    int output_seq_len_;
+    
+    // Counter-based latent sampler and the next auto-assigned request id
+    LatentSampler sampler_;
+    uint64_t next_request_id_;
+    GenerationStageTimes stage_times_;
 };
 
-/**
- * @brief Compute path length of trajectory
- * @param trajectory Input trajectory
- * @return Total path length in meters
- */
-float computePathLength(const Trajectory& trajectory);
-
-/**
- * @brief Compute smoothness score of trajectory
- * @param trajectory Input trajectory
- * @return Smoothness score (higher is smoother)
- */
-float computeSmoothnessScore(const Trajectory& trajectory);
-
-/**
- * @brief Compute average curvature of trajectory
- * @param trajectory Input trajectory
- * @return Average curvature in rad/m
- */
-float computeAverageCurvature(const Trajectory& trajectory);
-
-/**
- * @brief Print trajectory statistics
- * @param trajectory Input trajectory
- */
-void printTrajectoryStats(const Trajectory& trajectory);
-
 } // namespace trajectory
 
 #endif // TRAJECTORY_INFERENCE_H
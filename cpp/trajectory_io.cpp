@@ -0,0 +1,539 @@
+/**
+ * @file trajectory_io.cpp
+ * @brief Implementation of the binary trajectory writer and reader
+ */
+
+#include "trajectory_io.h"
+#include "trajectory_batch.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace trajectory {
+
+namespace {
+
+constexpr char kMagic[8] = {'T', 'R', 'A', 'J', 'B', 'I', 'N', '\0'};
+constexpr uint32_t kVersion = 1;
+
+/**
+ * @brief On-disk file header
+ * 
+ * info_offset is 0 until the writer closes the file.
+ */
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t seq_len;
+    uint64_t count;
+    uint64_t data_offset;
+    uint64_t info_offset;
+    uint64_t seed;
+    uint8_t reserved[16];
+};
+
+static_assert(sizeof(FileHeader) == 64, "FileHeader is stored on disk and must stay 64 bytes");
+
+FileHeader makeHeader(int seq_len, uint64_t seed) {
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.seq_len = static_cast<uint32_t>(seq_len);
+    header.data_offset = sizeof(FileHeader);
+    header.seed = seed;
+    return header;
+}
+
+} // namespace
+
+// ============================================================================
+// TrajectoryWriter Implementation
+// ============================================================================
+
+TrajectoryWriter::TrajectoryWriter(size_t buffer_bytes)
+    : buffer_bytes_(std::max<size_t>(buffer_bytes, 4096))
+    , seq_len_(0)
+    , seed_(0)
+    , busy_(false)
+    , failed_(false)
+    , stop_(false)
+{
+}
+
+TrajectoryWriter::~TrajectoryWriter() {
+    if (isOpen()) {
+        close();
+    }
+}
+
+bool TrajectoryWriter::open(const std::string& path, int seq_len, uint64_t seed) {
+    if (isOpen()) {
+        close();
+    }
+    
+    if (seq_len < 1) {
+        std::cerr << "Invalid sequence length for binary file: " << seq_len << std::endl;
+        return false;
+    }
+    
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        std::cerr << "Failed to create binary file: " << path << std::endl;
+        return false;
+    }
+    
+    path_ = path;
+    seq_len_ = seq_len;
+    seed_ = seed;
+    infos_.clear();
+    failed_ = false;
+    stop_ = false;
+    busy_ = false;
+    
+    const FileHeader header = makeHeader(seq_len_, seed_);
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    
+    filling_.clear();
+    filling_.reserve(buffer_bytes_);
+    writing_.clear();
+    writing_.reserve(buffer_bytes_);
+    
+    writer_ = std::thread([this]() { writerLoop(); });
+    return true;
+}
+
+bool TrajectoryWriter::append(const TrajectoryView& trajectory, const TrajectoryRecordInfo& info) {
+    if (trajectory.size() != static_cast<size_t>(seq_len_)) {
+        std::cerr << "Trajectory length " << trajectory.size() << " does not match file ("
+                  << seq_len_ << ")" << std::endl;
+        return false;
+    }
+    return appendRows(trajectory.xyz, 1, &info);
+}
+
+bool TrajectoryWriter::append(const TrajectoryBatch& batch, const TrajectoryRecordInfo* infos) {
+    if (batch.empty()) return isOpen() && !failed_;
+    if (batch.seqLen() != seq_len_) {
+        std::cerr << "Batch sequence length " << batch.seqLen() << " does not match file ("
+                  << seq_len_ << ")" << std::endl;
+        return false;
+    }
+    return appendRows(batch.data(), batch.size(), infos);
+}
+
+bool TrajectoryWriter::append(const TrajectoryBatch& batch, const GenerationRequest* requests,
+                              size_t num_requests) {
+    std::vector<TrajectoryRecordInfo> infos;
+    infos.reserve(batch.size());
+    for (size_t r = 0; r < num_requests; ++r) {
+        TrajectoryRecordInfo info;
+        info.start = requests[r].start;
+        info.end = requests[r].end;
+        info.request_id = requests[r].request_id;
+        for (int s = 0; s < requests[r].n_samples; ++s) {
+            info.sample = static_cast<uint32_t>(s);
+            infos.push_back(info);
+        }
+    }
+    
+    if (infos.size() != batch.size()) {
+        std::cerr << "Requests describe " << infos.size() << " rows, batch has "
+                  << batch.size() << std::endl;
+        return false;
+    }
+    return append(batch, infos.data());
+}
+
+bool TrajectoryWriter::appendRows(const float* rows, size_t n_rows,
+                                  const TrajectoryRecordInfo* infos) {
+    if (!isOpen()) return false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (failed_) return false;
+    }
+    
+    if (infos) {
+        infos_.insert(infos_.end(), infos, infos + n_rows);
+    } else {
+        infos_.resize(infos_.size() + n_rows);
+    }
+    
+    // Copy into the staging buffer, handing it to the writer whenever it fills
+    const char* bytes = reinterpret_cast<const char*>(rows);
+    size_t remaining = n_rows * static_cast<size_t>(seq_len_) * 3 * sizeof(float);
+    while (remaining > 0) {
+        const size_t chunk = std::min(remaining, buffer_bytes_ - filling_.size());
+        filling_.insert(filling_.end(), bytes, bytes + chunk);
+        bytes += chunk;
+        remaining -= chunk;
+        
+        if (filling_.size() == buffer_bytes_) {
+            submitBuffer();
+        }
+    }
+    
+    return true;
+}
+
+void TrajectoryWriter::submitBuffer() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return !busy_; });
+    filling_.swap(writing_);
+    filling_.clear();
+    busy_ = true;
+    lock.unlock();
+    cv_.notify_all();
+}
+
+void TrajectoryWriter::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return !busy_; });
+}
+
+void TrajectoryWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this]() { return busy_ || stop_; });
+        if (!busy_) return;  // stopping with nothing pending
+        
+        // writing_ belongs to this thread until busy_ is cleared
+        lock.unlock();
+        file_.write(writing_.data(), static_cast<std::streamsize>(writing_.size()));
+        const bool ok = static_cast<bool>(file_);
+        lock.lock();
+        
+        if (!ok && !failed_) {
+            failed_ = true;
+            std::cerr << "Failed to write binary file: " << path_ << std::endl;
+        }
+        busy_ = false;
+        cv_.notify_all();
+    }
+}
+
+bool TrajectoryWriter::close() {
+    if (!isOpen()) return false;
+    
+    if (!filling_.empty()) {
+        submitBuffer();
+    }
+    waitIdle();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    writer_.join();
+    
+    bool ok = !failed_;
+    if (ok) {
+        // Record table, 8-byte aligned after the trajectory block
+        const uint64_t data_bytes = static_cast<uint64_t>(infos_.size()) * seq_len_ * 3 * sizeof(float);
+        uint64_t info_offset = sizeof(FileHeader) + data_bytes;
+        const uint64_t padding = (8 - info_offset % 8) % 8;
+        const char zeros[8] = {};
+        file_.write(zeros, static_cast<std::streamsize>(padding));
+        info_offset += padding;
+        file_.write(reinterpret_cast<const char*>(infos_.data()),
+                    static_cast<std::streamsize>(infos_.size() * sizeof(TrajectoryRecordInfo)));
+        
+        FileHeader header = makeHeader(seq_len_, seed_);
+        header.count = infos_.size();
+        header.info_offset = info_offset;
+        file_.seekp(0);
+        file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file_.flush();
+        
+        ok = static_cast<bool>(file_);
+        if (!ok) {
+            std::cerr << "Failed to finalize binary file: " << path_ << std::endl;
+        }
+    }
+    
+    file_.close();
+    infos_.clear();
+    infos_.shrink_to_fit();
+    return ok;
+}
+
+// ============================================================================
+// TrajectoryReader Implementation
+// ============================================================================
+
+TrajectoryReader::TrajectoryReader()
+    : base_(nullptr)
+    , mapped_bytes_(0)
+#ifdef _WIN32
+    , file_handle_(nullptr)
+    , mapping_handle_(nullptr)
+#endif
+    , data_(nullptr)
+    , infos_(nullptr)
+    , count_(0)
+    , seq_len_(0)
+    , seed_(0)
+{
+}
+
+TrajectoryReader::~TrajectoryReader() {
+    close();
+}
+
+bool TrajectoryReader::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open binary file: " << path << std::endl;
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file, &file_size);
+    const size_t bytes = static_cast<size_t>(file_size.QuadPart);
+    
+    HANDLE mapping = bytes ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    void* base = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!base) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        std::cerr << "Failed to map binary file: " << path << std::endl;
+        return false;
+    }
+    file_handle_ = file;
+    mapping_handle_ = mapping;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open binary file: " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    const size_t bytes = ::fstat(fd, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+    
+    void* base = bytes ? ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);  // the mapping keeps the file referenced
+    if (base == MAP_FAILED) {
+        std::cerr << "Failed to map binary file: " << path << std::endl;
+        return false;
+    }
+    
+    // Archives are mostly scanned front to back; ask for aggressive readahead
+    ::madvise(base, bytes, MADV_SEQUENTIAL);
+#endif
+
+    base_ = base;
+    mapped_bytes_ = bytes;
+    
+    FileHeader header;
+    if (bytes < sizeof(header)) {
+        std::cerr << "Not a trajectory file (too short): " << path << std::endl;
+        close();
+        return false;
+    }
+    std::memcpy(&header, base_, sizeof(header));
+    
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.seq_len == 0 || header.seq_len > static_cast<uint32_t>(std::numeric_limits<int>::max()) ||
+        header.data_offset != sizeof(FileHeader)) {
+        std::cerr << "Not a trajectory file (bad header): " << path << std::endl;
+        close();
+        return false;
+    }
+    
+    seq_len_ = static_cast<int>(header.seq_len);
+    seed_ = header.seed;
+    
+    const char* file_bytes = static_cast<const char*>(base_);
+    const size_t record_bytes = stride() * sizeof(float);
+    const size_t available = bytes - sizeof(FileHeader);
+    data_ = reinterpret_cast<const float*>(file_bytes + header.data_offset);
+    
+    if (header.info_offset == 0) {
+        // Writer did not finish: keep the complete trajectories
+        count_ = available / record_bytes;
+        std::cerr << "Warning: " << path << " was not closed; recovered " << count_
+                  << " trajectories without record info" << std::endl;
+        return true;
+    }
+    
+    // Bound count by division before multiplying, so a corrupt header cannot
+    // overflow its way past the size checks
+    if (header.count > available / record_bytes || header.info_offset % 8 != 0 ||
+        header.info_offset > bytes ||
+        header.count > (bytes - header.info_offset) / sizeof(TrajectoryRecordInfo) ||
+        header.info_offset < sizeof(FileHeader) + header.count * record_bytes) {
+        std::cerr << "Corrupt trajectory file (size mismatch): " << path << std::endl;
+        close();
+        return false;
+    }
+    
+    count_ = static_cast<size_t>(header.count);
+    infos_ = reinterpret_cast<const TrajectoryRecordInfo*>(file_bytes + header.info_offset);
+    return true;
+}
+
+void TrajectoryReader::close() {
+    if (base_) {
+#ifdef _WIN32
+        UnmapViewOfFile(base_);
+        CloseHandle(static_cast<HANDLE>(mapping_handle_));
+        CloseHandle(static_cast<HANDLE>(file_handle_));
+        mapping_handle_ = nullptr;
+        file_handle_ = nullptr;
+#else
+        ::munmap(base_, mapped_bytes_);
+#endif
+    }
+    base_ = nullptr;
+    mapped_bytes_ = 0;
+    data_ = nullptr;
+    infos_ = nullptr;
+    count_ = 0;
+    seq_len_ = 0;
+    seed_ = 0;
+}
+
+void TrajectoryReader::copyTo(TrajectoryBatch& batch, size_t first, size_t count) const {
+    first = std::min(first, count_);
+    count = std::min(count, count_ - first);
+    
+    batch.reset(seq_len_, count);
+    if (count == 0) return;
+    
+    float* dest = batch.appendRows(count);
+    std::memcpy(dest, data_ + first * stride(), count * stride() * sizeof(float));
+}
+
+TrajectoryChunk TrajectoryReader::chunk(size_t index, size_t chunk_rows) const {
+    TrajectoryChunk result;
+    result.index = index;
+    result.seq_len = seq_len_;
+    result.first = std::min(index * chunk_rows, count_);
+    result.count = std::min(chunk_rows, count_ - result.first);
+    result.rows = data_ ? data_ + result.first * stride() : nullptr;
+    result.infos = infos_ ? infos_ + result.first : nullptr;
+    return result;
+}
+
+void TrajectoryReader::forEachChunk(size_t chunk_rows,
+                                    const std::function<void(const TrajectoryChunk&)>& fn,
+                                    bool parallel) const {
+    const size_t n_chunks = numChunks(chunk_rows);
+    if (n_chunks == 0) return;
+    
+    if (!parallel || n_chunks == 1) {
+        for (size_t c = 0; c < n_chunks; ++c) {
+            fn(chunk(c, chunk_rows));
+        }
+        return;
+    }
+    
+    ThreadPool::shared().parallelFor(0, n_chunks, 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) {
+            fn(chunk(c, chunk_rows));
+        }
+    });
+}
+
+// ============================================================================
+// CSV Import
+// ============================================================================
+
+bool loadTrajectoryCSV(const std::string& path, Trajectory& trajectory) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    trajectory.clear();
+    
+    std::string line;
+    std::getline(file, line);  // header
+    
+    while (std::getline(file, line)) {
+        if (line.empty() || line == "\r") continue;
+        
+        // Waypoint,X,Y,Z
+        std::istringstream row(line);
+        std::string index, x, y, z;
+        if (!std::getline(row, index, ',') || !std::getline(row, x, ',') ||
+            !std::getline(row, y, ',') || !std::getline(row, z)) {
+            std::cerr << "Malformed CSV row in " << path << ": " << line << std::endl;
+            return false;
+        }
+        
+        try {
+            trajectory.emplace_back(std::stof(x), std::stof(y), std::stof(z));
+        } catch (const std::exception&) {
+            std::cerr << "Malformed CSV row in " << path << ": " << line << std::endl;
+            return false;
+        }
+    }
+    
+    return !trajectory.empty();
+}
+
+bool convertCSVToBinary(const std::string& base_filename, const std::string& output_path,
+                        size_t* converted) {
+    if (converted) *converted = 0;
+    
+    TrajectoryWriter writer;
+    Trajectory trajectory;
+    size_t n = 0;
+    
+    for (;;) {
+        const std::string path = base_filename + "_" + std::to_string(n + 1) + ".csv";
+        if (!std::ifstream(path).good()) break;
+        
+        if (!loadTrajectoryCSV(path, trajectory)) {
+            std::cerr << "Failed to read CSV file: " << path << std::endl;
+            return false;
+        }
+        
+        if (n == 0 && !writer.open(output_path, static_cast<int>(trajectory.size()))) {
+            return false;
+        }
+        
+        TrajectoryRecordInfo info;
+        info.start = trajectory.front();
+        info.end = trajectory.back();
+        info.sample = static_cast<uint32_t>(n);
+        
+        if (!writer.append(trajectory, info)) {
+            std::cerr << "Failed to convert " << path << std::endl;
+            writer.close();
+            return false;
+        }
+        ++n;
+    }
+    
+    if (n == 0) {
+        std::cerr << "No CSV files found for: " << base_filename << "_1.csv" << std::endl;
+        return false;
+    }
+    
+    if (!writer.close()) return false;
+    
+    if (converted) *converted = n;
+    return true;
+}
+
+} // namespace trajectory
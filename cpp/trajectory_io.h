@@ -0,0 +1,307 @@
+/**
+ * @file trajectory_io.h
+ * @brief Streaming binary trajectory files and a memory-mapped reader
+ * @author Mission Planner Team
+ * 
+ * Dataset runs produce millions of trajectories; formatting each one as a
+ * CSV file dominates the run. The binary format stores them as one
+ * [N, seq_len, 3] float block, the TrajectoryBatch layout, so writing is
+ * a memcpy into a buffer and reading is an mmap:
+ * 
+ *   [header, 64 B] [N * seq_len * 3 floats] [N * TrajectoryRecordInfo]
+ * 
+ * The record table is written by close(). A file whose writer never
+ * closed it still opens: its complete trajectories are recovered from the
+ * file size, without record info.
+ * 
+ * All values are little-endian, as written by x86-64 and AArch64 hosts.
+ */
+
+#ifndef TRAJECTORY_IO_H
+#define TRAJECTORY_IO_H
+
+#include "trajectory_inference.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace trajectory {
+
+class TrajectoryBatch;
+
+/**
+ * @brief Per-trajectory metadata stored in the record table
+ */
+struct TrajectoryRecordInfo {
+    Waypoint start;                          // Requested start position
+    Waypoint end;                            // Requested end position
+    uint64_t request_id = kAutoRequestId;    // Latent stream (see GenerationRequest)
+    uint32_t sample = 0;                     // Sample index within the request
+    float score = 0.0f;                      // Caller-defined (e.g. ranking score)
+};
+
+static_assert(sizeof(TrajectoryRecordInfo) == 40,
+              "TrajectoryRecordInfo is stored on disk and must stay 40 bytes");
+
+/**
+ * @brief Append-only binary trajectory writer with background I/O
+ * 
+ * Appends copy into a staging buffer; full buffers are written by a
+ * background thread while the caller fills the other one. Record info is
+ * kept in memory (40 bytes per trajectory) until close().
+ * 
+ * Not safe for concurrent appends.
+ */
+class TrajectoryWriter {
+public:
+    /**
+     * @param buffer_bytes Size of each of the two staging buffers
+     */
+    explicit TrajectoryWriter(size_t buffer_bytes = 4u << 20);
+    
+    /**
+     * @brief Close the file if still open
+     */
+    ~TrajectoryWriter();
+    
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+    
+    /**
+     * @brief Create (or truncate) a file and write its header
+     * @param path Output file
+     * @param seq_len Waypoints per trajectory
+     * @param seed Latent seed recorded in the header (0 = unknown)
+     * @return true if the file was created
+     */
+    bool open(const std::string& path, int seq_len, uint64_t seed = 0);
+    
+    /**
+     * @brief Append one trajectory
+     * @return false if it has the wrong length or a write failed
+     */
+    bool append(const TrajectoryView& trajectory,
+                const TrajectoryRecordInfo& info = TrajectoryRecordInfo());
+    
+    /**
+     * @brief Append every row of a batch
+     * @param batch Trajectories
+     * @param infos Record info per row, or nullptr for defaults
+     * @return false if the batch has the wrong length or a write failed
+     */
+    bool append(const TrajectoryBatch& batch, const TrajectoryRecordInfo* infos = nullptr);
+    
+    /**
+     * @brief Append the rows of a generateBatch() call with their requests
+     * 
+     * Rows are matched to requests in order (n_samples each), filling in
+     * start, end, request id and sample index.
+     */
+    bool append(const TrajectoryBatch& batch, const GenerationRequest* requests,
+                size_t num_requests);
+    
+    /**
+     * @brief Write the record table, finalize the header and close
+     * @return true if every write succeeded
+     */
+    bool close();
+    
+    bool isOpen() const { return file_.is_open(); }
+    
+    /**
+     * @brief Trajectories appended so far
+     */
+    size_t size() const { return infos_.size(); }
+    
+    int seqLen() const { return seq_len_; }
+
+private:
+    bool appendRows(const float* rows, size_t n_rows, const TrajectoryRecordInfo* infos);
+    void submitBuffer();
+    void waitIdle();
+    void writerLoop();
+    
+    size_t buffer_bytes_;
+    std::ofstream file_;
+    std::string path_;
+    int seq_len_;
+    uint64_t seed_;
+    std::vector<TrajectoryRecordInfo> infos_;
+    
+    std::vector<char> filling_;   // Owned by the caller thread
+    std::vector<char> writing_;   // Owned by the writer thread while busy_
+    bool busy_;
+    bool failed_;
+    bool stop_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread writer_;
+};
+
+/**
+ * @brief Contiguous run of rows from a TrajectoryReader (zero-copy)
+ */
+struct TrajectoryChunk {
+    size_t index = 0;                              // Chunk number
+    size_t first = 0;                              // First row in the file
+    size_t count = 0;                              // Rows in the chunk
+    int seq_len = 0;
+    const float* rows = nullptr;                   // [count, seq_len, 3]
+    const TrajectoryRecordInfo* infos = nullptr;   // count entries, or nullptr if recovered
+    
+    size_t size() const { return count; }
+    
+    TrajectoryView operator[](size_t i) const {
+        return TrajectoryView(rows + i * static_cast<size_t>(seq_len) * 3,
+                              static_cast<size_t>(seq_len));
+    }
+};
+
+/**
+ * @brief Read-only memory-mapped view of a binary trajectory file
+ * 
+ * Pages are loaded on demand, so archives larger than RAM can be scanned
+ * chunk by chunk.
+ */
+class TrajectoryReader {
+public:
+    TrajectoryReader();
+    ~TrajectoryReader();
+    
+    TrajectoryReader(const TrajectoryReader&) = delete;
+    TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+    
+    /**
+     * @brief Map a file written by TrajectoryWriter
+     * @param path Input file
+     * @return true if the file was mapped and its header is valid
+     */
+    bool open(const std::string& path);
+    
+    /**
+     * @brief Unmap the file (views become invalid)
+     */
+    void close();
+    
+    bool isOpen() const { return base_ != nullptr; }
+    
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    int seqLen() const { return seq_len_; }
+    
+    /**
+     * @brief Latent seed recorded by the writer (0 = unknown)
+     */
+    uint64_t seed() const { return seed_; }
+    
+    /**
+     * @brief True if the writer did not close the file
+     * 
+     * The trajectories were recovered from the file size and there is no
+     * record info.
+     */
+    bool recovered() const { return infos_ == nullptr && count_ > 0; }
+    
+    /**
+     * @brief Raw [size, seq_len, 3] block (valid while open)
+     */
+    const float* data() const { return data_; }
+    
+    /**
+     * @brief Zero-copy view of trajectory i (valid while open)
+     */
+    TrajectoryView view(size_t i) const {
+        return TrajectoryView(data_ + i * stride(), static_cast<size_t>(seq_len_));
+    }
+    TrajectoryView operator[](size_t i) const { return view(i); }
+    
+    /**
+     * @brief Record info of trajectory i, or nullptr for a recovered file
+     */
+    const TrajectoryRecordInfo* info(size_t i) const { return infos_ ? &infos_[i] : nullptr; }
+    
+    /**
+     * @brief Copy trajectories [first, first + count) into a batch
+     * 
+     * The batch is reset to the file's sequence length. Use this to run
+     * the batch metrics on part of a file.
+     */
+    void copyTo(TrajectoryBatch& batch, size_t first, size_t count) const;
+    
+    /**
+     * @brief Number of chunks of chunk_rows rows (the last may be shorter)
+     */
+    size_t numChunks(size_t chunk_rows) const {
+        return chunk_rows ? (count_ + chunk_rows - 1) / chunk_rows : 0;
+    }
+    
+    /**
+     * @brief Chunk index of chunk_rows rows
+     */
+    TrajectoryChunk chunk(size_t index, size_t chunk_rows) const;
+    
+    /**
+     * @brief Call fn for every chunk of chunk_rows rows
+     * 
+     * With parallel set, chunks are spread over ThreadPool::shared() and
+     * fn runs concurrently in no particular order; use chunk.index to
+     * keep per-chunk results deterministic.
+     * 
+     * @param chunk_rows Rows per chunk (>= 1)
+     * @param fn Called once per chunk
+     * @param parallel Process chunks on the shared pool
+     */
+    void forEachChunk(size_t chunk_rows, const std::function<void(const TrajectoryChunk&)>& fn,
+                      bool parallel = true) const;
+
+private:
+    size_t stride() const { return static_cast<size_t>(seq_len_) * 3; }
+    
+    void* base_;
+    size_t mapped_bytes_;
+#ifdef _WIN32
+    void* file_handle_;
+    void* mapping_handle_;
+#endif
+    const float* data_;
+    const TrajectoryRecordInfo* infos_;
+    size_t count_;
+    int seq_len_;
+    uint64_t seed_;
+};
+
+/**
+ * @brief Load one trajectory from a CSV file written by saveToCSV()
+ * 
+ * Expects a "Waypoint,X,Y,Z" header followed by one row per waypoint.
+ * 
+ * @param path CSV file
+ * @param trajectory Receives the waypoints
+ * @return true if the file was read and every row parsed
+ */
+bool loadTrajectoryCSV(const std::string& path, Trajectory& trajectory);
+
+/**
+ * @brief Convert a series of CSV trajectories to one binary file
+ * 
+ * Reads base_1.csv, base_2.csv, ... (the saveToCSV() naming) until the
+ * next file is missing. Start and end of each record are taken from the
+ * trajectory's first and last waypoint.
+ * 
+ * @param base_filename Prefix passed to saveToCSV()
+ * @param output_path Binary file to write
+ * @param converted Receives the number of trajectories written (optional)
+ * @return true if at least one file was converted and all had the same length
+ */
+bool convertCSVToBinary(const std::string& base_filename, const std::string& output_path,
+                        size_t* converted = nullptr);
+                        
+} // namespace trajectory
+
+#endif // TRAJECTORY_IO_H
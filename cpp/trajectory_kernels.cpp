@@ -0,0 +1,237 @@
+/**
+ * @file trajectory_kernels.cpp
+ * @brief Scalar/NEON metric kernels and runtime dispatch
+ */
+
+#include "trajectory_kernels.h"
+#include "trajectory_kernels_simd.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#if defined(__aarch64__) && defined(__ARM_NEON) && !defined(TRAJECTORY_DISABLE_SIMD_KERNELS)
+#include <arm_neon.h>
+#define TRAJECTORY_HAVE_NEON_KERNELS 1
+#endif
+
+#if defined(TRAJECTORY_HAVE_AVX2_KERNELS) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace trajectory {
+
+namespace {
+
+struct ScalarOps {
+    using V = float;
+    static constexpr int W = 1;
+    
+    static V zero() { return 0.0f; }
+    static V set1(float v) { return v; }
+    static V load(const float* p) { return *p; }
+    static void store(float* p, V v) { *p = v; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+    static V sqrt(V a) { return std::sqrt(a); }
+    static V min(V a, V b) { return std::min(a, b); }
+    static V max(V a, V b) { return std::max(a, b); }
+    static V abs(V a) { return std::fabs(a); }
+    static V gt(V a, V b) { return a > b ? 1.0f : 0.0f; }
+    static V lt(V a, V b) { return a < b ? 1.0f : 0.0f; }
+    static V andMask(V a, V b) { return (a != 0.0f && b != 0.0f) ? 1.0f : 0.0f; }
+    static V select(V m, V a, V b) { return m != 0.0f ? a : b; }
+    static V acosPrecise(V x) { return std::acos(x); }
+};
+
+#ifdef TRAJECTORY_HAVE_NEON_KERNELS
+struct NeonOps {
+    using V = float32x4_t;
+    static constexpr int W = 4;
+    
+    static V zero() { return vdupq_n_f32(0.0f); }
+    static V set1(float v) { return vdupq_n_f32(v); }
+    static V load(const float* p) { return vld1q_f32(p); }
+    static void store(float* p, V v) { vst1q_f32(p, v); }
+    static V add(V a, V b) { return vaddq_f32(a, b); }
+    static V sub(V a, V b) { return vsubq_f32(a, b); }
+    static V mul(V a, V b) { return vmulq_f32(a, b); }
+    static V div(V a, V b) { return vdivq_f32(a, b); }
+    static V sqrt(V a) { return vsqrtq_f32(a); }
+    static V min(V a, V b) { return vminq_f32(a, b); }
+    static V max(V a, V b) { return vmaxq_f32(a, b); }
+    static V abs(V a) { return vabsq_f32(a); }
+    static V gt(V a, V b) { return vreinterpretq_f32_u32(vcgtq_f32(a, b)); }
+    static V lt(V a, V b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+    static V andMask(V a, V b) {
+        return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+    }
+    static V select(V m, V a, V b) { return vbslq_f32(vreinterpretq_u32_f32(m), a, b); }
+    static V acosPrecise(V x) { return polyAcos<NeonOps, false>(x); }
+};
+#endif
+
+bool cpuSupportsAvx2() {
+#if defined(TRAJECTORY_HAVE_AVX2_KERNELS)
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    
+    __cpuid(info, 1);
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!fma || !osxsave) return false;
+    
+    // OS must save YMM state
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#else
+    return false;
+#endif
+}
+
+std::atomic<int>& activeIsaSlot() {
+    static std::atomic<int> isa(static_cast<int>(detectKernelIsa()));
+    return isa;
+}
+
+} // namespace
+
+float* kernelScratch(size_t n) {
+    thread_local std::vector<float> scratch;
+    if (scratch.size() < n) {
+        scratch.resize(n);
+    }
+    return scratch.data();
+}
+
+KernelIsa detectKernelIsa() {
+    if (cpuSupportsAvx2()) return KernelIsa::AVX2;
+#ifdef TRAJECTORY_HAVE_NEON_KERNELS
+    return KernelIsa::NEON;
+#else
+    return KernelIsa::Scalar;
+#endif
+}
+
+KernelIsa activeKernelIsa() {
+    return static_cast<KernelIsa>(activeIsaSlot().load(std::memory_order_relaxed));
+}
+
+bool setKernelIsa(KernelIsa isa) {
+    bool supported = (isa == KernelIsa::Scalar);
+    if (isa == KernelIsa::AVX2) supported = cpuSupportsAvx2();
+#ifdef TRAJECTORY_HAVE_NEON_KERNELS
+    if (isa == KernelIsa::NEON) supported = true;
+#endif
+
+    if (!supported) return false;
+    
+    activeIsaSlot().store(static_cast<int>(isa), std::memory_order_relaxed);
+    return true;
+}
+
+const char* kernelIsaName(KernelIsa isa) {
+    switch (isa) {
+        case KernelIsa::AVX2: return "AVX2";
+        case KernelIsa::NEON: return "NEON";
+        default: return "scalar";
+    }
+}
+
+float fastAcos(float x) {
+    x = std::max(-1.0f, std::min(1.0f, x));
+    return polyAcos<ScalarOps, true>(x);
+}
+
+void kernelPathLengths(const float* rows, size_t n, int seq_len, float* out) {
+    switch (activeKernelIsa()) {
+#ifdef TRAJECTORY_HAVE_AVX2_KERNELS
+        case KernelIsa::AVX2: return avx2::pathLengths(rows, n, seq_len, out);
+#endif
+#ifdef TRAJECTORY_HAVE_NEON_KERNELS
+        case KernelIsa::NEON: return pathLengthsImpl<NeonOps>(rows, n, seq_len, out);
+#endif
+        default: return pathLengthsImpl<ScalarOps>(rows, n, seq_len, out);
+    }
+}
+
+void kernelCurvatureStats(const float* rows, size_t n, int seq_len,
+                          bool fast_acos, float* avg_out, float* max_out) {
+    switch (activeKernelIsa()) {
+#ifdef TRAJECTORY_HAVE_AVX2_KERNELS
+        case KernelIsa::AVX2:
+            return avx2::curvatureStats(rows, n, seq_len, fast_acos, avg_out, max_out);
+#endif
+#ifdef TRAJECTORY_HAVE_NEON_KERNELS
+        case KernelIsa::NEON:
+            return curvatureStatsImpl<NeonOps>(rows, n, seq_len, fast_acos, avg_out, max_out);
+#endif
+        default:
+            return curvatureStatsImpl<ScalarOps>(rows, n, seq_len, fast_acos, avg_out, max_out);
+    }
+}
+
+void kernelFusedMetrics(const float* rows, size_t n, int seq_len,
+                        bool fast_acos, const FusedMetricsOut& out) {
+    switch (activeKernelIsa()) {
+#ifdef TRAJECTORY_HAVE_AVX2_KERNELS
+        case KernelIsa::AVX2:
+            return avx2::fusedMetrics(rows, n, seq_len, fast_acos, out);
+#endif
+#ifdef TRAJECTORY_HAVE_NEON_KERNELS
+        case KernelIsa::NEON:
+            return fusedMetricsImpl<NeonOps>(rows, n, seq_len, fast_acos, out);
+#endif
+        default:
+            return fusedMetricsImpl<ScalarOps>(rows, n, seq_len, fast_acos, out);
+    }
+}
+
+void kernelSecondOrderSmoothness(const float* rows, size_t n, int seq_len, float* out) {
+    switch (activeKernelIsa()) {
+#ifdef TRAJECTORY_HAVE_AVX2_KERNELS
+        case KernelIsa::AVX2: return avx2::secondOrderSmoothness(rows, n, seq_len, out);
+#endif
+#ifdef TRAJECTORY_HAVE_NEON_KERNELS
+        case KernelIsa::NEON: return secondOrderSmoothnessImpl<NeonOps>(rows, n, seq_len, out);
+#endif
+        default: return secondOrderSmoothnessImpl<ScalarOps>(rows, n, seq_len, out);
+    }
+}
+
+double kernelPairwiseDistanceSum(const float* rows, size_t n, int seq_len) {
+    switch (activeKernelIsa()) {
+#ifdef TRAJECTORY_HAVE_AVX2_KERNELS
+        case KernelIsa::AVX2: return avx2::pairwiseDistanceSum(rows, n, seq_len);
+#endif
+#ifdef TRAJECTORY_HAVE_NEON_KERNELS
+        case KernelIsa::NEON: return pairwiseDistanceSumImpl<NeonOps>(rows, n, seq_len);
+#endif
+        default: return pairwiseDistanceSumImpl<ScalarOps>(rows, n, seq_len);
+    }
+}
+
+double kernelCrossDistanceSum(const float* rows_a, size_t n_a,
+                              const float* rows_b, size_t n_b, int seq_len) {
+    switch (activeKernelIsa()) {
+#ifdef TRAJECTORY_HAVE_AVX2_KERNELS
+        case KernelIsa::AVX2: return avx2::crossDistanceSum(rows_a, n_a, rows_b, n_b, seq_len);
+#endif
+#ifdef TRAJECTORY_HAVE_NEON_KERNELS
+        case KernelIsa::NEON: return crossDistanceSumImpl<NeonOps>(rows_a, n_a, rows_b, n_b, seq_len);
+#endif
+        default: return crossDistanceSumImpl<ScalarOps>(rows_a, n_a, rows_b, n_b, seq_len);
+    }
+}
+
+} // namespace trajectory
@@ -0,0 +1,171 @@
+/**
+ * @file trajectory_kernels.h
+ * @brief Vectorized metric kernels over packed trajectory rows
+ * @author Mission Planner Team
+ * 
+ * The kernels score many equal-length trajectories at once. Input is the
+ * packed [n, seq_len, 3] layout used by TrajectoryBatch; each block of
+ * lanes is transposed to structure-of-arrays form so every SIMD lane
+ * evaluates one trajectory. AVX2 (x86-64) and NEON (AArch64) versions
+ * are selected at runtime, with a scalar fallback that reproduces the
+ * single-trajectory functions in trajectory_metrics.h exactly.
+ */
+
+#ifndef TRAJECTORY_KERNELS_H
+#define TRAJECTORY_KERNELS_H
+
+#include <cstddef>
+
+namespace trajectory {
+
+/**
+ * @brief Instruction set used by the metric kernels
+ */
+enum class KernelIsa {
+    Scalar,
+    AVX2,
+    NEON
+};
+
+/**
+ * @brief Output arrays of kernelFusedMetrics(), n floats each
+ * 
+ * Any pointer may be nullptr if that metric is not needed.
+ */
+struct FusedMetricsOut {
+    float* path_length = nullptr;    // Σ ||p[i+1] - p[i]||
+    float* avg_curvature = nullptr;  // rad/m
+    float* max_curvature = nullptr;  // rad/m
+    float* min_altitude = nullptr;   // min z
+    float* max_altitude = nullptr;   // max z
+    float* avg_altitude = nullptr;   // mean z
+};
+
+/**
+ * @brief Maximum absolute error of fastAcos() in radians
+ * 
+ * Abramowitz & Stegun 4.4.45 is accurate to 5e-5 rad; the remainder
+ * covers float rounding in the polynomial and sqrt.
+ */
+constexpr float kFastAcosMaxError = 7e-5f;
+
+/**
+ * @brief Best instruction set supported by this CPU and build
+ */
+KernelIsa detectKernelIsa();
+
+/**
+ * @brief Instruction set the kernels currently dispatch to
+ */
+KernelIsa activeKernelIsa();
+
+/**
+ * @brief Force the kernels onto a specific instruction set
+ * 
+ * Intended for benchmarking and cross-checking implementations.
+ * 
+ * @param isa Instruction set to use
+ * @return False (and nothing changes) if isa is not supported
+ */
+bool setKernelIsa(KernelIsa isa);
+
+/**
+ * @brief Human-readable instruction set name
+ */
+const char* kernelIsaName(KernelIsa isa);
+
+/**
+ * @brief Polynomial arc cosine approximation
+ * 
+ * Formula (A&S 4.4.45), for |x| <= 1:
+ *   acos(|x|) ≈ sqrt(1 - |x|) * (a0 + a1|x| + a2|x|² + a3|x|³)
+ *   acos(-x) = π - acos(x)
+ * 
+ * @param x Cosine, clamped to [-1, 1]
+ * @return Angle in radians, within kFastAcosMaxError of std::acos
+ */
+float fastAcos(float x);
+
+/**
+ * @brief Total path length of each row
+ * 
+ * @param rows Packed [n, seq_len, 3] waypoints
+ * @param n Number of rows
+ * @param seq_len Waypoints per row
+ * @param out Receives n path lengths
+ */
+void kernelPathLengths(const float* rows, size_t n, int seq_len, float* out);
+
+/**
+ * @brief Average and maximum curvature of each row
+ * 
+ * Uses the same definition as computeCurvatures(); points adjacent to a
+ * zero-length segment are skipped.
+ * 
+ * @param rows Packed [n, seq_len, 3] waypoints
+ * @param n Number of rows
+ * @param seq_len Waypoints per row
+ * @param fast_acos Use fastAcos() instead of a full-precision acos
+ * @param avg_out Receives n average curvatures (may be nullptr)
+ * @param max_out Receives n maximum curvatures (may be nullptr)
+ */
+void kernelCurvatureStats(const float* rows, size_t n, int seq_len,
+                          bool fast_acos, float* avg_out, float* max_out);
+
+/**
+ * @brief Path, curvature and altitude metrics of each row in one pass
+ * 
+ * Every point is loaded once; segment vectors and norms are carried to
+ * the next curvature step instead of being recomputed.
+ * 
+ * @param rows Packed [n, seq_len, 3] waypoints
+ * @param n Number of rows
+ * @param seq_len Waypoints per row (>= 1)
+ * @param fast_acos Use fastAcos() instead of a full-precision acos
+ * @param out Destination arrays
+ */
+void kernelFusedMetrics(const float* rows, size_t n, int seq_len,
+                        bool fast_acos, const FusedMetricsOut& out);
+
+/**
+ * @brief Second-order smoothness loss of each row
+ * 
+ * @param rows Packed [n, seq_len, 3] waypoints
+ * @param n Number of rows
+ * @param seq_len Waypoints per row
+ * @param out Receives n smoothness losses
+ */
+void kernelSecondOrderSmoothness(const float* rows, size_t n, int seq_len, float* out);
+
+/**
+ * @brief Sum over all row pairs of the mean waypoint distance
+ * 
+ * Formula: Σ_{i<j} (1/seq_len) Σ_k ||a_i[k] - a_j[k]||
+ * Divide by n(n-1)/2 for the average pairwise diversity.
+ * 
+ * @param rows Packed [n, seq_len, 3] waypoints
+ * @param n Number of rows
+ * @param seq_len Waypoints per row
+ * @return Sum of per-pair mean distances
+ */
+double kernelPairwiseDistanceSum(const float* rows, size_t n, int seq_len);
+
+/**
+ * @brief Sum over all (a, b) row pairs of the mean waypoint distance
+ * 
+ * Formula: Σ_i Σ_j (1/seq_len) Σ_k ||a_i[k] - b_j[k]||
+ * Used for the off-diagonal tiles of a blocked all-pairs computation.
+ * 
+ * @param rows_a Packed [n_a, seq_len, 3] waypoints
+ * @param n_a Number of rows in rows_a
+ * @param rows_b Packed [n_b, seq_len, 3] waypoints
+ * @param n_b Number of rows in rows_b
+ * @param seq_len Waypoints per row
+ * @return Sum of per-pair mean distances
+ */
+double kernelCrossDistanceSum(const float* rows_a, size_t n_a,
+                              const float* rows_b, size_t n_b, int seq_len);
+                              
+} // namespace trajectory
+
+#endif // TRAJECTORY_KERNELS_H
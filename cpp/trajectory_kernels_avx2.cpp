@@ -0,0 +1,72 @@
+/**
+ * @file trajectory_kernels_avx2.cpp
+ * @brief AVX2 + FMA metric kernels
+ * 
+ * Built with AVX2/FMA code generation (see CMakeLists.txt) and only
+ * entered after trajectory_kernels.cpp has checked CPU support.
+ */
+
+#include "trajectory_kernels_simd.h"
+#include <immintrin.h>
+
+namespace trajectory {
+
+namespace {
+
+struct Avx2Ops {
+    using V = __m256;
+    static constexpr int W = 8;
+    
+    static V zero() { return _mm256_setzero_ps(); }
+    static V set1(float v) { return _mm256_set1_ps(v); }
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+    static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static V gt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static V lt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static V andMask(V a, V b) { return _mm256_and_ps(a, b); }
+    static V select(V m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+    static V acosPrecise(V x) { return polyAcos<Avx2Ops, false>(x); }
+};
+
+} // namespace
+
+namespace avx2 {
+
+void pathLengths(const float* rows, size_t n, int seq_len, float* out) {
+    pathLengthsImpl<Avx2Ops>(rows, n, seq_len, out);
+}
+
+void curvatureStats(const float* rows, size_t n, int seq_len,
+                    bool fast_acos, float* avg_out, float* max_out) {
+    curvatureStatsImpl<Avx2Ops>(rows, n, seq_len, fast_acos, avg_out, max_out);
+}
+
+void fusedMetrics(const float* rows, size_t n, int seq_len,
+                  bool fast_acos, const FusedMetricsOut& out) {
+    fusedMetricsImpl<Avx2Ops>(rows, n, seq_len, fast_acos, out);
+}
+
+void secondOrderSmoothness(const float* rows, size_t n, int seq_len, float* out) {
+    secondOrderSmoothnessImpl<Avx2Ops>(rows, n, seq_len, out);
+}
+
+double pairwiseDistanceSum(const float* rows, size_t n, int seq_len) {
+    return pairwiseDistanceSumImpl<Avx2Ops>(rows, n, seq_len);
+}
+
+double crossDistanceSum(const float* rows_a, size_t n_a,
+                        const float* rows_b, size_t n_b, int seq_len) {
+    return crossDistanceSumImpl<Avx2Ops>(rows_a, n_a, rows_b, n_b, seq_len);
+}
+
+} // namespace avx2
+
+} // namespace trajectory
@@ -0,0 +1,436 @@
+/**
+ * @file trajectory_kernels_simd.h
+ * @brief Width-generic metric kernel templates (internal)
+ * 
+ * Included by each instruction-set translation unit together with an
+ * Ops type that wraps one vector width. Everything here has internal
+ * linkage and avoids standard library templates, so no code compiled
+ * with wider ISA flags can be merged into the generic build as a weak
+ * symbol by the linker.
+ */
+
+#ifndef TRAJECTORY_KERNELS_SIMD_H
+#define TRAJECTORY_KERNELS_SIMD_H
+
+#include "trajectory_kernels.h"
+#include <cstddef>
+
+namespace trajectory {
+
+/**
+ * @brief Per-thread scratch buffer of at least n floats
+ * 
+ * Defined in trajectory_kernels.cpp so that the allocation code is
+ * always built for the baseline instruction set.
+ */
+float* kernelScratch(size_t n);
+
+// Entry points of the ISA-specific translation units
+namespace avx2 {
+void pathLengths(const float* rows, size_t n, int seq_len, float* out);
+void curvatureStats(const float* rows, size_t n, int seq_len,
+                    bool fast_acos, float* avg_out, float* max_out);
+void fusedMetrics(const float* rows, size_t n, int seq_len,
+                  bool fast_acos, const FusedMetricsOut& out);
+void secondOrderSmoothness(const float* rows, size_t n, int seq_len, float* out);
+double pairwiseDistanceSum(const float* rows, size_t n, int seq_len);
+double crossDistanceSum(const float* rows_a, size_t n_a,
+                        const float* rows_b, size_t n_b, int seq_len);
+} // namespace avx2
+
+namespace {
+
+inline size_t minSize(size_t a, size_t b) { return a < b ? a : b; }
+
+/*
+ * Ops interface, W lanes of float:
+ *   V, W, zero, set1, load, store, add, sub, mul, div, sqrt, min, max,
+ *   abs, gt, lt, andMask, select, acosPrecise
+ * Comparison results are masks in V; select(m, a, b) = m ? a : b.
+ */
+
+/**
+ * @brief Transpose rows [base, base+W) into block layout [k][c][lane]
+ * 
+ * Lanes past n repeat the last row so padded lanes compute on real data.
+ */
+template <int W>
+const float* transposeBlock(const float* rows, size_t n, size_t base,
+                            int seq_len, float* block) {
+    const size_t stride = static_cast<size_t>(seq_len) * 3;
+    
+    for (int lane = 0; lane < W; ++lane) {
+        const size_t r = minSize(base + lane, n - 1);
+        const float* src = rows + r * stride;
+        
+        for (int k = 0; k < seq_len; ++k) {
+            float* dst = block + static_cast<size_t>(k) * 3 * W + lane;
+            dst[0] = src[k * 3 + 0];
+            dst[W] = src[k * 3 + 1];
+            dst[2 * W] = src[k * 3 + 2];
+        }
+    }
+    
+    return block;
+}
+
+/**
+ * @brief Call fn(block, base, lanes) for every W-row block
+ * 
+ * With W == 1 the packed row already is the block layout, so no copy is made.
+ */
+template <int W, class Fn>
+void forEachBlock(const float* rows, size_t n, int seq_len, Fn fn) {
+    const size_t stride = static_cast<size_t>(seq_len) * 3;
+    float* block = (W > 1) ? kernelScratch(stride * W) : nullptr;
+    
+    for (size_t base = 0; base < n; base += W) {
+        const float* soa = (W == 1) ? rows + base * stride
+                                    : transposeBlock<W>(rows, n, base, seq_len, block);
+        fn(soa, base, minSize(W, n - base));
+    }
+}
+
+/**
+ * @brief A&S 4.4.45 (fast) or 4.4.46 (full precision) arc cosine
+ */
+template <class Ops, bool Fast>
+typename Ops::V polyAcos(typename Ops::V x) {
+    using V = typename Ops::V;
+    
+    const V ax = Ops::abs(x);
+    V p;
+    
+    if (Fast) {
+        p = Ops::set1(-0.0187293f);
+        p = Ops::add(Ops::mul(p, ax), Ops::set1(0.0742610f));
+        p = Ops::add(Ops::mul(p, ax), Ops::set1(-0.2121144f));
+        p = Ops::add(Ops::mul(p, ax), Ops::set1(1.5707288f));
+    } else {
+        p = Ops::set1(-0.0012624911f);
+        p = Ops::add(Ops::mul(p, ax), Ops::set1(0.0066700901f));
+        p = Ops::add(Ops::mul(p, ax), Ops::set1(-0.0170881256f));
+        p = Ops::add(Ops::mul(p, ax), Ops::set1(0.0308918810f));
+        p = Ops::add(Ops::mul(p, ax), Ops::set1(-0.0501743046f));
+        p = Ops::add(Ops::mul(p, ax), Ops::set1(0.0889789874f));
+        p = Ops::add(Ops::mul(p, ax), Ops::set1(-0.2145988016f));
+        p = Ops::add(Ops::mul(p, ax), Ops::set1(1.5707963050f));
+    }
+    
+    const V r = Ops::mul(Ops::sqrt(Ops::sub(Ops::set1(1.0f), ax)), p);
+    return Ops::select(Ops::lt(x, Ops::zero()), Ops::sub(Ops::set1(3.14159265f), r), r);
+}
+
+template <class Ops>
+typename Ops::V norm3(typename Ops::V x, typename Ops::V y, typename Ops::V z) {
+    return Ops::sqrt(Ops::add(Ops::add(Ops::mul(x, x), Ops::mul(y, y)), Ops::mul(z, z)));
+}
+
+/**
+ * @brief Vector form of turnCurvature(): κ = θ / ||v1|| per lane
+ * 
+ * Lanes where either segment has zero length get 0 and are cleared in
+ * valid, so inf/NaN never reaches the accumulators.
+ */
+template <class Ops>
+typename Ops::V turnCurvature(typename Ops::V v1_x, typename Ops::V v1_y, typename Ops::V v1_z,
+                              typename Ops::V norm1,
+                              typename Ops::V v2_x, typename Ops::V v2_y, typename Ops::V v2_z,
+                              typename Ops::V norm2, bool fast_acos, typename Ops::V& valid) {
+    using V = typename Ops::V;
+    const V eps = Ops::set1(1e-6f);
+    valid = Ops::andMask(Ops::gt(norm1, eps), Ops::gt(norm2, eps));
+    
+    V dot = Ops::add(Ops::add(Ops::mul(v1_x, v2_x), Ops::mul(v1_y, v2_y)),
+                     Ops::mul(v1_z, v2_z));
+    V cos_angle = Ops::div(dot, Ops::mul(norm1, norm2));
+    cos_angle = Ops::max(Ops::set1(-1.0f), Ops::min(Ops::set1(1.0f), cos_angle));
+    
+    V angle = fast_acos ? polyAcos<Ops, true>(cos_angle)
+                        : Ops::acosPrecise(cos_angle);
+    return Ops::select(valid, Ops::div(angle, norm1), Ops::zero());
+}
+
+template <class Ops>
+void pathLengthsImpl(const float* rows, size_t n, int seq_len, float* out) {
+    using V = typename Ops::V;
+    constexpr int W = Ops::W;
+    
+    forEachBlock<W>(rows, n, seq_len, [&](const float* soa, size_t base, size_t lanes) {
+        V length = Ops::zero();
+        
+        for (int k = 0; k + 1 < seq_len; ++k) {
+            const float* a = soa + static_cast<size_t>(k) * 3 * W;
+            const float* b = a + 3 * W;
+            
+            V dx = Ops::sub(Ops::load(b), Ops::load(a));
+            V dy = Ops::sub(Ops::load(b + W), Ops::load(a + W));
+            V dz = Ops::sub(Ops::load(b + 2 * W), Ops::load(a + 2 * W));
+            
+            length = Ops::add(length, norm3<Ops>(dx, dy, dz));
+        }
+        
+        float lane_out[W];
+        Ops::store(lane_out, length);
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            out[base + lane] = lane_out[lane];
+        }
+    });
+}
+
+template <class Ops>
+void curvatureStatsImpl(const float* rows, size_t n, int seq_len,
+                        bool fast_acos, float* avg_out, float* max_out) {
+    using V = typename Ops::V;
+    constexpr int W = Ops::W;
+    
+    forEachBlock<W>(rows, n, seq_len, [&](const float* soa, size_t base, size_t lanes) {
+        const V one = Ops::set1(1.0f);
+        
+        V sum = Ops::zero();
+        V count = Ops::zero();
+        V max_curvature = Ops::zero();
+        
+        for (int k = 1; k + 1 < seq_len; ++k) {
+            const float* p_prev = soa + static_cast<size_t>(k - 1) * 3 * W;
+            const float* p_curr = p_prev + 3 * W;
+            const float* p_next = p_curr + 3 * W;
+            
+            // v1 = current - previous, v2 = next - current
+            V v1_x = Ops::sub(Ops::load(p_curr), Ops::load(p_prev));
+            V v1_y = Ops::sub(Ops::load(p_curr + W), Ops::load(p_prev + W));
+            V v1_z = Ops::sub(Ops::load(p_curr + 2 * W), Ops::load(p_prev + 2 * W));
+            V v2_x = Ops::sub(Ops::load(p_next), Ops::load(p_curr));
+            V v2_y = Ops::sub(Ops::load(p_next + W), Ops::load(p_curr + W));
+            V v2_z = Ops::sub(Ops::load(p_next + 2 * W), Ops::load(p_curr + 2 * W));
+            
+            V norm1 = norm3<Ops>(v1_x, v1_y, v1_z);
+            V norm2 = norm3<Ops>(v2_x, v2_y, v2_z);
+            
+            V valid;
+            V curvature = turnCurvature<Ops>(v1_x, v1_y, v1_z, norm1, v2_x, v2_y, v2_z, norm2,
+                                             fast_acos, valid);
+            sum = Ops::add(sum, curvature);
+            count = Ops::add(count, Ops::select(valid, one, Ops::zero()));
+            max_curvature = Ops::max(max_curvature, curvature);
+        }
+        
+        float lane_sum[W], lane_count[W], lane_max[W];
+        Ops::store(lane_sum, sum);
+        Ops::store(lane_count, count);
+        Ops::store(lane_max, max_curvature);
+        
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            if (avg_out) {
+                avg_out[base + lane] = lane_count[lane] > 0.0f ? lane_sum[lane] / lane_count[lane] : 0.0f;
+            }
+            if (max_out) {
+                max_out[base + lane] = lane_max[lane];
+            }
+        }
+    });
+}
+
+template <class Ops>
+void fusedMetricsImpl(const float* rows, size_t n, int seq_len,
+                      bool fast_acos, const FusedMetricsOut& out) {
+    using V = typename Ops::V;
+    constexpr int W = Ops::W;
+    
+    if (seq_len < 1) return;
+    
+    forEachBlock<W>(rows, n, seq_len, [&](const float* soa, size_t base, size_t lanes) {
+        const V one = Ops::set1(1.0f);
+        
+        V px = Ops::load(soa);
+        V py = Ops::load(soa + W);
+        V pz = Ops::load(soa + 2 * W);
+        
+        V length = Ops::zero();
+        V sum = Ops::zero();
+        V count = Ops::zero();
+        V max_curvature = Ops::zero();
+        V min_z = pz;
+        V max_z = pz;
+        V sum_z = pz;
+        
+        // Segment p[k-1] -> p[k], carried between iterations
+        V v1_x = Ops::zero(), v1_y = Ops::zero(), v1_z = Ops::zero();
+        V norm1 = Ops::zero();
+        
+        for (int k = 1; k < seq_len; ++k) {
+            const float* p = soa + static_cast<size_t>(k) * 3 * W;
+            V nx = Ops::load(p);
+            V ny = Ops::load(p + W);
+            V nz = Ops::load(p + 2 * W);
+            
+            V v2_x = Ops::sub(nx, px);
+            V v2_y = Ops::sub(ny, py);
+            V v2_z = Ops::sub(nz, pz);
+            V norm2 = norm3<Ops>(v2_x, v2_y, v2_z);
+            length = Ops::add(length, norm2);
+            
+            if (k >= 2) {
+                // Curvature at p[k-1] from segments (k-2, k-1) and (k-1, k)
+                V valid;
+                V curvature = turnCurvature<Ops>(v1_x, v1_y, v1_z, norm1, v2_x, v2_y, v2_z, norm2,
+                                                 fast_acos, valid);
+                sum = Ops::add(sum, curvature);
+                count = Ops::add(count, Ops::select(valid, one, Ops::zero()));
+                max_curvature = Ops::max(max_curvature, curvature);
+            }
+            
+            min_z = Ops::min(min_z, nz);
+            max_z = Ops::max(max_z, nz);
+            sum_z = Ops::add(sum_z, nz);
+            
+            v1_x = v2_x; v1_y = v2_y; v1_z = v2_z;
+            norm1 = norm2;
+            px = nx; py = ny; pz = nz;
+        }
+        
+        float lane_length[W], lane_sum[W], lane_count[W], lane_max[W];
+        float lane_min_z[W], lane_max_z[W], lane_sum_z[W];
+        Ops::store(lane_length, length);
+        Ops::store(lane_sum, sum);
+        Ops::store(lane_count, count);
+        Ops::store(lane_max, max_curvature);
+        Ops::store(lane_min_z, min_z);
+        Ops::store(lane_max_z, max_z);
+        Ops::store(lane_sum_z, sum_z);
+        
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            const size_t i = base + lane;
+            if (out.path_length) out.path_length[i] = lane_length[lane];
+            if (out.avg_curvature) {
+                out.avg_curvature[i] = lane_count[lane] > 0.0f ? lane_sum[lane] / lane_count[lane] : 0.0f;
+            }
+            if (out.max_curvature) out.max_curvature[i] = lane_max[lane];
+            if (out.min_altitude) out.min_altitude[i] = lane_min_z[lane];
+            if (out.max_altitude) out.max_altitude[i] = lane_max_z[lane];
+            if (out.avg_altitude) out.avg_altitude[i] = lane_sum_z[lane] / seq_len;
+        }
+    });
+}
+
+template <class Ops>
+void secondOrderSmoothnessImpl(const float* rows, size_t n, int seq_len, float* out) {
+    using V = typename Ops::V;
+    constexpr int W = Ops::W;
+    
+    if (seq_len < 3) {
+        for (size_t i = 0; i < n; ++i) out[i] = 0.0f;
+        return;
+    }
+    
+    forEachBlock<W>(rows, n, seq_len, [&](const float* soa, size_t base, size_t lanes) {
+        const V two = Ops::set1(2.0f);
+        V loss = Ops::zero();
+        
+        for (int k = 1; k + 1 < seq_len; ++k) {
+            const float* p_prev = soa + static_cast<size_t>(k - 1) * 3 * W;
+            const float* p_curr = p_prev + 3 * W;
+            const float* p_next = p_curr + 3 * W;
+            
+            // Second derivative: p[i+1] - 2*p[i] + p[i-1]
+            V ax = Ops::add(Ops::sub(Ops::load(p_next), Ops::mul(two, Ops::load(p_curr))),
+                            Ops::load(p_prev));
+            V ay = Ops::add(Ops::sub(Ops::load(p_next + W), Ops::mul(two, Ops::load(p_curr + W))),
+                            Ops::load(p_prev + W));
+            V az = Ops::add(Ops::sub(Ops::load(p_next + 2 * W), Ops::mul(two, Ops::load(p_curr + 2 * W))),
+                            Ops::load(p_prev + 2 * W));
+            
+            loss = Ops::add(loss, Ops::add(Ops::add(Ops::mul(ax, ax), Ops::mul(ay, ay)),
+                                           Ops::mul(az, az)));
+        }
+        
+        float lane_out[W];
+        Ops::store(lane_out, loss);
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            out[base + lane] = lane_out[lane] / (seq_len - 2);
+        }
+    });
+}
+
+/**
+ * @brief Σ over row pairs (i from a, j from b) of the mean waypoint distance
+ * 
+ * With upper_triangle, a and b are the same rows and only pairs i < j count.
+ */
+template <class Ops>
+double distanceSumImpl(const float* rows_a, size_t n_a,
+                       const float* rows_b, size_t n_b,
+                       int seq_len, bool upper_triangle) {
+    using V = typename Ops::V;
+    constexpr int W = Ops::W;
+    
+    if (n_a == 0 || n_b == 0 || seq_len < 1) return 0.0;
+    
+    // Transpose the b rows once; each a row is then compared against
+    // W b rows at a time.
+    const size_t stride = static_cast<size_t>(seq_len) * 3;
+    const size_t n_blocks = (n_b + W - 1) / W;
+    float* blocks = (W > 1) ? kernelScratch(n_blocks * stride * W) : nullptr;
+    
+    if (W > 1) {
+        for (size_t b = 0; b < n_blocks; ++b) {
+            transposeBlock<W>(rows_b, n_b, b * W, seq_len, blocks + b * stride * W);
+        }
+    }
+    
+    const float inv_len = 1.0f / seq_len;
+    double total = 0.0;
+    
+    for (size_t i = 0; i < n_a; ++i) {
+        const float* a = rows_a + i * stride;
+        V row_sum = Ops::zero();
+        
+        for (size_t b = upper_triangle ? (i + 1) / W : 0; b < n_blocks; ++b) {
+            const float* soa = (W == 1) ? rows_b + b * stride : blocks + b * stride * W;
+            V distance = Ops::zero();
+            
+            for (int k = 0; k < seq_len; ++k) {
+                const float* p = soa + static_cast<size_t>(k) * 3 * W;
+                V dx = Ops::sub(Ops::set1(a[k * 3 + 0]), Ops::load(p));
+                V dy = Ops::sub(Ops::set1(a[k * 3 + 1]), Ops::load(p + W));
+                V dz = Ops::sub(Ops::set1(a[k * 3 + 2]), Ops::load(p + 2 * W));
+                distance = Ops::add(distance, norm3<Ops>(dx, dy, dz));
+            }
+            
+            // Keep only lanes j < n_b (and i < j in the triangle case)
+            float lane_mask[W];
+            for (int lane = 0; lane < W; ++lane) {
+                const size_t j = b * W + lane;
+                lane_mask[lane] = (j < n_b && (!upper_triangle || j > i)) ? 1.0f : 0.0f;
+            }
+            row_sum = Ops::add(row_sum, Ops::mul(Ops::load(lane_mask),
+                                                 Ops::mul(distance, Ops::set1(inv_len))));
+        }
+        
+        float lane_out[W];
+        Ops::store(lane_out, row_sum);
+        for (int lane = 0; lane < W; ++lane) {
+            total += lane_out[lane];
+        }
+    }
+    
+    return total;
+}
+
+template <class Ops>
+double pairwiseDistanceSumImpl(const float* rows, size_t n, int seq_len) {
+    if (n < 2) return 0.0;
+    return distanceSumImpl<Ops>(rows, n, rows, n, seq_len, true);
+}
+
+template <class Ops>
+double crossDistanceSumImpl(const float* rows_a, size_t n_a,
+                            const float* rows_b, size_t n_b, int seq_len) {
+    return distanceSumImpl<Ops>(rows_a, n_a, rows_b, n_b, seq_len, false);
+}
+
+} // namespace
+
+} // namespace trajectory
+
+#endif // TRAJECTORY_KERNELS_SIMD_H
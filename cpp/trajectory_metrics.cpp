@@ -5,20 +5,25 @@
 
 #include "trajectory_metrics.h"
 #include "trajectory_inference.h"
+#include "trajectory_batch.h"
+#include "trajectory_kernels.h"
+#include "trajectory_ranking.h"
+#include "telemetry.h"
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <stdexcept>
 
 namespace trajectory {
 
-float computePathLength(const Trajectory& trajectory) {
+float computePathLength(const TrajectoryView& trajectory) {
     if (trajectory.size() < 2) return 0.0f;
     
     float length = 0.0f;
     
     for (size_t i = 0; i < trajectory.size() - 1; ++i) {
-        const Waypoint& p1 = trajectory[i];
-        const Waypoint& p2 = trajectory[i + 1];
+        const Waypoint p1 = trajectory[i];
+        const Waypoint p2 = trajectory[i + 1];
         
         float dx = p2.x - p1.x;
         float dy = p2.y - p1.y;
@@ -30,11 +35,11 @@ float computePathLength(const Trajectory& trajectory) {
     return length;
 }
 
-float computeStraightLineDistance(const Trajectory& trajectory) {
+float computeStraightLineDistance(const TrajectoryView& trajectory) {
     if (trajectory.size() < 2) return 0.0f;
     
-    const Waypoint& start = trajectory.front();
-    const Waypoint& end = trajectory.back();
+    const Waypoint start = trajectory.front();
+    const Waypoint end = trajectory.back();
     
     float dx = end.x - start.x;
     float dy = end.y - start.y;
@@ -43,7 +48,7 @@ float computeStraightLineDistance(const Trajectory& trajectory) {
     return std::sqrt(dx*dx + dy*dy + dz*dz);
 }
 
-float computePathEfficiency(const Trajectory& trajectory) {
+float computePathEfficiency(const TrajectoryView& trajectory) {
     if (trajectory.size() < 2) return 1.0f;
     
     float straight_line = computeStraightLineDistance(trajectory);
@@ -54,75 +59,84 @@ float computePathEfficiency(const Trajectory& trajectory) {
     return straight_line / path_length;
 }
 
-std::vector<float> computeCurvatures(const Trajectory& trajectory) {
-    std::vector<float> curvatures;
-    
-    if (trajectory.size() < 3) return curvatures;
+namespace {
+
+/**
+ * @brief Call visit(κ) for the curvature at each interior point, in order
+ * 
+ * Shared by the curvature functions so the statistics need no vector.
+ */
+template <typename Visit>
+void forEachCurvature(const TrajectoryView& trajectory, Visit&& visit) {
+    if (trajectory.size() < 3) return;
     
     for (size_t i = 1; i < trajectory.size() - 1; ++i) {
-        const Waypoint& p_prev = trajectory[i - 1];
-        const Waypoint& p_curr = trajectory[i];
-        const Waypoint& p_next = trajectory[i + 1];
+        const Waypoint p_prev = trajectory[i - 1];
+        const Waypoint p_curr = trajectory[i];
+        const Waypoint p_next = trajectory[i + 1];
         
-        // v1 = current - previous
-        float v1_x = p_curr.x - p_prev.x;
-        float v1_y = p_curr.y - p_prev.y;
-        float v1_z = p_curr.z - p_prev.z;
-        float norm1 = std::sqrt(v1_x*v1_x + v1_y*v1_y + v1_z*v1_z);
+        // v1 = current - previous, v2 = next - current
+        const float v1[3] = {p_curr.x - p_prev.x, p_curr.y - p_prev.y, p_curr.z - p_prev.z};
+        const float v2[3] = {p_next.x - p_curr.x, p_next.y - p_curr.y, p_next.z - p_curr.z};
+        const float norm1 = std::sqrt(v1[0]*v1[0] + v1[1]*v1[1] + v1[2]*v1[2]);
+        const float norm2 = std::sqrt(v2[0]*v2[0] + v2[1]*v2[1] + v2[2]*v2[2]);
         
-        // v2 = next - current
-        float v2_x = p_next.x - p_curr.x;
-        float v2_y = p_next.y - p_curr.y;
-        float v2_z = p_next.z - p_curr.z;
-        float norm2 = std::sqrt(v2_x*v2_x + v2_y*v2_y + v2_z*v2_z);
-        
-        if (norm1 > 1e-6f && norm2 > 1e-6f) {
-            // Dot product
-            float dot = v1_x*v2_x + v1_y*v2_y + v1_z*v2_z;
-            
-            // Cosine of angle (clamp to avoid numerical issues)
-            float cos_angle = dot / (norm1 * norm2);
-            cos_angle = std::max(-1.0f, std::min(1.0f, cos_angle));
-            
-            // Angle in radians
-            float angle = std::acos(cos_angle);
-            
-            // Curvature = angle / segment_length
-            float curvature = angle / norm1;
-            curvatures.push_back(curvature);
+        float curvature;
+        if (turnCurvature(v1, norm1, v2, norm2, curvature)) {
+            visit(curvature);
         }
     }
-    
+}
+
+} // namespace
+
+std::vector<float> computeCurvatures(const TrajectoryView& trajectory) {
+    std::vector<float> curvatures;
+    forEachCurvature(trajectory, [&](float curvature) { curvatures.push_back(curvature); });
     return curvatures;
 }
 
-float computeAverageCurvature(const Trajectory& trajectory) {
-    std::vector<float> curvatures = computeCurvatures(trajectory);
-    
-    if (curvatures.empty()) return 0.0f;
-    
-    float sum = std::accumulate(curvatures.begin(), curvatures.end(), 0.0f);
-    return sum / curvatures.size();
+std::pmr::vector<float> computeCurvatures(const TrajectoryView& trajectory,
+                                          std::pmr::memory_resource* resource) {
+    std::pmr::vector<float> curvatures(resource);
+    if (trajectory.size() >= 3) curvatures.reserve(trajectory.size() - 2);
+    forEachCurvature(trajectory, [&](float curvature) { curvatures.push_back(curvature); });
+    return curvatures;
 }
 
-float computeMaxCurvature(const Trajectory& trajectory) {
-    std::vector<float> curvatures = computeCurvatures(trajectory);
+float computeAverageCurvature(const TrajectoryView& trajectory) {
+    float sum = 0.0f;
+    size_t count = 0;
+    forEachCurvature(trajectory, [&](float curvature) {
+        sum += curvature;
+        ++count;
+    });
     
-    if (curvatures.empty()) return 0.0f;
+    if (count == 0) return 0.0f;
     
-    return *std::max_element(curvatures.begin(), curvatures.end());
+    return sum / count;
+}
+
+float computeMaxCurvature(const TrajectoryView& trajectory) {
+    bool any = false;
+    float max_curvature = 0.0f;
+    forEachCurvature(trajectory, [&](float curvature) {
+        max_curvature = any ? std::max(max_curvature, curvature) : curvature;
+        any = true;
+    });
+    return max_curvature;
 }
 
-float computeSmoothnessScore(const Trajectory& trajectory) {
+float computeSmoothnessScore(const TrajectoryView& trajectory) {
     float avg_curvature = computeAverageCurvature(trajectory);
     return 1.0f / (1.0f + avg_curvature);
 }
 
-float computeEndpointError(const Trajectory& trajectory, 
+float computeEndpointError(const TrajectoryView& trajectory, 
                           const Waypoint& expected_end) {
     if (trajectory.empty()) return 0.0f;
     
-    const Waypoint& actual_end = trajectory.back();
+    const Waypoint actual_end = trajectory.back();
     
     float dx = actual_end.x - expected_end.x;
     float dy = actual_end.y - expected_end.y;
@@ -131,14 +145,14 @@ float computeEndpointError(const Trajectory& trajectory,
     return std::sqrt(dx*dx + dy*dy + dz*dz);
 }
 
-float computeAverageVelocity(const Trajectory& trajectory) {
+float computeAverageVelocity(const TrajectoryView& trajectory) {
     if (trajectory.size() < 2) return 0.0f;
     
     float total_velocity = 0.0f;
     
     for (size_t i = 0; i < trajectory.size() - 1; ++i) {
-        const Waypoint& p1 = trajectory[i];
-        const Waypoint& p2 = trajectory[i + 1];
+        const Waypoint p1 = trajectory[i];
+        const Waypoint p2 = trajectory[i + 1];
         
         float dx = p2.x - p1.x;
         float dy = p2.y - p1.y;
@@ -150,15 +164,15 @@ float computeAverageVelocity(const Trajectory& trajectory) {
     return total_velocity / (trajectory.size() - 1);
 }
 
-float computeSecondOrderSmoothness(const Trajectory& trajectory) {
+float computeSecondOrderSmoothness(const TrajectoryView& trajectory) {
     if (trajectory.size() < 3) return 0.0f;
     
     float smoothness_loss = 0.0f;
     
     for (size_t i = 1; i < trajectory.size() - 1; ++i) {
-        const Waypoint& p_prev = trajectory[i - 1];
-        const Waypoint& p_curr = trajectory[i];
-        const Waypoint& p_next = trajectory[i + 1];
+        const Waypoint p_prev = trajectory[i - 1];
+        const Waypoint p_curr = trajectory[i];
+        const Waypoint p_next = trajectory[i + 1];
         
         // Second derivative: p[i+1] - 2*p[i] + p[i-1]
         float ax = p_next.x - 2.0f*p_curr.x + p_prev.x;
@@ -171,42 +185,290 @@ float computeSecondOrderSmoothness(const Trajectory& trajectory) {
     return smoothness_loss / (trajectory.size() - 2);
 }
 
-TrajectoryMetrics evaluateTrajectory(const Trajectory& trajectory,
+void MetricsAccumulator::add(const Waypoint& p) {
+    if (count++ == 0) {
+        first[0] = last[0] = p.x;
+        first[1] = last[1] = p.y;
+        first[2] = last[2] = p.z;
+        min_altitude = max_altitude = sum_altitude = p.z;
+        return;
+    }
+    
+    const float v2[3] = {p.x - last[0], p.y - last[1], p.z - last[2]};
+    const float norm2 = std::sqrt(v2[0]*v2[0] + v2[1]*v2[1] + v2[2]*v2[2]);
+    
+    path_length += norm2;
+    
+    // Curvature at the previous waypoint
+    float curvature;
+    if (count >= 3 && turnCurvature(segment, segment_norm, v2, norm2, curvature)) {
+        curvature_sum += curvature;
+        curvature_count++;
+        max_curvature = std::max(max_curvature, curvature);
+    }
+    
+    min_altitude = std::min(min_altitude, p.z);
+    max_altitude = std::max(max_altitude, p.z);
+    sum_altitude += p.z;
+    
+    segment[0] = v2[0];
+    segment[1] = v2[1];
+    segment[2] = v2[2];
+    segment_norm = norm2;
+    last[0] = p.x;
+    last[1] = p.y;
+    last[2] = p.z;
+}
+
+TrajectoryMetrics MetricsAccumulator::finish(const Waypoint& expected_end) const {
+    TrajectoryMetrics metrics;
+    
+    if (count == 0) return metrics;
+    
+    // Path metrics
+    metrics.path_length = path_length;
+    if (count >= 2) {
+        float dx = last[0] - first[0];
+        float dy = last[1] - first[1];
+        float dz = last[2] - first[2];
+        metrics.straight_line_distance = std::sqrt(dx*dx + dy*dy + dz*dz);
+    }
+    
+    if (count < 2) {
+        metrics.path_efficiency = 1.0f;
+    } else if (path_length >= 1e-6f) {
+        metrics.path_efficiency = metrics.straight_line_distance / path_length;
+    }
+    
+    // Curvature metrics
+    metrics.avg_curvature = curvature_count > 0 ? curvature_sum / curvature_count : 0.0f;
+    metrics.max_curvature = max_curvature;
+    metrics.smoothness_score = 1.0f / (1.0f + metrics.avg_curvature);
+    
+    // Endpoint accuracy
+    float ex = last[0] - expected_end.x;
+    float ey = last[1] - expected_end.y;
+    float ez = last[2] - expected_end.z;
+    metrics.endpoint_error = std::sqrt(ex*ex + ey*ey + ez*ez);
+    
+    // Velocity
+    metrics.avg_velocity = (count > 1) ? path_length / (count - 1) : 0.0f;
+    
+    // Altitude statistics
+    metrics.min_altitude = min_altitude;
+    metrics.max_altitude = max_altitude;
+    metrics.avg_altitude = sum_altitude / count;
+    
+    return metrics;
+}
+
+TrajectoryMetrics evaluateTrajectory(const TrajectoryView& trajectory,
                                      const Waypoint& expected_end) {
     TrajectoryMetrics metrics;
     
     if (trajectory.empty()) return metrics;
     
+    const size_t n = trajectory.size();
+    
+    // Single traversal: each segment p[i-1] -> p[i] is measured once and
+    // carried forward as v1 for the curvature at the next interior point
+    Waypoint p_prev = trajectory[0];
+    float path_length = 0.0f;
+    float curvature_sum = 0.0f;
+    size_t curvature_count = 0;
+    float max_curvature = 0.0f;
+    float min_altitude = p_prev.z;
+    float max_altitude = p_prev.z;
+    float sum_altitude = p_prev.z;
+    
+    float v1[3] = {0.0f, 0.0f, 0.0f};
+    float norm1 = 0.0f;
+    
+    for (size_t i = 1; i < n; ++i) {
+        const Waypoint p = trajectory[i];
+        
+        const float v2[3] = {p.x - p_prev.x, p.y - p_prev.y, p.z - p_prev.z};
+        const float norm2 = std::sqrt(v2[0]*v2[0] + v2[1]*v2[1] + v2[2]*v2[2]);
+        
+        path_length += norm2;
+        
+        // Curvature at p[i-1]
+        float curvature;
+        if (i >= 2 && turnCurvature(v1, norm1, v2, norm2, curvature)) {
+            curvature_sum += curvature;
+            curvature_count++;
+            max_curvature = std::max(max_curvature, curvature);
+        }
+        
+        min_altitude = std::min(min_altitude, p.z);
+        max_altitude = std::max(max_altitude, p.z);
+        sum_altitude += p.z;
+        
+        v1[0] = v2[0];
+        v1[1] = v2[1];
+        v1[2] = v2[2];
+        norm1 = norm2;
+        p_prev = p;
+    }
+    
     // Path metrics
-    metrics.path_length = computePathLength(trajectory);
+    metrics.path_length = path_length;
     metrics.straight_line_distance = computeStraightLineDistance(trajectory);
-    metrics.path_efficiency = computePathEfficiency(trajectory);
+    
+    if (n < 2) {
+        metrics.path_efficiency = 1.0f;
+    } else if (path_length >= 1e-6f) {
+        metrics.path_efficiency = metrics.straight_line_distance / path_length;
+    }
     
     // Curvature metrics
-    metrics.avg_curvature = computeAverageCurvature(trajectory);
-    metrics.max_curvature = computeMaxCurvature(trajectory);
-    metrics.smoothness_score = computeSmoothnessScore(trajectory);
+    metrics.avg_curvature = curvature_count > 0 ? curvature_sum / curvature_count : 0.0f;
+    metrics.max_curvature = max_curvature;
+    metrics.smoothness_score = 1.0f / (1.0f + metrics.avg_curvature);
     
     // Endpoint accuracy
     metrics.endpoint_error = computeEndpointError(trajectory, expected_end);
     
     // Velocity
-    metrics.avg_velocity = computeAverageVelocity(trajectory);
+    metrics.avg_velocity = (n > 1) ? path_length / (n - 1) : 0.0f;
     
     // Altitude statistics
-    metrics.min_altitude = trajectory[0].z;
-    metrics.max_altitude = trajectory[0].z;
-    float sum_altitude = 0.0f;
-    
-    for (const auto& wp : trajectory) {
-        metrics.min_altitude = std::min(metrics.min_altitude, wp.z);
-        metrics.max_altitude = std::max(metrics.max_altitude, wp.z);
-        sum_altitude += wp.z;
+    metrics.min_altitude = min_altitude;
+    metrics.max_altitude = max_altitude;
+    metrics.avg_altitude = sum_altitude / n;
+    
+    return metrics;
+}
+
+namespace {
+
+/**
+ * @brief One block of evaluatePackedRows() through caller-provided columns
+ */
+void evaluateKernelBlock(const float* rows, size_t count, int seq_len,
+                         const Waypoint* expected_ends, size_t end_stride,
+                         TrajectoryMetrics* results, bool fast_acos, float* columns) {
+    FusedMetricsOut out;
+    out.path_length = columns;
+    out.avg_curvature = columns + count;
+    out.max_curvature = columns + 2 * count;
+    out.min_altitude = columns + 3 * count;
+    out.max_altitude = columns + 4 * count;
+    out.avg_altitude = columns + 5 * count;
+    
+    kernelFusedMetrics(rows, count, seq_len, fast_acos, out);
+    
+    const size_t stride = static_cast<size_t>(seq_len) * 3;
+    for (size_t i = 0; i < count; ++i) {
+        TrajectoryMetrics& metrics = results[i];
+        TrajectoryView view(rows + i * stride, static_cast<size_t>(seq_len));
+        
+        metrics.path_length = out.path_length[i];
+        metrics.straight_line_distance = computeStraightLineDistance(view);
+        metrics.path_efficiency = 0.0f;
+        
+        if (seq_len < 2) {
+            metrics.path_efficiency = 1.0f;
+        } else if (metrics.path_length >= 1e-6f) {
+            metrics.path_efficiency = metrics.straight_line_distance / metrics.path_length;
+        }
+        
+        metrics.avg_curvature = out.avg_curvature[i];
+        metrics.max_curvature = out.max_curvature[i];
+        metrics.smoothness_score = 1.0f / (1.0f + metrics.avg_curvature);
+        metrics.endpoint_error = computeEndpointError(view, expected_ends[i * end_stride]);
+        metrics.avg_velocity = (seq_len > 1) ? metrics.path_length / (seq_len - 1) : 0.0f;
+        metrics.min_altitude = out.min_altitude[i];
+        metrics.max_altitude = out.max_altitude[i];
+        metrics.avg_altitude = out.avg_altitude[i];
+    }
+}
+
+/**
+ * @brief Evaluate count packed rows; expected end of row i is
+ *        expected_ends[i * end_stride]
+ */
+void evaluatePackedRows(const float* rows, size_t count, int seq_len,
+                        const Waypoint* expected_ends, size_t end_stride,
+                        TrajectoryMetrics* results, bool fast_acos) {
+    if (count == 0) return;
+    
+    static TelemetryHistogram* const scoring_time = stageHistogram("scoring");
+    ScopedTimer timer(scoring_time);
+    
+    if (seq_len < 1) {
+        std::fill(results, results + count, TrajectoryMetrics());
+        return;
     }
     
-    metrics.avg_altitude = sum_altitude / trajectory.size();
+    // Kernel output columns live on the stack, one block of rows at a
+    // time, so evaluation makes no heap allocation
+    constexpr size_t kBlock = 64;
+    float columns[kBlock * 6];
+    const size_t stride = static_cast<size_t>(seq_len) * 3;
     
-    return metrics;
+    for (size_t first = 0; first < count; first += kBlock) {
+        const size_t n = std::min(kBlock, count - first);
+        evaluateKernelBlock(rows + first * stride, n, seq_len, expected_ends + first * end_stride,
+                            end_stride, results + first, fast_acos, columns);
+    }
+}
+
+} // namespace
+
+std::vector<TrajectoryMetrics> evaluateTrajectories(const TrajectoryBatch& batch,
+                                                    const Waypoint& expected_end,
+                                                    bool fast_acos) {
+    std::vector<TrajectoryMetrics> results(batch.size());
+    evaluatePackedRows(batch.data(), batch.size(), batch.seqLen(), &expected_end, 0,
+                       results.data(), fast_acos);
+    return results;
+}
+
+void evaluateTrajectories(const TrajectoryBatch& batch, size_t first, size_t count,
+                          const Waypoint& expected_end, TrajectoryMetrics* results,
+                          bool fast_acos) {
+    if (first > batch.size() || count > batch.size() - first) {
+        throw std::runtime_error("evaluateTrajectories: row range out of bounds");
+    }
+    
+    if (count == 0) return;
+    evaluatePackedRows(batch.row(first), count, batch.seqLen(), &expected_end, 0, results, fast_acos);
+}
+
+std::vector<TrajectoryMetrics> evaluateTrajectories(const TrajectoryBatch& batch,
+                                                    const std::vector<Waypoint>& expected_ends,
+                                                    bool fast_acos) {
+    if (expected_ends.size() != batch.size()) {
+        throw std::runtime_error("evaluateTrajectories: expected_ends size does not match batch size");
+    }
+    
+    std::vector<TrajectoryMetrics> results(batch.size());
+    evaluatePackedRows(batch.data(), batch.size(), batch.seqLen(), expected_ends.data(), 1,
+                       results.data(), fast_acos);
+    return results;
+}
+
+void evaluateTrajectories(const float* rows, size_t count, int seq_len,
+                          const Waypoint* expected_ends, TrajectoryMetrics* results,
+                          bool fast_acos) {
+    evaluatePackedRows(rows, count, seq_len, expected_ends, 1, results, fast_acos);
+}
+
+void printTrajectoryStats(const TrajectoryView& trajectory) {
+    float path_length = computePathLength(trajectory);
+    float avg_curvature = computeAverageCurvature(trajectory);
+    float smoothness = computeSmoothnessScore(trajectory);
+    float straight_dist = computeStraightLineDistance(trajectory);
+    
+    float efficiency = straight_dist / path_length;
+    
+    std::cout << "Trajectory Statistics:" << std::endl;
+    std::cout << "  Path length: " << path_length << " m" << std::endl;
+    std::cout << "  Straight-line distance: " << straight_dist << " m" << std::endl;
+    std::cout << "  Efficiency: " << efficiency << std::endl;
+    std::cout << "  Avg curvature: " << avg_curvature << " rad/m" << std::endl;
+    std::cout << "  Smoothness score: " << smoothness << std::endl;
 }
 
 void printMetrics(const TrajectoryMetrics& metrics) {
@@ -259,53 +521,97 @@ float computeDiversity(const std::vector<Trajectory>& trajectories) {
     return (n_pairs > 0) ? (total_distance / n_pairs) : 0.0f;
 }
 
-bool isTrajectoryValid(const Trajectory& trajectory,
+float computeDiversity(const TrajectoryBatch& batch) {
+    if (batch.size() < 2) return 0.0f;
+    
+    double total_distance = kernelPairwiseDistanceSum(batch.data(), batch.size(), batch.seqLen());
+    double n_pairs = 0.5 * static_cast<double>(batch.size()) * (batch.size() - 1);
+    
+    return static_cast<float>(total_distance / n_pairs);
+}
+
+std::vector<float> computePathLengths(const TrajectoryBatch& batch) {
+    std::vector<float> lengths(batch.size());
+    kernelPathLengths(batch.data(), batch.size(), batch.seqLen(), lengths.data());
+    return lengths;
+}
+
+void computeCurvatureStats(const TrajectoryBatch& batch,
+                           std::vector<float>& avg_curvatures,
+                           std::vector<float>& max_curvatures,
+                           bool fast_acos) {
+    avg_curvatures.resize(batch.size());
+    max_curvatures.resize(batch.size());
+    kernelCurvatureStats(batch.data(), batch.size(), batch.seqLen(), fast_acos,
+                         avg_curvatures.data(), max_curvatures.data());
+}
+
+std::vector<float> computeSmoothnessScores(const TrajectoryBatch& batch, bool fast_acos) {
+    std::vector<float> scores(batch.size());
+    kernelCurvatureStats(batch.data(), batch.size(), batch.seqLen(), fast_acos,
+                         scores.data(), nullptr);
+    
+    for (float& score : scores) {
+        score = 1.0f / (1.0f + score);
+    }
+    
+    return scores;
+}
+
+std::vector<float> computeSecondOrderSmoothness(const TrajectoryBatch& batch) {
+    std::vector<float> losses(batch.size());
+    kernelSecondOrderSmoothness(batch.data(), batch.size(), batch.seqLen(), losses.data());
+    return losses;
+}
+
+bool isTrajectoryValid(const TrajectoryView& trajectory,
                        float max_curvature,
                        float min_altitude,
                        float max_altitude) {
     if (trajectory.empty()) return false;
     
+    // Endpoint error is not part of validity; any expected end will do
+    TrajectoryMetrics metrics = evaluateTrajectory(trajectory, trajectory.back());
+    
+    return isTrajectoryValid(metrics, max_curvature, min_altitude, max_altitude);
+}
+
+bool isTrajectoryValid(const TrajectoryMetrics& metrics,
+                       float max_curvature,
+                       float min_altitude,
+                       float max_altitude) {
     // Check curvature constraint
-    float traj_max_curvature = computeMaxCurvature(trajectory);
-    if (traj_max_curvature > max_curvature) return false;
+    if (metrics.max_curvature > max_curvature) return false;
     
     // Check altitude constraints
-    for (const auto& wp : trajectory) {
-        if (wp.z < min_altitude || wp.z > max_altitude) {
-            return false;
-        }
+    return metrics.min_altitude >= min_altitude && metrics.max_altitude <= max_altitude;
+}
+
+namespace {
+
+std::vector<size_t> rankedIndices(const std::vector<RankedTrajectory>& ranked) {
+    std::vector<size_t> ranked_indices;
+    ranked_indices.reserve(ranked.size());
+    for (const auto& candidate : ranked) {
+        ranked_indices.push_back(candidate.index);
     }
-    
-    return true;
+    return ranked_indices;
 }
 
+} // namespace
+
 std::vector<size_t> rankTrajectories(const std::vector<Trajectory>& trajectories,
                                      const Waypoint& expected_end,
                                      float w1, float w2, float w3) {
-    std::vector<std::pair<float, size_t>> scores;
-    
-    for (size_t i = 0; i < trajectories.size(); ++i) {
-        TrajectoryMetrics metrics = evaluateTrajectory(trajectories[i], expected_end);
-        
-        // Quality score = w1*efficiency + w2*smoothness - w3*endpoint_error
-        // Normalize endpoint error by dividing by a typical scale (e.g., 100m)
-        float score = w1 * metrics.path_efficiency 
-                    + w2 * metrics.smoothness_score 
-                    - w3 * (metrics.endpoint_error / 100.0f);
-        
-        scores.push_back({score, i});
-    }
-    
-    // Sort by score (descending)
-    std::sort(scores.begin(), scores.end(), 
-              [](const auto& a, const auto& b) { return a.first > b.first; });
-    
-    std::vector<size_t> ranked_indices;
-    for (const auto& pair : scores) {
-        ranked_indices.push_back(pair.second);
-    }
-    
-    return ranked_indices;
+    RankingEngine engine(RankingConfig(), RankingEngine::weightedScorer(w1, w2, w3));
+    return rankedIndices(engine.rank(trajectories, expected_end));
+}
+
+std::vector<size_t> rankTrajectories(const TrajectoryBatch& batch,
+                                     const Waypoint& expected_end,
+                                     float w1, float w2, float w3) {
+    RankingEngine engine(RankingConfig(), RankingEngine::weightedScorer(w1, w2, w3));
+    return rankedIndices(engine.rank(batch, expected_end));
 }
 
 } // namespace trajectory
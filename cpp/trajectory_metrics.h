@@ -14,13 +14,18 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <memory_resource>
 #include <numeric>
 
 namespace trajectory {
 
-// Forward declare Waypoint and Trajectory from trajectory_inference.h
+// Forward declare Waypoint, Trajectory and TrajectoryView from trajectory_inference.h
+// A Trajectory converts implicitly to TrajectoryView, so every metric below
+// accepts either an owning Trajectory or a row of a TrajectoryBatch.
 struct Waypoint;
 using Trajectory = std::vector<Waypoint>;
+struct TrajectoryView;
+class TrajectoryBatch;
 
 /**
  * @brief Complete set of trajectory quality metrics
@@ -55,7 +60,7 @@ struct TrajectoryMetrics {
  * @param trajectory Input trajectory
  * @return Total path length in meters
  */
-float computePathLength(const Trajectory& trajectory);
+float computePathLength(const TrajectoryView& trajectory);
 
 /**
  * @brief Compute straight-line distance from start to end
@@ -65,7 +70,7 @@ float computePathLength(const Trajectory& trajectory);
  * @param trajectory Input trajectory
  * @return Straight-line distance in meters
  */
-float computeStraightLineDistance(const Trajectory& trajectory);
+float computeStraightLineDistance(const TrajectoryView& trajectory);
 
 /**
  * @brief Compute path efficiency (ratio of straight-line to path length)
@@ -76,7 +81,7 @@ float computeStraightLineDistance(const Trajectory& trajectory);
  * @param trajectory Input trajectory
  * @return Path efficiency
  */
-float computePathEfficiency(const Trajectory& trajectory);
+float computePathEfficiency(const TrajectoryView& trajectory);
 
 /**
  * @brief Compute curvature at each point
@@ -91,7 +96,34 @@ float computePathEfficiency(const Trajectory& trajectory);
  * @param trajectory Input trajectory
  * @return Vector of curvatures (rad/m) at each interior point
  */
-std::vector<float> computeCurvatures(const Trajectory& trajectory);
+std::vector<float> computeCurvatures(const TrajectoryView& trajectory);
+
+/**
+ * @brief computeCurvatures() into memory from resource (e.g. a RequestArena)
+ */
+std::pmr::vector<float> computeCurvatures(const TrajectoryView& trajectory,
+                                          std::pmr::memory_resource* resource);
+
+/**
+ * @brief One curvature step of computeCurvatures(): κ = θ / ||v1||
+ * 
+ * Every scalar curvature loop goes through here, so the metrics and the
+ * constraint filter cannot drift apart (the SIMD kernels mirror it).
+ * 
+ * @param v1 Incoming segment p[i] - p[i-1], of length norm1
+ * @param v2 Outgoing segment p[i+1] - p[i], of length norm2
+ * @param curvature Receives κ (rad/m)
+ * @return False if either segment has zero length (no curvature at p[i])
+ */
+inline bool turnCurvature(const float* v1, float norm1, const float* v2, float norm2,
+                          float& curvature) {
+    if (!(norm1 > 1e-6f && norm2 > 1e-6f)) return false;
+    
+    float cos_angle = (v1[0]*v2[0] + v1[1]*v2[1] + v1[2]*v2[2]) / (norm1 * norm2);
+    cos_angle = std::max(-1.0f, std::min(1.0f, cos_angle));
+    curvature = std::acos(cos_angle) / norm1;
+    return true;
+}
 
 /**
  * @brief Compute average curvature
@@ -102,7 +134,7 @@ std::vector<float> computeCurvatures(const Trajectory& trajectory);
  * @param trajectory Input trajectory
  * @return Average curvature in rad/m
  */
-float computeAverageCurvature(const Trajectory& trajectory);
+float computeAverageCurvature(const TrajectoryView& trajectory);
 
 /**
  * @brief Compute maximum curvature
@@ -110,7 +142,7 @@ float computeAverageCurvature(const Trajectory& trajectory);
  * @param trajectory Input trajectory
  * @return Maximum curvature in rad/m
  */
-float computeMaxCurvature(const Trajectory& trajectory);
+float computeMaxCurvature(const TrajectoryView& trajectory);
 
 /**
  * @brief Compute smoothness score
@@ -121,7 +153,7 @@ float computeMaxCurvature(const Trajectory& trajectory);
  * @param trajectory Input trajectory
  * @return Smoothness score
  */
-float computeSmoothnessScore(const Trajectory& trajectory);
+float computeSmoothnessScore(const TrajectoryView& trajectory);
 
 /**
  * @brief Compute endpoint error
@@ -132,7 +164,7 @@ float computeSmoothnessScore(const Trajectory& trajectory);
  * @param expected_end Expected end waypoint
  * @return Endpoint error in meters
  */
-float computeEndpointError(const Trajectory& trajectory, 
+float computeEndpointError(const TrajectoryView& trajectory, 
                           const Waypoint& expected_end);
 
 /**
@@ -143,7 +175,7 @@ float computeEndpointError(const Trajectory& trajectory,
  * @param trajectory Input trajectory
  * @return Average velocity in meters per step
  */
-float computeAverageVelocity(const Trajectory& trajectory);
+float computeAverageVelocity(const TrajectoryView& trajectory);
 
 /**
  * @brief Compute second-order smoothness (acceleration penalty)
@@ -154,20 +186,123 @@ float computeAverageVelocity(const Trajectory& trajectory);
  * @param trajectory Input trajectory
  * @return Smoothness loss value
  */
-float computeSecondOrderSmoothness(const Trajectory& trajectory);
+float computeSecondOrderSmoothness(const TrajectoryView& trajectory);
 
 /**
  * @brief Evaluate all quality metrics for a trajectory
  * 
- * Computes all available metrics in one pass for efficiency
+ * Computes all available metrics in one pass over the waypoints without
+ * heap allocation. Results are identical to calling the individual
+ * metric functions.
  * 
  * @param trajectory Input trajectory
  * @param expected_end Expected end waypoint (for endpoint error)
  * @return Complete metrics structure
  */
-TrajectoryMetrics evaluateTrajectory(const Trajectory& trajectory,
+TrajectoryMetrics evaluateTrajectory(const TrajectoryView& trajectory,
                                      const Waypoint& expected_end);
 
+/**
+ * @brief Running state of evaluateTrajectory(), one waypoint at a time
+ * 
+ * A copy taken after waypoint i is a prefix sum of every metric: adding
+ * other waypoints to it yields exactly (bit for bit) the metrics of the
+ * trajectory p[0..i] followed by those waypoints, without revisiting the
+ * prefix. Used for incremental replanning. The arithmetic mirrors
+ * evaluateTrajectory(), which keeps its own register-resident loop.
+ */
+struct MetricsAccumulator {
+    size_t count = 0;             // Waypoints added
+    float first[3] = {0, 0, 0};   // First waypoint
+    float last[3] = {0, 0, 0};    // Most recent waypoint
+    float segment[3] = {0, 0, 0}; // Most recent segment vector
+    float segment_norm = 0.0f;
+    float path_length = 0.0f;
+    float curvature_sum = 0.0f;
+    size_t curvature_count = 0;
+    float max_curvature = 0.0f;
+    float min_altitude = 0.0f;
+    float max_altitude = 0.0f;
+    float sum_altitude = 0.0f;
+    
+    /**
+     * @brief Append one waypoint
+     */
+    void add(const Waypoint& p);
+    
+    /**
+     * @brief Metrics of the waypoints added so far
+     * @param expected_end Expected end waypoint (for endpoint error)
+     */
+    TrajectoryMetrics finish(const Waypoint& expected_end) const;
+};
+
+/**
+ * @brief Evaluate all quality metrics for every trajectory in a batch
+ * 
+ * Uses the fused SIMD kernel (kernelFusedMetrics) across rows.
+ * 
+ * @param batch Input trajectories
+ * @param expected_end Expected end waypoint shared by all rows
+ * @param fast_acos Use fastAcos() for the curvature angles
+ * @return Metrics per trajectory
+ */
+std::vector<TrajectoryMetrics> evaluateTrajectories(const TrajectoryBatch& batch,
+                                                    const Waypoint& expected_end,
+                                                    bool fast_acos = false);
+
+/**
+ * @brief Evaluate rows [first, first + count) of a batch into caller storage
+ * 
+ * Lets parallel callers split one batch into chunks without copying.
+ * 
+ * @param batch Input trajectories
+ * @param first First row
+ * @param count Number of rows
+ * @param expected_end Expected end waypoint shared by all rows
+ * @param results Receives count metrics
+ * @param fast_acos Use fastAcos() for the curvature angles
+ */
+void evaluateTrajectories(const TrajectoryBatch& batch, size_t first, size_t count,
+                          const Waypoint& expected_end, TrajectoryMetrics* results,
+                          bool fast_acos = false);
+
+/**
+ * @brief Evaluate a batch whose rows have different expected ends
+ * 
+ * @param batch Input trajectories
+ * @param expected_ends Expected end waypoint per row (size must match batch)
+ * @param fast_acos Use fastAcos() for the curvature angles
+ * @return Metrics per trajectory
+ */
+std::vector<TrajectoryMetrics> evaluateTrajectories(const TrajectoryBatch& batch,
+                                                    const std::vector<Waypoint>& expected_ends,
+                                                    bool fast_acos = false);
+
+/**
+ * @brief Evaluate packed [count, seq_len, 3] rows in place
+ * 
+ * For rows that do not live in a TrajectoryBatch, such as a chunk of a
+ * memory-mapped TrajectoryReader file.
+ * 
+ * @param rows First row
+ * @param count Number of rows
+ * @param seq_len Waypoints per row
+ * @param expected_ends Expected end waypoint per row (count entries)
+ * @param results Receives count metrics
+ * @param fast_acos Use fastAcos() for the curvature angles
+ */
+void evaluateTrajectories(const float* rows, size_t count, int seq_len,
+                          const Waypoint* expected_ends, TrajectoryMetrics* results,
+                          bool fast_acos = false);
+
+/**
+ * @brief Print trajectory statistics (length, efficiency, curvature)
+ * 
+ * @param trajectory Input trajectory
+ */
+void printTrajectoryStats(const TrajectoryView& trajectory);
+
 /**
  * @brief Print trajectory metrics in human-readable format
  * 
@@ -185,6 +320,68 @@ void printMetrics(const TrajectoryMetrics& metrics);
  */
 float computeDiversity(const std::vector<Trajectory>& trajectories);
 
+/**
+ * @brief Compute diversity of a batch with the vectorized kernels
+ * 
+ * Same definition as computeDiversity(std::vector<Trajectory>); all rows
+ * share one length, so no min_len truncation is needed. For parallel,
+ * sampled or sketched evaluation see trajectory_diversity.h.
+ * 
+ * @param batch Trajectories to compare
+ * @return Average diversity score
+ */
+float computeDiversity(const TrajectoryBatch& batch);
+
+// ============================================================================
+// Batch metrics
+// 
+// These score every row of a TrajectoryBatch with the SIMD kernels in
+// trajectory_kernels.h (AVX2/NEON selected at runtime, scalar fallback).
+// Results match the single-trajectory functions to float rounding, and
+// exactly on the scalar path.
+// ============================================================================
+
+/**
+ * @brief Compute path length of every trajectory in a batch
+ * 
+ * @param batch Input trajectories
+ * @return Path length per trajectory (m)
+ */
+std::vector<float> computePathLengths(const TrajectoryBatch& batch);
+
+/**
+ * @brief Compute average and maximum curvature of every trajectory
+ * 
+ * @param batch Input trajectories
+ * @param avg_curvatures Receives average curvature per trajectory (rad/m)
+ * @param max_curvatures Receives maximum curvature per trajectory (rad/m)
+ * @param fast_acos Use fastAcos() (error <= kFastAcosMaxError rad per angle)
+ */
+void computeCurvatureStats(const TrajectoryBatch& batch,
+                           std::vector<float>& avg_curvatures,
+                           std::vector<float>& max_curvatures,
+                           bool fast_acos = false);
+
+/**
+ * @brief Compute smoothness score of every trajectory
+ * 
+ * Formula: S = 1 / (1 + κ_avg)
+ * 
+ * @param batch Input trajectories
+ * @param fast_acos Use fastAcos() for the curvature angles
+ * @return Smoothness score per trajectory
+ */
+std::vector<float> computeSmoothnessScores(const TrajectoryBatch& batch,
+                                           bool fast_acos = false);
+
+/**
+ * @brief Compute second-order smoothness of every trajectory
+ * 
+ * @param batch Input trajectories
+ * @return Smoothness loss per trajectory
+ */
+std::vector<float> computeSecondOrderSmoothness(const TrajectoryBatch& batch);
+
 /**
  * @brief Check if trajectory violates constraints
  * 
@@ -194,7 +391,24 @@ float computeDiversity(const std::vector<Trajectory>& trajectories);
  * @param max_altitude Maximum allowed altitude (m)
  * @return True if trajectory is valid
  */
-bool isTrajectoryValid(const Trajectory& trajectory,
+bool isTrajectoryValid(const TrajectoryView& trajectory,
+                       float max_curvature = 0.1f,
+                       float min_altitude = 50.0f,
+                       float max_altitude = 1000.0f);
+
+/**
+ * @brief Check constraints against already evaluated metrics
+ * 
+ * Lets callers that ranked with evaluateTrajectories() validate without
+ * another pass over the waypoints.
+ * 
+ * @param metrics Metrics from evaluateTrajectory/evaluateTrajectories
+ * @param max_curvature Maximum allowed curvature (rad/m)
+ * @param min_altitude Minimum allowed altitude (m)
+ * @param max_altitude Maximum allowed altitude (m)
+ * @return True if trajectory is valid
+ */
+bool isTrajectoryValid(const TrajectoryMetrics& metrics,
                        float max_curvature = 0.1f,
                        float min_altitude = 50.0f,
                        float max_altitude = 1000.0f);
@@ -203,6 +417,8 @@ bool isTrajectoryValid(const Trajectory& trajectory,
  * @brief Rank trajectories by quality score
  * 
  * Quality score = w1*efficiency + w2*smoothness - w3*endpoint_error
+ * Scoring is spread over the shared thread pool; use RankingEngine
+ * (trajectory_ranking.h) directly to keep only the top K.
  * 
  * @param trajectories Vector of trajectories
  * @param expected_end Expected end waypoint
@@ -215,6 +431,22 @@ std::vector<size_t> rankTrajectories(const std::vector<Trajectory>& trajectories
                                      const Waypoint& expected_end,
                                      float w1 = 0.3f, float w2 = 0.5f, float w3 = 0.2f);
 
+/**
+ * @brief Rank the rows of a batch by quality score
+ * 
+ * Same score as above, evaluated with evaluateTrajectories().
+ * 
+ * @param batch Input trajectories
+ * @param expected_end Expected end waypoint
+ * @param w1 Weight for efficiency (default 0.3)
+ * @param w2 Weight for smoothness (default 0.5)
+ * @param w3 Weight for endpoint error (default 0.2)
+ * @return Row indices sorted by quality (best first)
+ */
+std::vector<size_t> rankTrajectories(const TrajectoryBatch& batch,
+                                     const Waypoint& expected_end,
+                                     float w1 = 0.3f, float w2 = 0.5f, float w3 = 0.2f);
+
 } // namespace trajectory
 
 #endif // TRAJECTORY_METRICS_H
@@ -10,18 +10,66 @@
 #include <cstdlib>
 #include <algorithm>
 
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <pthread.h>
+#endif
+
 namespace trajectory {
 
+namespace {
+
+/**
+ * @brief Title, axis labels and view shared by file and live plots
+ */
+std::string plotSetup(const PlotConfig& config, bool is_3d) {
+    std::ostringstream setup;
+    setup << "set title '" << config.title << "' font 'Arial,16'\n";
+    setup << "set xlabel 'X (m)' font 'Arial,12'\n";
+    setup << "set ylabel 'Y (m)' font 'Arial,12'\n";
+    if (is_3d) {
+        setup << "set zlabel 'Z (m)' font 'Arial,12'\n";
+    }
+    setup << "set grid\n";
+    setup << "set key outside right top\n";
+    if (is_3d) {
+        setup << "set view 60,30\n";
+    }
+    return setup.str();
+}
+
+/**
+ * @brief Append one inline data block ("x y [z]" rows terminated by "e")
+ */
+void appendInlineData(std::string& out, const TrajectoryView& points, bool is_3d) {
+    char line[64];
+    for (size_t i = 0; i < points.size(); ++i) {
+        const Waypoint p = points[i];
+        const int n = is_3d
+            ? std::snprintf(line, sizeof(line), "%.7g %.7g %.7g\n", p.x, p.y, p.z)
+            : std::snprintf(line, sizeof(line), "%.7g %.7g\n", p.x, p.y);
+        out.append(line, static_cast<size_t>(n));
+    }
+    out += "e\n";
+}
+
+} // namespace
+
 TrajectoryPlotter::TrajectoryPlotter(const PlotConfig& config)
-    : config_(config) {
+    : config_(config)
+    , pipe_(nullptr) {
 }
 
-TrajectoryPlotter::~TrajectoryPlotter() = default;
+TrajectoryPlotter::~TrajectoryPlotter() {
+    closeLive();
+}
 
 bool TrajectoryPlotter::isGnuplotAvailable() {
-    // Check if gnuplot is available
-    int result = std::system("gnuplot --version > /dev/null 2>&1");
-    return (result == 0);
+    // Spawning a shell per call is slow enough to show up in redraw loops
+    static const bool available = std::system("gnuplot --version > /dev/null 2>&1") == 0;
+    return available;
 }
 
 std::string TrajectoryPlotter::writeTrajectoryData(const Trajectory& traj, int index) {
@@ -91,25 +139,8 @@ bool TrajectoryPlotter::generateGnuplotScript(const std::vector<std::string>& da
     script << "set output '" << config_.output_file << "'\n\n";
     
     // Set title and labels
-    script << "set title '" << config_.title << "' font 'Arial,16'\n";
-    
-    if (is_3d) {
-        script << "set xlabel 'X (m)' font 'Arial,12'\n";
-        script << "set ylabel 'Y (m)' font 'Arial,12'\n";
-        script << "set zlabel 'Z (m)' font 'Arial,12'\n";
-        script << "set grid\n";
-        script << "set key outside right top\n";
-        script << "set view 60,30\n\n";
-        
-        script << "splot ";
-    } else {
-        script << "set xlabel 'X (m)' font 'Arial,12'\n";
-        script << "set ylabel 'Y (m)' font 'Arial,12'\n";
-        script << "set grid\n";
-        script << "set key outside right top\n\n";
-        
-        script << "plot ";
-    }
+    script << plotSetup(config_, is_3d) << "\n";
+    script << (is_3d ? "splot " : "plot ");
     
     // Plot trajectories
     for (size_t i = 0; i < data_files.size(); ++i) {
@@ -253,4 +284,134 @@ bool TrajectoryPlotter::plot2D(const std::vector<Trajectory>& trajectories,
     return success;
 }
 
+bool TrajectoryPlotter::openLive() {
+    closeLive();
+    
+    if (!isGnuplotAvailable()) {
+        std::cerr << "gnuplot is not available. Please install gnuplot to use plotting features." << std::endl;
+        return false;
+    }
+
+#ifdef _WIN32
+    pipe_ = _popen("gnuplot", "w");
+#else
+    pipe_ = popen("gnuplot", "w");
+#endif
+    if (!pipe_) {
+        std::cerr << "Failed to start gnuplot" << std::endl;
+        return false;
+    }
+    
+    std::ostringstream init;
+    if (config_.live_terminal.empty()) {
+        init << "set terminal pngcairo size " << config_.width << "," << config_.height
+             << " enhanced font 'Arial,12'\n";
+    } else {
+        init << "set terminal " << config_.live_terminal << " size "
+             << config_.width << "," << config_.height << "\n";
+    }
+    init << plotSetup(config_, config_.show_3d);
+    
+    return sendLive(init.str());
+}
+
+bool TrajectoryPlotter::redraw(const TrajectoryView* trajectories, size_t count,
+                               const Waypoint& start, const Waypoint& end,
+                               const std::vector<std::string>& labels) {
+    if (!pipe_) {
+        std::cerr << "Live plot is not open" << std::endl;
+        return false;
+    }
+    
+    const bool is_3d = config_.show_3d;
+    const bool to_file = config_.live_terminal.empty();
+    const char* columns = is_3d ? "1:2:3" : "1:2";
+    
+    frame_.clear();
+    if (to_file) {
+        frame_ += "set output '" + config_.output_file + "'\n";
+    }
+    
+    frame_ += is_3d ? "splot " : "plot ";
+    for (size_t i = 0; i < count; ++i) {
+        const std::string label = (i < labels.size() && !labels[i].empty()) ?
+                                  labels[i] : ("Trajectory " + std::to_string(i + 1));
+        if (i > 0) frame_ += ", ";
+        frame_ += std::string("'-' using ") + columns + " with lines lw 2 title '" + label + "'";
+    }
+    if (config_.show_start_end) {
+        if (count > 0) frame_ += ", ";
+        frame_ += std::string("'-' using ") + columns + " with points pt 7 ps 2 lc rgb 'green' title 'Start'";
+        frame_ += std::string(", '-' using ") + columns + " with points pt 7 ps 2 lc rgb 'red' title 'End'";
+    }
+    frame_ += "\n";
+    
+    // One inline block per plot element, in the order they were listed
+    for (size_t i = 0; i < count; ++i) {
+        appendInlineData(frame_, trajectories[i], is_3d);
+    }
+    if (config_.show_start_end) {
+        appendInlineData(frame_, TrajectoryView(&start.x, 1), is_3d);
+        appendInlineData(frame_, TrajectoryView(&end.x, 1), is_3d);
+    }
+    
+    // Closing the output finishes the image so watchers never see a partial file
+    if (to_file) {
+        frame_ += "unset output\n";
+    }
+    
+    return sendLive(frame_);
+}
+
+bool TrajectoryPlotter::redraw(const std::vector<Trajectory>& trajectories,
+                               const Waypoint& start, const Waypoint& end,
+                               const std::vector<std::string>& labels) {
+    std::vector<TrajectoryView> views(trajectories.begin(), trajectories.end());
+    return redraw(views.data(), views.size(), start, end, labels);
+}
+
+void TrajectoryPlotter::closeLive() {
+    if (!pipe_) return;
+    
+    // gnuplot exits on end of input
+#ifdef _WIN32
+    _pclose(pipe_);
+#else
+    pclose(pipe_);
+#endif
+    pipe_ = nullptr;
+}
+
+bool TrajectoryPlotter::sendLive(const std::string& commands) {
+#ifndef _WIN32
+    // A gnuplot that exited would raise SIGPIPE and kill the process; block
+    // it for this write and discard it if it was raised here
+    sigset_t sigpipe_set, old_set;
+    sigemptyset(&sigpipe_set);
+    sigaddset(&sigpipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipe_set, &old_set);
+    
+    sigset_t pending;
+    sigpending(&pending);
+    const bool was_pending = sigismember(&pending, SIGPIPE) == 1;
+#endif
+
+    const bool ok = std::fwrite(commands.data(), 1, commands.size(), pipe_) == commands.size() &&
+                    std::fflush(pipe_) == 0;
+
+#ifndef _WIN32
+    if (!ok && errno == EPIPE && !was_pending) {
+        const struct timespec no_wait = {0, 0};
+        sigtimedwait(&sigpipe_set, nullptr, &no_wait);
+    }
+    pthread_sigmask(SIG_SETMASK, &old_set, nullptr);
+#endif
+
+    if (!ok) {
+        std::cerr << "gnuplot pipe closed; live plot stopped" << std::endl;
+        closeLive();
+    }
+    return ok;
+}
+
 } // namespace trajectory
@@ -2,12 +2,18 @@
  * @file trajectory_plotter.h
  * @brief Plotting utilities for trajectories using gnuplot
  * @author Mission Planner Team
+ * 
+ * plot3D()/plot2D() render one image through temporary files and a
+ * gnuplot run. For views that redraw every replanning cycle, openLive()
+ * keeps one gnuplot process on a pipe and redraw() streams the data
+ * inline, without temporary files or a process per frame.
  */
 
 #ifndef TRAJECTORY_PLOTTER_H
 #define TRAJECTORY_PLOTTER_H
 
 #include "trajectory_inference.h"
+#include <cstdio>
 #include <string>
 #include <vector>
 
@@ -24,6 +30,7 @@ struct PlotConfig {
     bool show_3d = true;
     bool show_start_end = true;
     bool save_data = true;
+    std::string live_terminal;   // openLive() terminal ("" = pngcairo into output_file; e.g. "qt", "wxt")
     
     PlotConfig() = default;
 };
@@ -40,10 +47,13 @@ public:
     explicit TrajectoryPlotter(const PlotConfig& config = PlotConfig());
     
     /**
-     * @brief Destructor
+     * @brief Destructor (closes the live pipe if open)
      */
     ~TrajectoryPlotter();
     
+    TrajectoryPlotter(const TrajectoryPlotter&) = delete;
+    TrajectoryPlotter& operator=(const TrajectoryPlotter&) = delete;
+    
     /**
      * @brief Plot multiple trajectories in 3D
      * @param trajectories Vector of trajectories to plot
@@ -81,12 +91,60 @@ public:
     
     /**
      * @brief Check if gnuplot is available
+     * 
+     * The check runs gnuplot once per process; the result is cached.
+     * 
      * @return True if gnuplot is available
      */
     static bool isGnuplotAvailable();
     
+    /**
+     * @brief Start a persistent gnuplot process for redraw()
+     * 
+     * Uses config.live_terminal, or pngcairo rewriting config.output_file
+     * on every redraw when it is empty. Axis and style settings are sent
+     * once here.
+     * 
+     * @return True if gnuplot was started
+     */
+    bool openLive();
+    
+    /**
+     * @brief Redraw the live view (3D if config.show_3d, else X-Y)
+     * 
+     * Trajectory data is streamed inline over the pipe.
+     * 
+     * @param trajectories Trajectories to draw
+     * @param count Number of trajectories
+     * @param start Starting waypoint
+     * @param end Ending waypoint
+     * @param labels Optional labels for each trajectory
+     * @return False if the live view is not open or gnuplot went away
+     */
+    bool redraw(const TrajectoryView* trajectories, size_t count,
+                const Waypoint& start, const Waypoint& end,
+                const std::vector<std::string>& labels = {});
+    
+    bool redraw(const std::vector<Trajectory>& trajectories,
+                const Waypoint& start, const Waypoint& end,
+                const std::vector<std::string>& labels = {});
+    
+    /**
+     * @brief Stop the live gnuplot process
+     */
+    void closeLive();
+    
+    bool isLive() const { return pipe_ != nullptr; }
+
 private:
     PlotConfig config_;
+    std::FILE* pipe_;
+    std::string frame_;   // Reused command buffer for redraw()
+    
+    /**
+     * @brief Write to the live pipe; closes it if gnuplot has exited
+     */
+    bool sendLive(const std::string& commands);
     
     /**
      * @brief Write trajectory to temporary file
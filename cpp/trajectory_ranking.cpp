@@ -0,0 +1,146 @@
+/**
+ * @file trajectory_ranking.cpp
+ * @brief Implementation of parallel ranking and top-K selection
+ */
+
+#include "trajectory_ranking.h"
+#include "trajectory_inference.h"
+#include "trajectory_batch.h"
+#include "thread_pool.h"
+#include "telemetry.h"
+#include <algorithm>
+
+namespace trajectory {
+
+namespace {
+
+TelemetryHistogram* rankingTime() {
+    static TelemetryHistogram* const histogram = stageHistogram("ranking");
+    return histogram;
+}
+
+} // namespace
+
+RankingEngine::RankingEngine(const RankingConfig& config, TrajectoryScorer scorer)
+    : config_(config), pool_(nullptr) {
+    setScorer(std::move(scorer));
+    
+    if (config_.num_threads > 1) {
+        own_pool_ = std::make_unique<ThreadPool>(config_.num_threads - 1);
+        pool_ = own_pool_.get();
+    } else if (config_.num_threads == 0) {
+        pool_ = &ThreadPool::shared();
+    }
+    
+    if (config_.grain_size == 0) {
+        config_.grain_size = 1;
+    }
+}
+
+RankingEngine::~RankingEngine() = default;
+
+void RankingEngine::setScorer(TrajectoryScorer scorer) {
+    scorer_ = scorer ? std::move(scorer) : weightedScorer();
+}
+
+TrajectoryScorer RankingEngine::weightedScorer(float w1, float w2, float w3) {
+    return [w1, w2, w3](const TrajectoryMetrics& metrics) {
+        // Quality score = w1*efficiency + w2*smoothness - w3*endpoint_error
+        // Normalize endpoint error by dividing by a typical scale (e.g., 100m)
+        return w1 * metrics.path_efficiency
+             + w2 * metrics.smoothness_score
+             - w3 * (metrics.endpoint_error / 100.0f);
+    };
+}
+
+void RankingEngine::forEachChunk(size_t n, const std::function<void(size_t, size_t)>& body) const {
+    // Small inputs are not worth waking the pool for
+    if (!pool_ || n <= config_.grain_size) {
+        body(0, n);
+        return;
+    }
+    
+    pool_->parallelFor(0, n, config_.grain_size, body);
+}
+
+size_t RankingEngine::select(RankedTrajectory* candidates, size_t n) const {
+    const size_t k = (config_.top_k == 0) ? n : std::min(config_.top_k, n);
+    
+    // O(n) partition around the K-th best, then sort only the K winners
+    if (k < n) {
+        std::nth_element(candidates, candidates + k, candidates + n, rankedBefore);
+    }
+    
+    std::sort(candidates, candidates + k, rankedBefore);
+    return k;
+}
+
+void RankingEngine::scoreRange(const TrajectoryBatch& batch, const Waypoint& expected_end,
+                               RankedTrajectory* candidates, size_t first, size_t last) const {
+    // Metrics are evaluated in blocks through stack scratch, so scoring
+    // does not allocate
+    constexpr size_t kBlock = 64;
+    TrajectoryMetrics metrics[kBlock];
+    
+    for (size_t block = first; block < last; block += kBlock) {
+        const size_t count = std::min(kBlock, last - block);
+        evaluateTrajectories(batch, block, count, expected_end, metrics, config_.fast_acos);
+        
+        for (size_t i = 0; i < count; ++i) {
+            RankedTrajectory& candidate = candidates[block + i];
+            candidate.index = block + i;
+            candidate.metrics = metrics[i];
+            candidate.score = scorer_(candidate.metrics);
+        }
+    }
+}
+
+void RankingEngine::scoreRows(const TrajectoryBatch& batch, const Waypoint& expected_end,
+                              RankedTrajectory* candidates) const {
+    forEachChunk(batch.size(), [&](size_t first, size_t last) {
+        scoreRange(batch, expected_end, candidates, first, last);
+    });
+}
+
+std::vector<RankedTrajectory> RankingEngine::rank(const TrajectoryBatch& batch,
+                                                  const Waypoint& expected_end) const {
+    ScopedTimer timer(rankingTime());
+    std::vector<RankedTrajectory> candidates(batch.size());
+    
+    scoreRows(batch, expected_end, candidates.data());
+    candidates.resize(select(candidates.data(), candidates.size()));
+    return candidates;
+}
+
+std::pmr::vector<RankedTrajectory> RankingEngine::rank(const TrajectoryBatch& batch,
+                                                       const Waypoint& expected_end,
+                                                       std::pmr::memory_resource* resource) const {
+    ScopedTimer timer(rankingTime());
+    std::pmr::vector<RankedTrajectory> candidates(batch.size(), resource);
+    
+    // On the calling thread: handing chunks to the pool allocates its
+    // task state, which would defeat the arena
+    scoreRange(batch, expected_end, candidates.data(), 0, batch.size());
+    candidates.resize(select(candidates.data(), candidates.size()));
+    return candidates;
+}
+
+std::vector<RankedTrajectory> RankingEngine::rank(const std::vector<Trajectory>& trajectories,
+                                                  const Waypoint& expected_end) const {
+    ScopedTimer timer(rankingTime());
+    std::vector<RankedTrajectory> candidates(trajectories.size());
+    
+    forEachChunk(trajectories.size(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            RankedTrajectory& candidate = candidates[i];
+            candidate.index = i;
+            candidate.metrics = evaluateTrajectory(trajectories[i], expected_end);
+            candidate.score = scorer_(candidate.metrics);
+        }
+    });
+    
+    candidates.resize(select(candidates.data(), candidates.size()));
+    return candidates;
+}
+
+} // namespace trajectory
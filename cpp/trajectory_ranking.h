@@ -0,0 +1,155 @@
+/**
+ * @file trajectory_ranking.h
+ * @brief Parallel candidate scoring with partial top-K selection
+ * @author Mission Planner Team
+ * 
+ * The planner generates thousands of candidates per mission window but
+ * only keeps a handful. RankingEngine scores candidates across a thread
+ * pool with the fused metrics kernel and selects the best K with
+ * nth_element instead of sorting everything.
+ */
+
+#ifndef TRAJECTORY_RANKING_H
+#define TRAJECTORY_RANKING_H
+
+#include "trajectory_metrics.h"
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace trajectory {
+
+class ThreadPool;
+
+/**
+ * @brief Maps evaluated metrics to a quality score (higher is better)
+ * 
+ * Called concurrently from pool threads, so it must be thread-safe.
+ */
+using TrajectoryScorer = std::function<float(const TrajectoryMetrics&)>;
+
+/**
+ * @brief One ranked candidate
+ */
+struct RankedTrajectory {
+    size_t index;                // Row/index in the scored input
+    float score;                 // Scorer output
+    TrajectoryMetrics metrics;   // Metrics the score was computed from
+};
+
+/**
+ * @brief Ranking order: higher score first, ties to the lower index
+ * 
+ * NaN scores go after every number, which keeps this a strict weak
+ * ordering for std::sort and std::nth_element whatever the scorer returns.
+ */
+inline bool rankedBefore(const RankedTrajectory& a, const RankedTrajectory& b) {
+    const bool a_nan = std::isnan(a.score);
+    const bool b_nan = std::isnan(b.score);
+    if (a_nan != b_nan) return b_nan;
+    if (!a_nan && a.score != b.score) return a.score > b.score;
+    return a.index < b.index;
+}
+
+/**
+ * @brief Ranking engine configuration
+ */
+struct RankingConfig {
+    size_t top_k = 0;             // Candidates to keep (0 = rank all)
+    int num_threads = 0;          // 0 = shared pool, 1 = serial, >1 = own pool
+    size_t grain_size = 256;      // Candidates per parallel scoring chunk
+    bool fast_acos = false;       // Use fastAcos() for curvature angles
+};
+
+/**
+ * @brief Scores candidates in parallel and returns the best K
+ */
+class RankingEngine {
+public:
+    /**
+     * @brief Construct a ranking engine
+     * @param config Ranking configuration
+     * @param scorer Quality score (default: weightedScorer())
+     */
+    explicit RankingEngine(const RankingConfig& config = RankingConfig(),
+                           TrajectoryScorer scorer = TrajectoryScorer());
+    
+    ~RankingEngine();
+    
+    RankingEngine(const RankingEngine&) = delete;
+    RankingEngine& operator=(const RankingEngine&) = delete;
+    
+    /**
+     * @brief Rank the rows of a batch
+     * 
+     * @param batch Candidate trajectories
+     * @param expected_end Expected end waypoint
+     * @return Up to top_k candidates, best first (ties by lower index)
+     */
+    std::vector<RankedTrajectory> rank(const TrajectoryBatch& batch,
+                                       const Waypoint& expected_end) const;
+    
+    /**
+     * @brief rank() with the candidate scratch and result from resource
+     * 
+     * Scores on the calling thread (no pool tasks), so with a RequestArena
+     * the ranking allocates nothing from the heap once the arena's block
+     * is large enough; the scorer must not allocate either.
+     * 
+     * @param batch Candidate trajectories
+     * @param expected_end Expected end waypoint
+     * @param resource Allocator for the result (e.g. a RequestArena)
+     * @return Up to top_k candidates, best first (ties by lower index)
+     */
+    std::pmr::vector<RankedTrajectory> rank(const TrajectoryBatch& batch,
+                                            const Waypoint& expected_end,
+                                            std::pmr::memory_resource* resource) const;
+    
+    /**
+     * @brief Rank a vector of trajectories
+     * 
+     * @param trajectories Candidate trajectories
+     * @param expected_end Expected end waypoint
+     * @return Up to top_k candidates, best first (ties by lower index)
+     */
+    std::vector<RankedTrajectory> rank(const std::vector<Trajectory>& trajectories,
+                                       const Waypoint& expected_end) const;
+    
+    /**
+     * @brief Change the number of candidates kept
+     */
+    void setTopK(size_t top_k) { config_.top_k = top_k; }
+    
+    /**
+     * @brief Replace the quality score
+     */
+    void setScorer(TrajectoryScorer scorer);
+    
+    const RankingConfig& getConfig() const { return config_; }
+    
+    /**
+     * @brief Score used by rankTrajectories()
+     * 
+     * Formula: w1*efficiency + w2*smoothness - w3*(endpoint_error / 100)
+     */
+    static TrajectoryScorer weightedScorer(float w1 = 0.3f, float w2 = 0.5f, float w3 = 0.2f);
+
+private:
+    void forEachChunk(size_t n, const std::function<void(size_t, size_t)>& body) const;
+    void scoreRange(const TrajectoryBatch& batch, const Waypoint& expected_end,
+                    RankedTrajectory* candidates, size_t first, size_t last) const;
+    void scoreRows(const TrajectoryBatch& batch, const Waypoint& expected_end,
+                   RankedTrajectory* candidates) const;
+    size_t select(RankedTrajectory* candidates, size_t n) const;
+    
+    RankingConfig config_;
+    TrajectoryScorer scorer_;
+    std::unique_ptr<ThreadPool> own_pool_;
+    ThreadPool* pool_;
+};
+
+} // namespace trajectory
+
+#endif // TRAJECTORY_RANKING_H
@@ -0,0 +1,158 @@
+/**
+ * @file trajectory_replan.cpp
+ * @brief Implementation of prefix-cached incremental replanning
+ */
+
+#include "trajectory_replan.h"
+#include "trajectory_batch.h"
+#include "trajectory_filter.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace trajectory {
+
+namespace {
+
+void checkIndex(size_t index, size_t size) {
+    if (index >= size) {
+        throw std::runtime_error("Replan index " + std::to_string(index) +
+                                 " is outside the trajectory (" + std::to_string(size) +
+                                 " waypoints)");
+    }
+}
+
+/**
+ * @brief The part of a splice the constraints can newly fail on
+ * 
+ * base[index - 1] and base[index] followed by suffix[1..], so the turn at
+ * the splice point is checked on the waypoints the plan actually keeps.
+ */
+void spliceWindow(const Trajectory& base, size_t index, const TrajectoryView& suffix,
+                  Trajectory& window) {
+    window.clear();
+    if (index > 0) window.push_back(base[index - 1]);
+    window.push_back(base[index]);
+    for (size_t i = 1; i < suffix.size(); ++i) {
+        window.push_back(suffix[i]);
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// PrefixMetrics
+// ============================================================================
+
+PrefixMetrics::PrefixMetrics(const TrajectoryView& trajectory)
+    : trajectory_(trajectory.toTrajectory()) {
+    prefixes_.reserve(trajectory_.size());
+    
+    MetricsAccumulator accumulator;
+    for (const Waypoint& p : trajectory_) {
+        accumulator.add(p);
+        prefixes_.push_back(accumulator);
+    }
+}
+
+PrefixMetrics::PrefixMetrics(const PrefixMetrics& base, size_t index, const TrajectoryView& suffix) {
+    checkIndex(index, base.size());
+    
+    const size_t suffix_points = suffix.empty() ? 0 : suffix.size() - 1;
+    trajectory_.reserve(index + 1 + suffix_points);
+    prefixes_.reserve(index + 1 + suffix_points);
+    
+    trajectory_.assign(base.trajectory_.begin(), base.trajectory_.begin() + index + 1);
+    prefixes_.assign(base.prefixes_.begin(), base.prefixes_.begin() + index + 1);
+    
+    MetricsAccumulator accumulator = prefixes_.back();
+    for (size_t i = 1; i < suffix.size(); ++i) {
+        const Waypoint p = suffix[i];
+        accumulator.add(p);
+        trajectory_.push_back(p);
+        prefixes_.push_back(accumulator);
+    }
+}
+
+TrajectoryMetrics PrefixMetrics::metrics(const Waypoint& expected_end) const {
+    return prefixes_.empty() ? TrajectoryMetrics() : prefixes_.back().finish(expected_end);
+}
+
+TrajectoryMetrics PrefixMetrics::prefixMetrics(size_t index, const Waypoint& expected_end) const {
+    checkIndex(index, size());
+    return prefixes_[index].finish(expected_end);
+}
+
+TrajectoryMetrics PrefixMetrics::spliceMetrics(size_t index, const TrajectoryView& suffix,
+                                               const Waypoint& expected_end) const {
+    checkIndex(index, size());
+    
+    MetricsAccumulator accumulator = prefixes_[index];
+    for (size_t i = 1; i < suffix.size(); ++i) {
+        accumulator.add(suffix[i]);
+    }
+    return accumulator.finish(expected_end);
+}
+
+// ============================================================================
+// Replanning
+// ============================================================================
+
+ReplanResult replanFrom(TrajectoryGenerator& generator,
+                        const PrefixMetrics& current,
+                        size_t index,
+                        const Waypoint& end,
+                        const ReplanOptions& options) {
+    checkIndex(index, current.size());
+    
+    const TrajectoryScorer scorer = options.scorer ? options.scorer
+                                                   : RankingEngine::weightedScorer();
+    
+    ReplanResult result;
+    result.plan = current;
+    result.metrics = current.metrics(end);
+    result.score = scorer(result.metrics);
+    
+    if (options.n_candidates <= 0) return result;
+    
+    TrajectoryBatch suffixes;
+    generator.generateMultiple(current.trajectory()[index], end, options.n_candidates, suffixes);
+    result.generated = suffixes.size();
+    
+    // Constraints are checked on the spliced waypoints, not the raw
+    // suffix: suffix[0] is replaced by plan[index], which changes the turn
+    // there. Whole-plan score of each passing splice; only the winner is
+    // materialized.
+    Trajectory window;
+    bool found = false;
+    size_t best = 0;
+    float best_score = 0.0f;
+    TrajectoryMetrics best_metrics;
+    for (size_t i = 0; i < suffixes.size(); ++i) {
+        if (options.constraints) {
+            spliceWindow(current.trajectory(), index, suffixes.view(i), window);
+            if (checkConstraints(window, *options.constraints) != ConstraintFailure::None) {
+                continue;
+            }
+        }
+        result.valid++;
+        
+        const TrajectoryMetrics metrics = current.spliceMetrics(index, suffixes.view(i), end);
+        const float score = scorer(metrics);
+        if (!found || score > best_score) {
+            found = true;
+            best = i;
+            best_score = score;
+            best_metrics = metrics;
+        }
+    }
+    if (!found) return result;
+    
+    result.plan = PrefixMetrics(current, index, suffixes.view(best));
+    result.metrics = best_metrics;
+    result.score = best_score;
+    result.replanned = true;
+    return result;
+}
+
+} // namespace trajectory
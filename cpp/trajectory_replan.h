@@ -0,0 +1,125 @@
+/**
+ * @file trajectory_replan.h
+ * @brief Incremental replanning from a mid-flight waypoint
+ * @author Mission Planner Team
+ * 
+ * When conditions change the vehicle is already partway along its plan.
+ * Instead of regenerating the whole path, the replanner keeps the flown
+ * prefix, generates candidate suffixes from the current waypoint and
+ * splices the best one on. Whole-plan metrics of each candidate come from
+ * cached per-waypoint prefix sums (PrefixMetrics), so only the suffix is
+ * evaluated.
+ */
+
+#ifndef TRAJECTORY_REPLAN_H
+#define TRAJECTORY_REPLAN_H
+
+#include "trajectory_inference.h"
+#include "trajectory_metrics.h"
+#include "trajectory_ranking.h"
+#include <cstddef>
+#include <vector>
+
+namespace trajectory {
+
+struct TrajectoryConstraints;
+
+/**
+ * @brief A trajectory with its metric prefix sums cached per waypoint
+ */
+class PrefixMetrics {
+public:
+    PrefixMetrics() = default;
+    
+    /**
+     * @brief Cache the prefixes of a trajectory (one pass)
+     */
+    explicit PrefixMetrics(const TrajectoryView& trajectory);
+    
+    /**
+     * @brief Prefix p[0..index] of base followed by suffix[1..]
+     * 
+     * suffix[0] stands for base[index] (the replanning start) and is
+     * replaced by it. Only the suffix waypoints are evaluated; the
+     * prefixes up to index are copied from base.
+     * 
+     * @throws std::runtime_error if index is out of range
+     */
+    PrefixMetrics(const PrefixMetrics& base, size_t index, const TrajectoryView& suffix);
+    
+    const Trajectory& trajectory() const { return trajectory_; }
+    size_t size() const { return trajectory_.size(); }
+    bool empty() const { return trajectory_.empty(); }
+    
+    /**
+     * @brief Metrics of the whole trajectory
+     */
+    TrajectoryMetrics metrics(const Waypoint& expected_end) const;
+    
+    /**
+     * @brief Metrics of p[0..index]
+     */
+    TrajectoryMetrics prefixMetrics(size_t index, const Waypoint& expected_end) const;
+    
+    /**
+     * @brief Metrics of the splice PrefixMetrics(*this, index, suffix) would build
+     * 
+     * Costs one pass over the suffix, with no copies.
+     * 
+     * @throws std::runtime_error if index is out of range
+     */
+    TrajectoryMetrics spliceMetrics(size_t index, const TrajectoryView& suffix,
+                                    const Waypoint& expected_end) const;
+
+private:
+    Trajectory trajectory_;
+    std::vector<MetricsAccumulator> prefixes_;  // State after each waypoint
+};
+
+/**
+ * @brief Options for replanFrom()
+ */
+struct ReplanOptions {
+    int n_candidates = 10;                              // Suffixes to generate
+    const TrajectoryConstraints* constraints = nullptr; // Optional filter on the spliced path (not owned)
+    TrajectoryScorer scorer;                            // Scores whole-plan metrics (default: weightedScorer())
+};
+
+/**
+ * @brief Outcome of replanFrom()
+ */
+struct ReplanResult {
+    PrefixMetrics plan;          // New plan (the old one if nothing passed)
+    TrajectoryMetrics metrics;   // Whole-plan metrics of plan
+    float score = 0.0f;          // Scorer output for plan
+    size_t generated = 0;        // Suffix candidates generated
+    size_t valid = 0;            // Splices that passed the constraints
+    bool replanned = false;      // False if no candidate passed
+};
+
+/**
+ * @brief Regenerate the plan from waypoint index on
+ * 
+ * Generates n_candidates suffixes from plan[index] to end in one batch,
+ * drops those whose splice fails options.constraints (checked from
+ * plan[index - 1] on, so the turn at the splice counts), scores each
+ * remaining splice on its whole-plan metrics (from the cached prefix)
+ * and returns the best. Pass the result's plan back in for the next replan.
+ * 
+ * @param generator Generator to sample suffixes from
+ * @param current Current plan with cached prefixes
+ * @param index Waypoint the vehicle is at (kept; replanning starts here)
+ * @param end Mission end waypoint
+ * @param options Candidate count, constraints and scorer
+ * @return Best spliced plan
+ * @throws std::runtime_error if index is out of range
+ */
+ReplanResult replanFrom(TrajectoryGenerator& generator,
+                        const PrefixMetrics& current,
+                        size_t index,
+                        const Waypoint& end,
+                        const ReplanOptions& options = ReplanOptions());
+
+} // namespace trajectory
+
+#endif // TRAJECTORY_REPLAN_H
@@ -0,0 +1,283 @@
+/**
+ * @file trajectory_resample.cpp
+ * @brief Implementation of arc-length resampling and simplification
+ */
+
+#include "trajectory_resample.h"
+#include "trajectory_batch.h"
+#include "trajectory_metrics.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace trajectory {
+
+namespace {
+
+float segmentLength(const float* a, const float* b) {
+    const float dx = b[0] - a[0];
+    const float dy = b[1] - a[1];
+    const float dz = b[2] - a[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/**
+ * @brief Uniform Catmull-Rom segment p1 -> p2 at t in [0, 1]
+ */
+void catmullRom(const float* p0, const float* p1, const float* p2, const float* p3, float t,
+                float* out) {
+    const float t2 = t * t;
+    const float t3 = t2 * t;
+    for (int c = 0; c < 3; ++c) {
+        out[c] = 0.5f * (2.0f * p1[c] +
+                         (p2[c] - p0[c]) * t +
+                         (2.0f * p0[c] - 5.0f * p1[c] + 4.0f * p2[c] - p3[c]) * t2 +
+                         (3.0f * p1[c] - p0[c] - 3.0f * p2[c] + p3[c]) * t3);
+    }
+}
+
+/**
+ * @brief Squared distance from p to the segment a-b
+ */
+float segmentDistanceSq(const float* p, const float* a, const float* b) {
+    const float dx = b[0] - a[0];
+    const float dy = b[1] - a[1];
+    const float dz = b[2] - a[2];
+    const float length_sq = dx * dx + dy * dy + dz * dz;
+    
+    float t = 0.0f;
+    if (length_sq > 0.0f) {
+        t = ((p[0] - a[0]) * dx + (p[1] - a[1]) * dy + (p[2] - a[2]) * dz) / length_sq;
+        t = std::min(1.0f, std::max(0.0f, t));
+    }
+    const float ex = a[0] + t * dx - p[0];
+    const float ey = a[1] + t * dy - p[1];
+    const float ez = a[2] + t * dz - p[2];
+    return ex * ex + ey * ey + ez * ez;
+}
+
+template <typename Body>
+void forEachRow(size_t n, bool parallel, const Body& body) {
+    auto chunk = [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) body(i);
+    };
+    if (parallel && n > 1) {
+        ThreadPool::shared().parallelFor(0, n, 8, chunk);
+    } else {
+        chunk(0, n);
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// Resampling
+// ============================================================================
+
+void resampleTrajectory(const TrajectoryView& trajectory, size_t n_points, float* out,
+                        ResampleMethod method) {
+    if (trajectory.empty()) {
+        throw std::runtime_error("resampleTrajectory: empty trajectory");
+    }
+    if (n_points < 2) {
+        throw std::runtime_error("resampleTrajectory: need at least 2 output points");
+    }
+    
+    const float* p = trajectory.xyz;
+    const size_t count = trajectory.size();
+    
+    float total = 0.0f;
+    for (size_t i = 1; i < count; ++i) {
+        total += segmentLength(p + (i - 1) * 3, p + i * 3);
+    }
+    if (count == 1 || !(total > 0.0f)) {
+        for (size_t k = 0; k < n_points; ++k) {
+            std::memcpy(out + k * 3, p, 3 * sizeof(float));
+        }
+        return;
+    }
+    
+    // Targets increase, so one forward walk over the segments serves them all
+    size_t segment = 0;
+    float segment_start = 0.0f;
+    float segment_length = segmentLength(p, p + 3);
+    const float step = total / static_cast<float>(n_points - 1);
+    
+    for (size_t k = 0; k + 1 < n_points; ++k) {
+        const float s = step * static_cast<float>(k);
+        while (segment + 2 < count && segment_start + segment_length < s) {
+            segment_start += segment_length;
+            ++segment;
+            segment_length = segmentLength(p + segment * 3, p + (segment + 1) * 3);
+        }
+        
+        float t = segment_length > 0.0f ? (s - segment_start) / segment_length : 0.0f;
+        t = std::min(1.0f, std::max(0.0f, t));
+        
+        const float* p1 = p + segment * 3;
+        const float* p2 = p1 + 3;
+        float* dst = out + k * 3;
+        if (method == ResampleMethod::CatmullRom) {
+            // End segments reuse their endpoint as the missing neighbour
+            const float* p0 = segment > 0 ? p1 - 3 : p1;
+            const float* p3 = segment + 2 < count ? p2 + 3 : p2;
+            catmullRom(p0, p1, p2, p3, t, dst);
+        } else {
+            for (int c = 0; c < 3; ++c) {
+                dst[c] = p1[c] + t * (p2[c] - p1[c]);
+            }
+        }
+    }
+    
+    std::memcpy(out + (n_points - 1) * 3, p + (count - 1) * 3, 3 * sizeof(float));
+}
+
+Trajectory resampleTrajectory(const TrajectoryView& trajectory, size_t n_points,
+                              ResampleMethod method) {
+    if (n_points < 2) {
+        throw std::runtime_error("resampleTrajectory: need at least 2 output points");
+    }
+    Trajectory result(n_points);
+    resampleTrajectory(trajectory, n_points, &result[0].x, method);
+    return result;
+}
+
+size_t pointsForSpacing(const TrajectoryView& trajectory, float spacing) {
+    if (!(spacing > 0.0f)) {
+        throw std::runtime_error("pointsForSpacing: spacing must be > 0");
+    }
+    const float length = computePathLength(trajectory);
+    return std::max<size_t>(2, static_cast<size_t>(std::ceil(length / spacing)) + 1);
+}
+
+void resampleBatch(const TrajectoryBatch& batch, int n_points, TrajectoryBatch& out,
+                   ResampleMethod method, bool parallel) {
+    if (&batch == &out) {
+        throw std::runtime_error("resampleBatch: output must be a different batch");
+    }
+    if (n_points < 2) {
+        throw std::runtime_error("resampleBatch: need at least 2 output points");
+    }
+    
+    const size_t n = batch.size();
+    out.reset(n_points, n);
+    if (n == 0) return;
+    if (batch.seqLen() <= 0) {
+        throw std::runtime_error("resampleBatch: input rows are empty");
+    }
+    out.appendRows(n);
+    
+    forEachRow(n, parallel, [&](size_t i) {
+        resampleTrajectory(batch.view(i), static_cast<size_t>(n_points), out.row(i), method);
+    });
+}
+
+// ============================================================================
+// Simplification
+// ============================================================================
+
+size_t simplifyIndices(const TrajectoryView& trajectory, float tolerance, uint32_t* indices) {
+    if (!(tolerance >= 0.0f)) {
+        throw std::runtime_error("simplifyIndices: tolerance must be >= 0");
+    }
+    
+    const size_t count = trajectory.size();
+    if (count <= 2) {
+        for (size_t i = 0; i < count; ++i) indices[i] = static_cast<uint32_t>(i);
+        return count;
+    }
+    
+    // indices doubles as the keep mask. Segments are refined left first:
+    // a split at k continues on [a, k], and a segment that needs no split
+    // hands over to [b, next kept point], so no recursion stack is needed.
+    const float* p = trajectory.xyz;
+    const float tolerance_sq = tolerance * tolerance;
+    std::fill(indices, indices + count, 0u);
+    indices[0] = 1;
+    indices[count - 1] = 1;
+    
+    size_t a = 0;
+    size_t b = count - 1;
+    for (;;) {
+        size_t farthest = 0;
+        float farthest_sq = tolerance_sq;
+        for (size_t i = a + 1; i < b; ++i) {
+            const float d = segmentDistanceSq(p + i * 3, p + a * 3, p + b * 3);
+            if (d > farthest_sq) {
+                farthest_sq = d;
+                farthest = i;
+            }
+        }
+        
+        if (farthest != 0) {
+            indices[farthest] = 1;
+            b = farthest;
+            continue;
+        }
+        if (b == count - 1) break;
+        a = b;
+        b = a + 1;
+        while (!indices[b]) ++b;
+    }
+    
+    // Compact the mask into ascending indices (writes never pass the read)
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (indices[i]) indices[kept++] = static_cast<uint32_t>(i);
+    }
+    return kept;
+}
+
+Trajectory simplifyTrajectory(const TrajectoryView& trajectory, float tolerance) {
+    std::vector<uint32_t> indices(trajectory.size());
+    const size_t kept = simplifyIndices(trajectory, tolerance, indices.data());
+    
+    Trajectory result;
+    result.reserve(kept);
+    for (size_t k = 0; k < kept; ++k) {
+        result.push_back(trajectory[indices[k]]);
+    }
+    return result;
+}
+
+void simplifyBatch(const TrajectoryBatch& batch, float tolerance, SimplifiedBatch& out,
+                   bool parallel) {
+    if (!(tolerance >= 0.0f)) {
+        throw std::runtime_error("simplifyBatch: tolerance must be >= 0");
+    }
+    
+    const size_t n = batch.size();
+    const size_t seq_len = static_cast<size_t>(std::max(0, batch.seqLen()));
+    out.offsets.assign(n + 1, 0);
+    out.source_indices.resize(n * seq_len);
+    
+    // Each row simplifies into its own seq_len slot, then the rows are packed
+    forEachRow(n, parallel, [&](size_t i) {
+        out.offsets[i + 1] = simplifyIndices(batch.view(i), tolerance,
+                                             out.source_indices.data() + i * seq_len);
+    });
+    
+    for (size_t i = 0; i < n; ++i) {
+        const size_t kept = out.offsets[i + 1];
+        out.offsets[i + 1] = out.offsets[i] + kept;
+        if (out.offsets[i] != i * seq_len) {
+            std::memmove(out.source_indices.data() + out.offsets[i],
+                         out.source_indices.data() + i * seq_len, kept * sizeof(uint32_t));
+        }
+    }
+    out.source_indices.resize(out.totalPoints());
+    out.points.resize(out.totalPoints() * 3);
+    
+    forEachRow(n, parallel, [&](size_t i) {
+        const float* row = batch.row(i);
+        float* dst = out.points.data() + out.offsets[i] * 3;
+        const uint32_t* kept = out.sourceIndices(i);
+        for (size_t k = 0; k < out.count(i); ++k) {
+            std::memcpy(dst + k * 3, row + static_cast<size_t>(kept[k]) * 3, 3 * sizeof(float));
+        }
+    });
+}
+
+} // namespace trajectory
@@ -0,0 +1,138 @@
+/**
+ * @file trajectory_resample.h
+ * @brief Arc-length resampling and Douglas-Peucker simplification
+ * @author Mission Planner Team
+ * 
+ * The model emits seq_len waypoints evenly spaced in index, not in
+ * distance. Consumers that need a different density resample by arc
+ * length, piecewise linear or along a Catmull-Rom spline through the
+ * waypoints (densify for fine spacing, or thin out). Consumers that only
+ * need the shape within a tolerance simplify with Douglas-Peucker, which
+ * keeps the waypoints needed to stay within that distance of the
+ * original path and records where each kept waypoint came from.
+ */
+
+#ifndef TRAJECTORY_RESAMPLE_H
+#define TRAJECTORY_RESAMPLE_H
+
+#include "trajectory_inference.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trajectory {
+
+/**
+ * @brief How resampled points are placed between waypoints
+ */
+enum class ResampleMethod {
+    Linear,      // On the polyline through the waypoints
+    CatmullRom   // On a uniform Catmull-Rom spline through the waypoints (smooth when densifying)
+};
+
+/**
+ * @brief Resample a trajectory to n_points evenly spaced by arc length
+ * 
+ * The first and last waypoints are kept exactly. Spacing is even along
+ * the polyline; with CatmullRom the points are then moved onto the
+ * spline, which passes through every original waypoint. A trajectory
+ * with a single point or no length repeats its first waypoint.
+ * 
+ * @param trajectory Input trajectory (not empty)
+ * @param n_points Output waypoints (>= 2)
+ * @param out Receives n_points * 3 floats
+ * @param method Linear or spline placement
+ * @throws std::runtime_error if the trajectory is empty or n_points < 2
+ */
+void resampleTrajectory(const TrajectoryView& trajectory, size_t n_points, float* out,
+                        ResampleMethod method = ResampleMethod::Linear);
+
+/**
+ * @brief Resample a trajectory into an owning Trajectory
+ */
+Trajectory resampleTrajectory(const TrajectoryView& trajectory, size_t n_points,
+                              ResampleMethod method = ResampleMethod::Linear);
+
+/**
+ * @brief Waypoints needed for at most `spacing` metres between neighbours
+ * 
+ * @param trajectory Input trajectory
+ * @param spacing Target arc-length spacing (m, > 0)
+ * @return ceil(path_length / spacing) + 1, at least 2
+ */
+size_t pointsForSpacing(const TrajectoryView& trajectory, float spacing);
+
+/**
+ * @brief Resample every row of a batch to n_points waypoints
+ * 
+ * out is reset to seq_len n_points (its storage is kept) and receives
+ * one row per input row, in order.
+ * 
+ * @param batch Input trajectories
+ * @param n_points Waypoints per output row (>= 2)
+ * @param out Output batch (must not be batch)
+ * @param method Linear or spline placement
+ * @param parallel Spread the rows over ThreadPool::shared()
+ */
+void resampleBatch(const TrajectoryBatch& batch, int n_points, TrajectoryBatch& out,
+                   ResampleMethod method = ResampleMethod::Linear, bool parallel = true);
+
+/**
+ * @brief Douglas-Peucker simplification, reporting the kept waypoint indices
+ * 
+ * Every dropped waypoint lies within `tolerance` of the simplified
+ * polyline (distance to the nearest kept segment). The first and last
+ * waypoints are always kept. Uses no memory beyond `indices`.
+ * 
+ * @param trajectory Input trajectory
+ * @param tolerance Maximum deviation (m, >= 0; 0 drops only collinear points)
+ * @param indices Receives the kept indices in ascending order (room for trajectory.size())
+ * @return Number of kept waypoints
+ * @throws std::runtime_error if tolerance is negative
+ */
+size_t simplifyIndices(const TrajectoryView& trajectory, float tolerance, uint32_t* indices);
+
+/**
+ * @brief Douglas-Peucker simplification into an owning Trajectory
+ */
+Trajectory simplifyTrajectory(const TrajectoryView& trajectory, float tolerance);
+
+/**
+ * @brief Variable-length rows produced by simplifyBatch()
+ * 
+ * Row i's waypoints are points[offsets[i] * 3, offsets[i + 1] * 3);
+ * source_indices gives each kept waypoint's index in the input row, so
+ * consumers can still recover its time along the original sequence.
+ */
+struct SimplifiedBatch {
+    std::vector<float> points;              // [totalPoints(), 3]
+    std::vector<uint32_t> source_indices;   // totalPoints() entries
+    std::vector<size_t> offsets;            // size() + 1 entries
+    
+    size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    size_t count(size_t i) const { return offsets[i + 1] - offsets[i]; }
+    size_t totalPoints() const { return offsets.empty() ? 0 : offsets.back(); }
+    
+    TrajectoryView view(size_t i) const {
+        return TrajectoryView(points.data() + offsets[i] * 3, count(i));
+    }
+    const uint32_t* sourceIndices(size_t i) const { return source_indices.data() + offsets[i]; }
+};
+
+/**
+ * @brief Simplify every row of a batch
+ * 
+ * out's vectors are reused, so a SimplifiedBatch kept across requests
+ * stops allocating once it has reached the working size.
+ * 
+ * @param batch Input trajectories
+ * @param tolerance Maximum deviation (m, >= 0)
+ * @param out Output rows, in batch order
+ * @param parallel Spread the rows over ThreadPool::shared()
+ */
+void simplifyBatch(const TrajectoryBatch& batch, float tolerance, SimplifiedBatch& out,
+                   bool parallel = true);
+
+} // namespace trajectory
+
+#endif // TRAJECTORY_RESAMPLE_H
@@ -0,0 +1,808 @@
+/**
+ * @file trajectory_server.cpp
+ * @brief Native HTTP inference server (replacement for api/app.py)
+ * 
+ * Serves the FastAPI endpoints with the same JSON schema from the C++
+ * pipeline:
+ * 
+ *   GET  /, /health               service status
+ *   GET  /info                    loaded model
+ *   GET  /metrics                 Prometheus scrape (see telemetry.h)
+ *   POST /generate                {start, end, n_samples, seq_len, obstacles,
+ *                                  resample, resample_method, simplify_tolerance}
+ *   POST /generate_with_obstacles same request, ranked by obstacle clearance
+ *   POST /generate_binary         fixed-layout batch endpoint (below)
+ *   POST /models/reload           {model, model_path, norm_path} (with --allow-reload)
+ * 
+ * Models live in a ModelRegistry; JSON requests pick one with an optional
+ * "model" id (default: --model-id), and /models/reload swaps in a new
+ * version while in-flight requests finish on the old one. Concurrent
+ * JSON requests are coalesced into shared ONNX runs by a BatchScheduler;
+ * binary batches go straight to the default model's GeneratorPool.
+ * 
+ * "resample" (waypoint count, arc-length spaced; "resample_method" is
+ * "linear" or "spline") and "simplify_tolerance" (Douglas-Peucker, in m)
+ * shrink or densify the returned waypoints. Metrics describe the
+ * generated trajectory; simplified ones list the kept "waypoint_indices".
+ * 
+ * Binary endpoint (application/octet-stream, little-endian):
+ * 
+ *   request:  "TRQB" u32 version=1, u32 count, u32 reserved
+ *             count x { f32 start[3], f32 end[3], u32 n_samples, u32 reserved }
+ *   response: "TRRB" u32 version=1, u32 count, u32 seq_len
+ *             count x u32 trajectories per request
+ *             f32 waypoints [total, seq_len, 3], in request order
+ */
+
+#include "trajectory_inference.h"
+#include "trajectory_metrics.h"
+#include "generator_pool.h"
+#include "batch_scheduler.h"
+#include "model_registry.h"
+#include "telemetry.h"
+#include "http_server.h"
+#include "json_value.h"
+#include "trajectory_resample.h"
+#include "obstacle_map.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace trajectory;
+
+namespace {
+
+const char* const kVersion = "1.0.0";
+
+// Request limits of the FastAPI schema
+constexpr int kMaxSamples = 20;
+constexpr int kMinSeqLen = 10;
+constexpr int kMaxSeqLen = 100;
+
+// Waypoints a trajectory may be resampled to
+constexpr int kMaxResample = 1000;
+
+// Binary endpoint limits: trajectories per request entry and per call
+constexpr uint32_t kMaxBinarySamples = 1024;
+constexpr uint64_t kMaxBinaryRows = 65536;
+
+HttpServer* g_server = nullptr;
+
+void handleSignal(int) {
+    if (g_server) g_server->stop();
+}
+
+/**
+ * @brief Invalid request content (reported as 422, like FastAPI validation)
+ */
+struct ValidationError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+struct GenerateRequest {
+    Waypoint start;
+    Waypoint end;
+    int n_samples = 1;
+    int seq_len = 50;
+    std::vector<SphereObstacle> obstacles;
+    std::string model;  // Registry id ("" = the default model)
+    int resample = 0;                       // Returned waypoints (0 = as generated)
+    ResampleMethod resample_method = ResampleMethod::Linear;
+    float simplify_tolerance = 0.0f;        // Douglas-Peucker tolerance in m (0 = off)
+};
+
+} // namespace
+
+/**
+ * @brief Print usage information
+ */
+void printUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --host ADDR            IPv4 address to bind (default: 0.0.0.0)\n";
+    std::cout << "  --port N               Port to listen on (default: 8000)\n";
+    std::cout << "  --model PATH           Path to ONNX model (default: ../models/trajectory_generator.onnx)\n";
+    std::cout << "  --norm PATH            Path to normalization JSON (default: ../models/trajectory_generator_normalization.json)\n";
+    std::cout << "  --model-cache PATH     Save/reuse the optimized model here for faster startup\n";
+    std::cout << "  --precision P          Model variant: fp32, fp16 or int8 (default: fp32)\n";
+    std::cout << "  --model-id NAME        Registry id of the startup model (default: default)\n";
+    std::cout << "  --allow-reload         Enable POST /models/reload (loads files named by the client)\n";
+    std::cout << "  --workers N            HTTP request threads (default: 8)\n";
+    std::cout << "  --generators N         Pooled generators for binary batches (default: 2)\n";
+    std::cout << "  --ort-threads N        ONNX Runtime intra-op threads (default: 4)\n";
+    std::cout << "  --ort-inter-threads N  Run independent graph branches on N inter-op threads\n";
+    std::cout << "  --ort-affinity LIST    Pin intra-op threads, e.g. \"1;2;3\" for 4 threads\n";
+    std::cout << "  --no-spin              Let idle ONNX Runtime threads sleep instead of spinning\n";
+    std::cout << "  --global-thread-pool   Run all sessions on one process-wide thread pool\n";
+    std::cout << "  --max-delay-us N       Coalescing window for JSON requests (default: 2000)\n";
+    std::cout << "  --no-batching          Run each JSON request on its own instead of coalescing\n";
+    std::cout << "  --seed N               Latent seed (default: random)\n";
+    std::cout << "  --gpu                  Run inference on CUDA (falls back to CPU)\n";
+    std::cout << "  --tensorrt             With --gpu, prefer TensorRT over plain CUDA\n";
+    std::cout << "  --help                 Show this help message\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << program_name << " --port 8000 --workers 16\n";
+}
+
+/**
+ * @brief Server settings
+ */
+struct ServerConfig {
+    std::string host = "0.0.0.0";
+    int port = 8000;
+    std::string model_path = "../models/trajectory_generator.onnx";
+    std::string norm_path = "../models/trajectory_generator_normalization.json";
+    std::string model_cache;
+    ModelPrecision precision = ModelPrecision::FP32;
+    std::string model_id = "default";
+    bool allow_reload = false;
+    int workers = 8;
+    int generators = 2;
+    int ort_threads = 4;
+    int ort_inter_threads = 0;
+    std::string ort_affinity;
+    bool ort_spinning = true;
+    bool global_thread_pool = false;
+    int max_delay_us = 2000;
+    bool batching = true;
+    uint64_t seed = 0;
+    bool use_gpu = false;
+    bool use_tensorrt = false;
+};
+
+/**
+ * @brief Parse a whole string as a non-negative integer
+ * @return False on signs, trailing characters or overflow
+ */
+bool parseUnsigned(const std::string& text, uint64_t& value) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) return false;
+    try {
+        value = std::stoull(text);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+/**
+ * @brief Parse command line arguments
+ */
+bool parseArguments(int argc, char* argv[], ServerConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return false;
+        } else if (arg == "--no-batching") {
+            config.batching = false;
+        } else if (arg == "--allow-reload") {
+            config.allow_reload = true;
+        } else if (arg == "--no-spin") {
+            config.ort_spinning = false;
+        } else if (arg == "--global-thread-pool") {
+            config.global_thread_pool = true;
+        } else if (arg == "--gpu") {
+            config.use_gpu = true;
+        } else if (arg == "--tensorrt") {
+            config.use_gpu = true;
+            config.use_tensorrt = true;
+        } else if (i + 1 >= argc) {
+            std::cerr << "Error: Unknown argument or missing value '" << arg << "'" << std::endl;
+            return false;
+        } else if (arg == "--host") {
+            config.host = argv[++i];
+        } else if (arg == "--model") {
+            config.model_path = argv[++i];
+        } else if (arg == "--norm") {
+            config.norm_path = argv[++i];
+        } else if (arg == "--model-cache") {
+            config.model_cache = argv[++i];
+        } else if (arg == "--model-id") {
+            config.model_id = argv[++i];
+        } else if (arg == "--ort-affinity") {
+            config.ort_affinity = argv[++i];
+        } else if (arg == "--precision") {
+            std::string name = argv[++i];
+            if (name == "fp32") {
+                config.precision = ModelPrecision::FP32;
+            } else if (name == "fp16") {
+                config.precision = ModelPrecision::FP16;
+            } else if (name == "int8") {
+                config.precision = ModelPrecision::INT8;
+            } else {
+                std::cerr << "Error: precision must be fp32, fp16 or int8" << std::endl;
+                return false;
+            }
+        } else if (arg == "--seed") {
+            if (!parseUnsigned(argv[++i], config.seed)) {
+                std::cerr << "Error: --seed must be a non-negative integer" << std::endl;
+                return false;
+            }
+        } else {
+            int* target = arg == "--port" ? &config.port
+                        : arg == "--workers" ? &config.workers
+                        : arg == "--generators" ? &config.generators
+                        : arg == "--ort-threads" ? &config.ort_threads
+                        : arg == "--ort-inter-threads" ? &config.ort_inter_threads
+                        : arg == "--max-delay-us" ? &config.max_delay_us : nullptr;
+            if (!target) {
+                std::cerr << "Error: Unknown argument '" << arg << "'" << std::endl;
+                return false;
+            }
+            uint64_t value = 0;
+            if (!parseUnsigned(argv[++i], value)) {
+                std::cerr << "Error: " << arg << " must be an integer" << std::endl;
+                return false;
+            }
+            if (value > static_cast<uint64_t>(std::numeric_limits<int>::max()) ||
+                value < (target == &config.max_delay_us ? 0u : 1u) ||
+                (target == &config.port && value > 65535)) {
+                std::cerr << "Error: " << arg << " is out of range" << std::endl;
+                return false;
+            }
+            *target = static_cast<int>(value);
+        }
+    }
+    
+    return true;
+}
+
+namespace {
+
+// ============================================================================
+// Request parsing
+// ============================================================================
+
+float requireNumber(const JsonValue& object, const std::string& key, const std::string& where) {
+    const JsonValue* value = object.find(key);
+    if (!value || !value->isNumber()) {
+        throw ValidationError(where + "." + key + " must be a number");
+    }
+    return static_cast<float>(value->asNumber());
+}
+
+Waypoint parseWaypoint(const JsonValue* value, const std::string& where) {
+    if (!value || !value->isObject()) {
+        throw ValidationError(where + " must be an object with x, y and z");
+    }
+    return Waypoint(requireNumber(*value, "x", where), requireNumber(*value, "y", where),
+                    requireNumber(*value, "z", where));
+}
+
+int parseBoundedInt(const JsonValue& body, const std::string& key, int fallback, int lo, int hi) {
+    // Range and integrality on the double: casting NaN or 1e300 to int is undefined
+    const double value = body.numberOr(key, fallback);
+    if (!(value >= lo && value <= hi) || value != std::floor(value)) {
+        throw ValidationError(key + " must be an integer in [" + std::to_string(lo) + ", " +
+                              std::to_string(hi) + "]");
+    }
+    return static_cast<int>(value);
+}
+
+std::string stringOr(const JsonValue& body, const std::string& key) {
+    const JsonValue* value = body.find(key);
+    if (!value || value->isNull()) return std::string();
+    if (!value->isString()) throw ValidationError(key + " must be a string");
+    return value->asString();
+}
+
+GenerateRequest parseGenerateRequest(const std::string& text) {
+    JsonValue body;
+    try {
+        body = JsonValue::parse(text);
+    } catch (const std::runtime_error& e) {
+        throw ValidationError(e.what());
+    }
+    if (!body.isObject()) throw ValidationError("Request body must be a JSON object");
+    
+    GenerateRequest request;
+    try {
+        request.start = parseWaypoint(body.find("start"), "start");
+        request.end = parseWaypoint(body.find("end"), "end");
+        request.n_samples = parseBoundedInt(body, "n_samples", 1, 1, kMaxSamples);
+        request.seq_len = parseBoundedInt(body, "seq_len", 50, kMinSeqLen, kMaxSeqLen);
+        request.model = stringOr(body, "model");
+        
+        request.resample = parseBoundedInt(body, "resample", 0, 0, kMaxResample);
+        if (request.resample == 1) throw ValidationError("resample must be 0 or at least 2");
+        const std::string method = stringOr(body, "resample_method");
+        if (method == "spline") {
+            request.resample_method = ResampleMethod::CatmullRom;
+        } else if (!method.empty() && method != "linear") {
+            throw ValidationError("resample_method must be \"linear\" or \"spline\"");
+        }
+        
+        const double tolerance = body.numberOr("simplify_tolerance", 0.0);
+        if (!(tolerance >= 0.0) || !std::isfinite(tolerance)) {
+            throw ValidationError("simplify_tolerance must be a number >= 0");
+        }
+        request.simplify_tolerance = static_cast<float>(tolerance);
+    } catch (const ValidationError&) {
+        throw;
+    } catch (const std::runtime_error& e) {
+        throw ValidationError(e.what());
+    }
+    
+    const JsonValue* obstacles = body.find("obstacles");
+    if (obstacles && !obstacles->isNull()) {
+        if (!obstacles->isArray()) throw ValidationError("obstacles must be an array");
+        for (size_t i = 0; i < obstacles->size(); ++i) {
+            const JsonValue& entry = (*obstacles)[i];
+            const std::string where = "obstacles[" + std::to_string(i) + "]";
+            if (!entry.isObject()) throw ValidationError(where + " must be an object");
+            
+            SphereObstacle obstacle;
+            obstacle.center = parseWaypoint(entry.find("center"), where + ".center");
+            obstacle.radius = requireNumber(entry, "radius", where);
+            if (!(obstacle.radius > 0.0f) || !std::isfinite(obstacle.radius)) {
+                throw ValidationError(where + ".radius must be a finite number > 0");
+            }
+            if (!std::isfinite(obstacle.center.x) || !std::isfinite(obstacle.center.y) ||
+                !std::isfinite(obstacle.center.z)) {
+                throw ValidationError(where + ".center must be finite");
+            }
+            request.obstacles.push_back(obstacle);
+        }
+    }
+    
+    return request;
+}
+
+// ============================================================================
+// Response writing
+// ============================================================================
+
+void appendNumber(std::string& out, double value) {
+    if (!std::isfinite(value)) {
+        out += "null";   // JSON has no NaN/Inf
+        return;
+    }
+    char text[32];
+    const int length = std::snprintf(text, sizeof(text), "%.9g", value);
+    out.append(text, static_cast<size_t>(length));
+}
+
+void appendWaypoint(std::string& out, const Waypoint& w) {
+    out += "{\"x\": ";
+    appendNumber(out, w.x);
+    out += ", \"y\": ";
+    appendNumber(out, w.y);
+    out += ", \"z\": ";
+    appendNumber(out, w.z);
+    out += "}";
+}
+
+void appendMetrics(std::string& out, const TrajectoryMetrics& m, const float* safety_score) {
+    const std::pair<const char*, float> fields[] = {
+        {"path_length", m.path_length},
+        {"straight_line_distance", m.straight_line_distance},
+        {"path_efficiency", m.path_efficiency},
+        {"avg_curvature", m.avg_curvature},
+        {"max_curvature", m.max_curvature},
+        {"smoothness_score", m.smoothness_score},
+        {"avg_velocity", m.avg_velocity},
+        {"min_altitude", m.min_altitude},
+        {"max_altitude", m.max_altitude},
+        {"avg_altitude", m.avg_altitude},
+    };
+    
+    out += "{";
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i) {
+        if (i > 0) out += ", ";
+        out += "\"";
+        out += fields[i].first;
+        out += "\": ";
+        appendNumber(out, fields[i].second);
+    }
+    if (safety_score) {
+        out += ", \"safety_score\": ";
+        appendNumber(out, *safety_score);
+    }
+    out += "}";
+}
+
+// ============================================================================
+// Service
+// ============================================================================
+
+/**
+ * @brief Loaded model plus the request paths over it
+ */
+class TrajectoryService {
+public:
+    explicit TrajectoryService(const ServerConfig& config) : config_(config) {
+        GeneratorConfig gen_config(config.model_path);
+        gen_config.precision = config.precision;
+        gen_config.num_threads = config.ort_threads;
+        gen_config.inter_op_threads = config.ort_inter_threads;
+        gen_config.parallel_execution = config.ort_inter_threads > 0;
+        gen_config.thread_affinity = config.ort_affinity;
+        gen_config.allow_spinning = config.ort_spinning;
+        gen_config.use_global_thread_pool = config.global_thread_pool;
+        gen_config.use_gpu = config.use_gpu;
+        gen_config.use_tensorrt = config.use_tensorrt;
+        gen_config.optimized_model_path = config.model_cache;
+        gen_config.seed = config.seed;
+        
+        spec_ = ModelSpec(gen_config, config.norm_path);
+        spec_.num_workers = static_cast<size_t>(config.generators);
+        spec_.batching = config.batching;
+        spec_.scheduling.max_delay = std::chrono::microseconds(config.max_delay_us);
+        
+        // Keep serving on default normalization if the startup file is
+        // missing; versions loaded later must bring a readable one
+        if (!std::ifstream(config.norm_path)) {
+            std::cerr << "Warning: Failed to load normalization, using defaults" << std::endl;
+            spec_.normalization_path.clear();
+        } else {
+            applyModelMetadata(loadModelMetadata(config.norm_path), spec_.config);
+        }
+        latent_dim_ = spec_.config.latent_dim;
+        
+        registry_.load(config.model_id, spec_);
+    }
+    
+    HttpResponse health() const {
+        return HttpResponse(200, std::string("{\"status\": \"healthy\", \"model_loaded\": true, "
+                                             "\"version\": \"") + kVersion + "\"}");
+    }
+    
+    HttpResponse info() const {
+        const auto loaded = registry_.get(config_.model_id);
+        const auto model = loaded->pool().getModelSession();
+        std::string out = "{\"model_loaded\": true, \"device\": " + jsonQuote(model->executionProvider()) +
+                          ", \"model_path\": " + jsonQuote(model->modelPath()) +
+                          ", \"precision\": " + jsonQuote(precisionName(model->precision())) +
+                          ", \"seq_len\": " + std::to_string(model->outputSeqLen()) +
+                          ", \"latent_dim\": " + std::to_string(latent_dim_) +
+                          ", \"seed\": " + std::to_string(loaded->pool().getSeed()) +
+                          ", \"batching\": " + (loaded->scheduler() ? "true" : "false") +
+                          ", \"models\": [";
+        bool first = true;
+        for (const std::string& id : registry_.ids()) {
+            const auto entry = registry_.find(id);
+            if (!entry) continue;   // Unloaded meanwhile
+            if (!first) out += ", ";
+            first = false;
+            out += "{\"id\": " + jsonQuote(entry->id()) +
+                   ", \"version\": " + std::to_string(entry->version()) +
+                   ", \"model_path\": " + jsonQuote(entry->pool().getModelSession()->modelPath()) +
+                   ", \"seq_len\": " + std::to_string(entry->getSeqLen()) + "}";
+        }
+        out += "]}";
+        return HttpResponse(200, out);
+    }
+    
+    HttpResponse metrics() const {
+        return HttpResponse(200, TelemetryRegistry::global().scrape(),
+                            "text/plain; version=0.0.4");
+    }
+    
+    /**
+     * @brief /generate and /generate_with_obstacles
+     * @param rank_by_safety Sort by safety score and report it (the obstacle endpoint)
+     */
+    HttpResponse generate(const HttpRequest& http, bool rank_by_safety) {
+        GenerateRequest request;
+        try {
+            request = parseGenerateRequest(http.body);
+        } catch (const ValidationError& e) {
+            return httpError(422, e.what());
+        }
+        
+        const auto model = registry_.find(request.model.empty() ? config_.model_id : request.model);
+        if (!model) {
+            return httpError(404, "Unknown model '" + request.model + "'");
+        }
+        
+        const int seq_len = model->getSeqLen();
+        if (request.seq_len != seq_len) {
+            return httpError(422, "seq_len " + std::to_string(request.seq_len) +
+                                  " is not supported by the loaded model (" +
+                                  std::to_string(seq_len) + ")");
+        }
+        
+        // Without obstacles the obstacle endpoint is plain generation, as in api/app.py
+        rank_by_safety = rank_by_safety && !request.obstacles.empty();
+        
+        const auto start_time = std::chrono::steady_clock::now();
+        std::vector<Trajectory> trajectories;
+        try {
+            trajectories = model->submit(request.start, request.end, request.n_samples).get();
+        } catch (const std::exception& e) {
+            return httpError(500, std::string("Generation failed: ") + e.what());
+        }
+        const double inference_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start_time).count();
+        
+        std::vector<float> scores(trajectories.size());
+        std::vector<size_t> order(trajectories.size());
+        std::iota(order.begin(), order.end(), 0);
+        if (rank_by_safety) {
+            // Safety score as in api/app.py (higher is safer, negative inside an
+            // obstacle), measured per segment so a leg that cuts through counts
+            const ObstacleMap map(request.obstacles);
+            for (size_t i = 0; i < trajectories.size(); ++i) {
+                scores[i] = map.clearance(trajectories[i]);
+            }
+            std::stable_sort(order.begin(), order.end(),
+                             [&](size_t a, size_t b) { return scores[a] > scores[b]; });
+        }
+        
+        const bool simplify = request.simplify_tolerance > 0.0f;
+        const size_t out_len = request.resample > 0 ? static_cast<size_t>(request.resample)
+                                                    : static_cast<size_t>(seq_len);
+        Trajectory resampled;
+        std::vector<uint32_t> kept(out_len);
+        
+        std::string out;
+        out.reserve(trajectories.size() * out_len * 40 + 1024);
+        out += "{\"success\": true, \"trajectories\": [";
+        for (size_t k = 0; k < order.size(); ++k) {
+            const Trajectory& trajectory = trajectories[order[k]];
+            if (k > 0) out += ", ";
+            
+            // Resample first, then simplify what the client receives
+            TrajectoryView shaped(trajectory);
+            if (request.resample > 0) {
+                resampled.resize(out_len);
+                resampleTrajectory(trajectory, out_len, &resampled[0].x, request.resample_method);
+                shaped = TrajectoryView(resampled);
+            }
+            size_t n_kept = shaped.size();
+            if (simplify) {
+                n_kept = simplifyIndices(shaped, request.simplify_tolerance, kept.data());
+            }
+            
+            out += "{\"waypoints\": [";
+            for (size_t i = 0; i < n_kept; ++i) {
+                const Waypoint w = shaped[simplify ? kept[i] : i];
+                if (i > 0) out += ", ";
+                out += "[";
+                appendNumber(out, w.x);
+                out += ", ";
+                appendNumber(out, w.y);
+                out += ", ";
+                appendNumber(out, w.z);
+                out += "]";
+            }
+            out += "]";
+            if (simplify) {
+                out += ", \"waypoint_indices\": [";
+                for (size_t i = 0; i < n_kept; ++i) {
+                    if (i > 0) out += ", ";
+                    out += std::to_string(kept[i]);
+                }
+                out += "]";
+            }
+            out += ", \"metrics\": ";
+            appendMetrics(out, evaluateTrajectory(trajectory, request.end),
+                          rank_by_safety ? &scores[order[k]] : nullptr);
+            if (rank_by_safety) {
+                out += ", \"safety_score\": ";
+                appendNumber(out, scores[order[k]]);
+            }
+            out += "}";
+        }
+        out += "], \"start\": ";
+        appendWaypoint(out, request.start);
+        out += ", \"end\": ";
+        appendWaypoint(out, request.end);
+        out += ", \"n_samples\": " + std::to_string(request.n_samples);
+        if (rank_by_safety) {
+            out += ", \"obstacles\": [";
+            for (size_t i = 0; i < request.obstacles.size(); ++i) {
+                if (i > 0) out += ", ";
+                out += "{\"center\": ";
+                appendWaypoint(out, request.obstacles[i].center);
+                out += ", \"radius\": ";
+                appendNumber(out, request.obstacles[i].radius);
+                out += "}";
+            }
+            out += "]";
+        }
+        out += ", \"inference_time_ms\": ";
+        appendNumber(out, inference_ms);
+        out += "}";
+        
+        return HttpResponse(200, std::move(out));
+    }
+    
+    /**
+     * @brief /generate_binary (layout in the file header)
+     */
+    HttpResponse generateBinary(const HttpRequest& http) {
+        const std::string& body = http.body;
+        auto readU32 = [&](size_t offset) {
+            uint32_t value;
+            std::memcpy(&value, body.data() + offset, sizeof(value));
+            return value;
+        };
+        
+        if (body.size() < 16 || body.compare(0, 4, "TRQB") != 0 || readU32(4) != 1) {
+            return httpError(422, "Expected a TRQB version 1 request");
+        }
+        const uint32_t count = readU32(8);
+        if (count == 0 || body.size() != 16 + static_cast<size_t>(count) * 32) {
+            return httpError(422, "Request size does not match its entry count");
+        }
+        
+        std::vector<GenerationRequest> requests(count);
+        uint64_t total_rows = 0;
+        for (uint32_t r = 0; r < count; ++r) {
+            float values[6];
+            std::memcpy(values, body.data() + 16 + r * 32, sizeof(values));
+            const uint32_t n = readU32(16 + r * 32 + 24);
+            if (n == 0 || n > kMaxBinarySamples) {
+                return httpError(422, "n_samples must be in [1, " + std::to_string(kMaxBinarySamples) + "]");
+            }
+            requests[r] = GenerationRequest(Waypoint(values[0], values[1], values[2]),
+                                            Waypoint(values[3], values[4], values[5]),
+                                            static_cast<int>(n));
+            total_rows += n;
+        }
+        if (total_rows > kMaxBinaryRows) {
+            return httpError(413, "At most " + std::to_string(kMaxBinaryRows) + " trajectories per call");
+        }
+        
+        const auto model = registry_.get(config_.model_id);
+        BatchResult result;
+        try {
+            result = model->pool().submitBatch(std::move(requests)).get();
+        } catch (const std::exception& e) {
+            return httpError(500, std::string("Generation failed: ") + e.what());
+        }
+        
+        const uint32_t seq_len = static_cast<uint32_t>(model->getSeqLen());
+        std::string out(16 + count * sizeof(uint32_t) + total_rows * seq_len * 3 * sizeof(float), '\0');
+        char* p = &out[0];
+        auto writeU32 = [&](uint32_t value) {
+            std::memcpy(p, &value, sizeof(value));
+            p += sizeof(value);
+        };
+        
+        std::memcpy(p, "TRRB", 4);
+        p += 4;
+        writeU32(1);
+        writeU32(count);
+        writeU32(seq_len);
+        for (uint32_t r = 0; r < count; ++r) {
+            writeU32(static_cast<uint32_t>(result.count(r)));
+        }
+        for (const Trajectory& trajectory : result.trajectories) {
+            for (const Waypoint& w : trajectory) {
+                const float xyz[3] = {w.x, w.y, w.z};
+                std::memcpy(p, xyz, sizeof(xyz));
+                p += sizeof(xyz);
+            }
+        }
+        
+        return HttpResponse(200, std::move(out), "application/octet-stream");
+    }
+    
+    /**
+     * @brief /models/reload: load a model version and swap it in
+     * 
+     * Runs on the calling connection thread; the other workers keep
+     * serving the current version until the new one is warmed up.
+     */
+    HttpResponse reload(const HttpRequest& http) {
+        std::string id;
+        std::string model_path;
+        std::string norm_path;
+        try {
+            const JsonValue body = http.body.empty() ? JsonValue::parse("{}") : JsonValue::parse(http.body);
+            if (!body.isObject()) throw ValidationError("Request body must be a JSON object");
+            id = stringOr(body, "model");
+            model_path = stringOr(body, "model_path");
+            norm_path = stringOr(body, "norm_path");
+        } catch (const std::runtime_error& e) {
+            return httpError(422, e.what());
+        }
+        if (id.empty()) id = config_.model_id;
+        
+        // Start from the id's current setup (a new id starts from the
+        // startup model's) and override the files
+        const auto current = registry_.find(id);
+        if (!current && model_path.empty()) {
+            return httpError(404, "Unknown model '" + id + "' (give model_path to add it)");
+        }
+        ModelSpec spec = current ? current->spec() : spec_;
+        if (!model_path.empty()) spec.config.model_path = model_path;
+        if (!norm_path.empty()) spec.normalization_path = norm_path;
+        
+        std::shared_ptr<const LoadedModel> loaded;
+        try {
+            // The new files decide the graph's I/O names; a sidecar without
+            // them falls back to the model's own input order
+            if (!model_path.empty() || !norm_path.empty()) {
+                spec.config.input_names.clear();
+                spec.config.output_name.clear();
+            }
+            if (!spec.normalization_path.empty()) {
+                applyModelMetadata(loadModelMetadata(spec.normalization_path), spec.config);
+            }
+            loaded = registry_.load(id, spec);
+        } catch (const std::exception& e) {
+            return httpError(500, std::string("Reload failed, previous version still serving: ") + e.what());
+        }
+        
+        return HttpResponse(200, "{\"success\": true, \"model\": " + jsonQuote(loaded->id()) +
+                                 ", \"version\": " + std::to_string(loaded->version()) +
+                                 ", \"model_path\": " + jsonQuote(loaded->pool().getModelSession()->modelPath()) +
+                                 ", \"seq_len\": " + std::to_string(loaded->getSeqLen()) + "}");
+    }
+
+private:
+    ServerConfig config_;
+    ModelSpec spec_;          // Startup model; template for ids added by reload
+    ModelRegistry registry_;
+    int latent_dim_;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    ServerConfig config;
+    if (!parseArguments(argc, argv, config)) {
+        return 1;
+    }
+    
+    std::cout << "========================================" << std::endl;
+    std::cout << "Trajectory Generation Server" << std::endl;
+    std::cout << "========================================" << std::endl;
+    
+    std::unique_ptr<TrajectoryService> service;
+    try {
+        service = std::make_unique<TrajectoryService>(config);
+    } catch (const std::exception& e) {
+        std::cerr << "\n❌ Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    HttpServerConfig http_config;
+    http_config.num_threads = static_cast<size_t>(config.workers);
+    HttpServer server(http_config);
+    
+    TrajectoryService& s = *service;
+    server.route("GET", "/", [&s](const HttpRequest&) { return s.health(); });
+    server.route("GET", "/health", [&s](const HttpRequest&) { return s.health(); });
+    server.route("GET", "/info", [&s](const HttpRequest&) { return s.info(); });
+    server.route("GET", "/metrics", [&s](const HttpRequest&) { return s.metrics(); });
+    server.route("POST", "/generate", [&s](const HttpRequest& r) { return s.generate(r, false); });
+    server.route("POST", "/generate_with_obstacles",
+                 [&s](const HttpRequest& r) { return s.generate(r, true); });
+    server.route("POST", "/generate_binary", [&s](const HttpRequest& r) { return s.generateBinary(r); });
+    if (config.allow_reload) {
+        server.route("POST", "/models/reload", [&s](const HttpRequest& r) { return s.reload(r); });
+    }
+    
+    if (!server.listen(config.host, static_cast<uint16_t>(config.port))) {
+        return 1;
+    }
+    
+    g_server = &server;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    
+    std::cout << "✓ Listening on http://" << config.host << ":" << server.port()
+              << " (" << config.workers << " workers, batching "
+              << (config.batching ? "on" : "off") << ")" << std::endl;
+    
+    server.run();
+    g_server = nullptr;
+    
+    std::cout << "✓ Server stopped" << std::endl;
+    return 0;
+}
@@ -124,11 +124,19 @@ class ONNXExporter:
         # Verify the model
         self._verify_onnx_model(output_path, z, start, end)
         
-        # Save normalization parameters alongside
+        # Save normalization parameters alongside, with the model metadata
+        # the C++ loader uses to configure and validate the session
         norm_path = output_path.replace('.onnx', '_normalization.json')
         import json
+        sidecar = dict(self.normalization)
+        sidecar.update({
+            'latent_dim': latent_dim,
+            'seq_len': seq_len,
+            'input_names': ['latent', 'start', 'end'],
+            'output_names': ['trajectory'],
+        })
         with open(norm_path, 'w') as f:
-            json.dump(self.normalization, f, indent=2)
+            json.dump(sidecar, f, indent=2)
         print(f"✓ Normalization parameters saved to {norm_path}")
     
     def _verify_onnx_model(self, onnx_path: str, z: torch.Tensor,
@@ -176,6 +184,70 @@ class ONNXExporter:
             print("  ⚠ Warning: Large difference between ONNX and PyTorch")
 
 
+def variant_path(onnx_path: str, precision: str) -> str:
+    """
+    Path of a reduced-precision variant next to the FP32 export
+    
+    Matches trajectory::modelVariantPath() in the C++ library, e.g.
+    models/trajectory_generator.onnx -> models/trajectory_generator_fp16.onnx
+    """
+    stem, ext = os.path.splitext(onnx_path)
+    return f"{stem}_{precision}{ext}"
+
+
+def export_fp16_variant(onnx_path: str) -> str:
+    """
+    Convert an FP32 export to float16 weights and activations
+    
+    Inputs and outputs stay float32 so the variant is a drop-in
+    replacement; the C++ generator also accepts float16 I/O. Float16
+    kernels are mainly available on the CUDA/TensorRT providers.
+    
+    Args:
+        onnx_path: Path to the FP32 ONNX model
+        
+    Returns:
+        Path to the FP16 model
+    """
+    from onnxconverter_common import float16
+    
+    output_path = variant_path(onnx_path, 'fp16')
+    print(f"\nConverting to FP16: {output_path}")
+    
+    model = onnx.load(onnx_path)
+    model_fp16 = float16.convert_float_to_float16(model, keep_io_types=True)
+    onnx.save(model_fp16, output_path)
+    onnx.checker.check_model(output_path)
+    
+    print(f"✓ FP16 model exported to {output_path}")
+    return output_path
+
+
+def export_int8_variant(onnx_path: str) -> str:
+    """
+    Quantize an FP32 export to int8 weights (dynamic quantization)
+    
+    Activations are quantized per batch at run time, so no calibration
+    data is needed and inputs/outputs stay float32.
+    
+    Args:
+        onnx_path: Path to the FP32 ONNX model
+        
+    Returns:
+        Path to the INT8 model
+    """
+    from onnxruntime.quantization import QuantType, quantize_dynamic
+    
+    output_path = variant_path(onnx_path, 'int8')
+    print(f"\nQuantizing to INT8: {output_path}")
+    
+    quantize_dynamic(onnx_path, output_path, weight_type=QuantType.QInt8)
+    onnx.checker.check_model(output_path)
+    
+    print(f"✓ INT8 model exported to {output_path}")
+    return output_path
+
+
 def test_onnx_inference(onnx_path: str, normalization_path: str):
     """
     Test ONNX model inference
@@ -268,6 +340,10 @@ def main():
                        choices=['cpu', 'cuda'], help='Device to use')
     parser.add_argument('--test', action='store_true',
                        help='Test ONNX model after export')
+    parser.add_argument('--fp16', action='store_true',
+                       help='Also export a float16 variant (<output>_fp16.onnx)')
+    parser.add_argument('--int8', action='store_true',
+                       help='Also export an int8-quantized variant (<output>_int8.onnx)')
     
     args = parser.parse_args()
     
@@ -278,6 +354,13 @@ def main():
     exporter = ONNXExporter(args.checkpoint, device=args.device)
     exporter.export_generator(args.output, seq_len=args.seq_len)
     
+    # Reduced-precision variants
+    variants = []
+    if args.fp16:
+        variants.append(export_fp16_variant(args.output))
+    if args.int8:
+        variants.append(export_int8_variant(args.output))
+    
     # Test if requested
     if args.test:
         norm_path = args.output.replace('.onnx', '_normalization.json')
@@ -287,6 +370,8 @@ def main():
     print("Export Complete!")
     print("="*60)
     print(f"\nONNX model: {args.output}")
+    for path in variants:
+        print(f"Variant: {path}")
     print(f"Normalization: {args.output.replace('.onnx', '_normalization.json')}")
     print("\nYou can now use this model with:")
     print("  - ONNX Runtime (Python/C++)")